@@ -20,6 +20,7 @@
 // THE SOFTWARE.
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -84,8 +85,16 @@ auto Binder::BindColumnDefinition(duckdb_libpgquery::PGColumnDef *cdef) -> Colum
 auto Binder::BindCreate(duckdb_libpgquery::PGCreateStmt *pg_stmt) -> std::unique_ptr<CreateStatement> {
   auto table = std::string(pg_stmt->relation->relname);
   auto columns = std::vector<Column>{};
+  auto primary_key = std::vector<std::string>{};
   size_t column_count = 0;
 
+  auto set_primary_key = [&](std::vector<std::string> key) {
+    if (!primary_key.empty()) {
+      throw bustub::Exception("multiple primary keys are not allowed");
+    }
+    primary_key = std::move(key);
+  };
+
   for (auto c = pg_stmt->tableElts->head; c != nullptr; c = lnext(c)) {
     auto node = reinterpret_cast<duckdb_libpgquery::PGNode *>(c->data.ptr_value);
     switch (node->type) {
@@ -93,14 +102,28 @@ auto Binder::BindCreate(duckdb_libpgquery::PGCreateStmt *pg_stmt) -> std::unique
         auto cdef = reinterpret_cast<duckdb_libpgquery::PGColumnDef *>(c->data.ptr_value);
         auto centry = BindColumnDefinition(cdef);
         if (cdef->constraints != nullptr) {
-          throw NotImplementedException("constraints not supported");
+          for (auto cc = cdef->constraints->head; cc != nullptr; cc = lnext(cc)) {
+            auto constraint = reinterpret_cast<duckdb_libpgquery::PGConstraint *>(cc->data.ptr_value);
+            if (constraint->contype != duckdb_libpgquery::PG_CONSTR_PRIMARY) {
+              throw NotImplementedException("only primary key constraints are supported");
+            }
+            set_primary_key({centry.GetName()});
+          }
         }
         columns.push_back(std::move(centry));
         column_count++;
         break;
       }
       case duckdb_libpgquery::T_PGConstraint: {
-        throw NotImplementedException("constraints not supported");
+        auto constraint = reinterpret_cast<duckdb_libpgquery::PGConstraint *>(c->data.ptr_value);
+        if (constraint->contype != duckdb_libpgquery::PG_CONSTR_PRIMARY) {
+          throw NotImplementedException("only primary key constraints are supported");
+        }
+        std::vector<std::string> key;
+        for (auto kc = constraint->keys->head; kc != nullptr; kc = lnext(kc)) {
+          key.emplace_back(reinterpret_cast<duckdb_libpgquery::PGValue *>(kc->data.ptr_value)->val.str);
+        }
+        set_primary_key(std::move(key));
         break;
       }
       default:
@@ -112,7 +135,14 @@ auto Binder::BindCreate(duckdb_libpgquery::PGCreateStmt *pg_stmt) -> std::unique
     throw bustub::Exception("should have at least 1 column");
   }
 
-  return std::make_unique<CreateStatement>(std::move(table), std::move(columns));
+  for (const auto &key_column : primary_key) {
+    if (std::none_of(columns.begin(), columns.end(),
+                     [&](const Column &column) { return column.GetName() == key_column; })) {
+      throw bustub::Exception(fmt::format("primary key column {} does not exist", key_column));
+    }
+  }
+
+  return std::make_unique<CreateStatement>(std::move(table), std::move(columns), std::move(primary_key));
 }
 
 auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<IndexStatement> {
@@ -129,7 +159,63 @@ auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<
     }
   }
 
-  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols));
+  // `WITH (include = 'a, b')` names the INCLUDE columns of a covering index,
+  // `WITH (bloom_filter_bits = n)` puts a Bloom filter of n bits in front of the point lookups,
+  // `WITH (lazy_delete = true)` leaves the underfull pages of deletes to a background compaction
+  std::vector<std::unique_ptr<BoundColumnRef>> include_cols;
+  size_t bloom_filter_bits = 0;
+  bool lazy_delete = false;
+  if (stmt->options != nullptr) {
+    for (auto cell = stmt->options->head; cell != nullptr; cell = cell->next) {
+      auto option = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(cell->data.ptr_value);
+      auto arg_type = option->arg != nullptr ? option->arg->type : duckdb_libpgquery::T_PGInvalid;
+      if (std::string(option->defname) == "bloom_filter_bits" && arg_type == duckdb_libpgquery::T_PGInteger) {
+        auto bits = reinterpret_cast<duckdb_libpgquery::PGValue *>(option->arg)->val.ival;
+        if (bits <= 0) {
+          throw bustub::Exception("bloom_filter_bits must be positive");
+        }
+        bloom_filter_bits = bits;
+        continue;
+      }
+      if (std::string(option->defname) == "lazy_delete") {
+        auto value = arg_type == duckdb_libpgquery::T_PGString
+                         ? StringUtil::Lower(reinterpret_cast<duckdb_libpgquery::PGValue *>(option->arg)->val.str)
+                         : std::string{};
+        if (value != "true" && value != "false") {
+          throw bustub::Exception("lazy_delete must be true or false");
+        }
+        lazy_delete = value == "true";
+        continue;
+      }
+      if (std::string(option->defname) != "include" || arg_type != duckdb_libpgquery::T_PGString) {
+        throw NotImplementedException(fmt::format("unsupported index option: {}", option->defname));
+      }
+      std::string names = reinterpret_cast<duckdb_libpgquery::PGValue *>(option->arg)->val.str;
+      size_t begin = 0;
+      while (begin <= names.size()) {
+        auto end = std::min(names.find(',', begin), names.size());
+        auto name = names.substr(begin, end - begin);
+        name.erase(0, name.find_first_not_of(' '));
+        name.erase(name.find_last_not_of(' ') + 1);
+        auto column_ref = ResolveColumn(*table, std::vector{name});
+        include_cols.emplace_back(std::make_unique<BoundColumnRef>(dynamic_cast<const BoundColumnRef &>(*column_ref)));
+        begin = end + 1;
+      }
+    }
+  }
+
+  // `USING HASH` picks a hash index, the default access method and `USING BTREE` a B+ tree
+  auto index_type = IndexType::BPlusTreeIndex;
+  if (stmt->accessMethod != nullptr && StringUtil::Lower(stmt->accessMethod) == "hash") {
+    index_type = IndexType::HashTableIndex;
+  } else if (stmt->accessMethod != nullptr && StringUtil::Lower(stmt->accessMethod) != "btree" &&
+             std::string(stmt->accessMethod) != DEFAULT_INDEX_TYPE) {
+    throw NotImplementedException(fmt::format("unsupported index access method: {}", stmt->accessMethod));
+  }
+
+  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols), stmt->unique,
+                                          std::move(include_cols), bloom_filter_bits, index_type,
+                                          lazy_delete);
 }
 
 }  // namespace bustub
@@ -722,6 +722,16 @@ auto Binder::BindAExpr(duckdb_libpgquery::PGAExpr *root) -> std::unique_ptr<Boun
   BUSTUB_ASSERT(root, "nullptr");
   auto name = std::string((reinterpret_cast<duckdb_libpgquery::PGValue *>(root->name->head->data.ptr_value))->val.str);
 
+  // `x BETWEEN a AND b` is bound as `x >= a AND x <= b`
+  if (root->kind == duckdb_libpgquery::PG_AEXPR_BETWEEN) {
+    auto *bounds = reinterpret_cast<duckdb_libpgquery::PGList *>(root->rexpr);
+    auto lower = BindExpression(reinterpret_cast<duckdb_libpgquery::PGNode *>(bounds->head->data.ptr_value));
+    auto upper = BindExpression(reinterpret_cast<duckdb_libpgquery::PGNode *>(bounds->head->next->data.ptr_value));
+    auto lower_cmp = std::make_unique<BoundBinaryOp>(">=", BindExpression(root->lexpr), std::move(lower));
+    auto upper_cmp = std::make_unique<BoundBinaryOp>("<=", BindExpression(root->lexpr), std::move(upper));
+    return std::make_unique<BoundBinaryOp>("and", std::move(lower_cmp), std::move(upper_cmp));
+  }
+
   if (root->kind != duckdb_libpgquery::PG_AEXPR_OP) {
     throw bustub::Exception("unsupported op in AExpr");
   }
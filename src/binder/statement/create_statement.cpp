@@ -5,11 +5,15 @@
 
 namespace bustub {
 
-CreateStatement::CreateStatement(std::string table, std::vector<Column> columns)
-    : BoundStatement(StatementType::CREATE_STATEMENT), table_(std::move(table)), columns_(std::move(columns)) {}
+CreateStatement::CreateStatement(std::string table, std::vector<Column> columns, std::vector<std::string> primary_key)
+    : BoundStatement(StatementType::CREATE_STATEMENT),
+      table_(std::move(table)),
+      columns_(std::move(columns)),
+      primary_key_(std::move(primary_key)) {}
 
 auto CreateStatement::ToString() const -> std::string {
-  return fmt::format("BoundCreate {{\n  table={}\n  columns={}\n}}", table_, columns_);
+  return fmt::format("BoundCreate {{\n  table={}\n  columns={}\n  primary_key={}\n}}", table_, columns_,
+                     primary_key_);
 }
 
 }  // namespace bustub
@@ -7,14 +7,25 @@
 namespace bustub {
 
 IndexStatement::IndexStatement(std::string index_name, std::unique_ptr<BoundBaseTableRef> table,
-                               std::vector<std::unique_ptr<BoundColumnRef>> cols)
+                               std::vector<std::unique_ptr<BoundColumnRef>> cols, bool unique,
+                               std::vector<std::unique_ptr<BoundColumnRef>> include_cols, size_t bloom_filter_bits,
+                               IndexType index_type, bool lazy_delete)
     : BoundStatement(StatementType::INDEX_STATEMENT),
       index_name_(std::move(index_name)),
       table_(std::move(table)),
-      cols_(std::move(cols)) {}
+      cols_(std::move(cols)),
+      unique_(unique),
+      include_cols_(std::move(include_cols)),
+      bloom_filter_bits_(bloom_filter_bits),
+      index_type_(index_type),
+      lazy_delete_(lazy_delete) {}
 
 auto IndexStatement::ToString() const -> std::string {
-  return fmt::format("BoundIndex {{ index_name={}, table={}, cols={} }}", index_name_, *table_, cols_);
+  return fmt::format(
+      "BoundIndex {{ index_name={}, table={}, cols={}, unique={}, include={}, bloom_filter_bits={}, using={}, "
+      "lazy_delete={} }}",
+      index_name_, *table_, cols_, unique_, include_cols_, bloom_filter_bits_,
+      index_type_ == IndexType::HashTableIndex ? "hash" : "btree", lazy_delete_);
 }
 
 }  // namespace bustub
@@ -25,6 +25,7 @@
 #include "concurrency/transaction.h"
 #include "execution/execution_engine.h"
 #include "execution/executor_context.h"
+#include "execution/executor_factory.h"
 #include "execution/executors/mock_scan_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
@@ -40,9 +41,75 @@
 
 namespace bustub {
 
+namespace {
+
+/** Create a B+ tree index whose normalized keys fit in `KeySize` bytes */
+template <size_t KeySize>
+auto CreateBPlusTreeIndex(Catalog *catalog, Transaction *txn, const IndexStatement &stmt, const Schema &key_schema,
+                          const std::vector<uint32_t> &col_ids) -> IndexInfo * {
+  return catalog->CreateIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>>(
+      txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, KeySize,
+      HashFunction<GenericKey<KeySize>>{}, stmt.unique_, 0, stmt.bloom_filter_bits_, IndexType::BPlusTreeIndex,
+      stmt.lazy_delete_);
+}
+
+/** Create a hash index whose normalized keys fit in `KeySize` bytes */
+template <size_t KeySize>
+auto CreateHashIndex(Catalog *catalog, Transaction *txn, const IndexStatement &stmt, const Schema &key_schema,
+                     const std::vector<uint32_t> &col_ids) -> IndexInfo * {
+  return catalog->CreateIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>>(
+      txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, KeySize,
+      HashFunction<GenericKey<KeySize>>{}, false, 0, 0, IndexType::HashTableIndex);
+}
+
+/** Create a covering B+ tree index whose entries carry the values of all indexed columns in `PayloadSize` bytes */
+template <size_t KeySize, size_t PayloadSize>
+auto CreateCoveringIndex(Catalog *catalog, Transaction *txn, const IndexStatement &stmt, const Schema &key_schema,
+                         const std::vector<uint32_t> &col_ids) -> IndexInfo * {
+  return catalog->CreateIndex<GenericKey<KeySize>, CoveringPayload<PayloadSize>, GenericComparator<KeySize>>(
+      txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, KeySize,
+      HashFunction<GenericKey<KeySize>>{}, stmt.unique_, stmt.include_cols_.size(), stmt.bloom_filter_bits_,
+      IndexType::BPlusTreeIndex, stmt.lazy_delete_);
+}
+
+/** Create an index-organized table whose normalized primary keys fit in `KeySize` bytes */
+template <size_t KeySize, size_t PayloadSize>
+auto CreateClusteredTable(Catalog *catalog, Transaction *txn, const CreateStatement &stmt, const Schema &schema,
+                          const std::vector<uint32_t> &key_attrs) -> TableInfo * {
+  return catalog->CreateClusteredTable<GenericKey<KeySize>, TuplePayload<PayloadSize>, GenericComparator<KeySize>>(
+      txn, stmt.table_, schema, key_attrs, KeySize);
+}
+
+}  // namespace
+
 void BustubInstance::HandleCreateStatement(Transaction *txn, const CreateStatement &stmt, ResultWriter &writer) {
+  Schema schema(stmt.columns_);
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
-  auto info = catalog_->CreateTable(txn, stmt.table_, Schema(stmt.columns_));
+  TableInfo *info;
+  if (stmt.primary_key_.empty()) {
+    info = catalog_->CreateTable(txn, stmt.table_, schema);
+  } else {
+    // A table with a primary key keeps its tuples in the leaves of a clustered index, pick the smallest key and
+    // payload sizes that hold the normalized primary key and the largest tuple.
+    std::vector<uint32_t> key_attrs;
+    for (const auto &key_column : stmt.primary_key_) {
+      key_attrs.push_back(schema.GetColIdx(key_column));
+    }
+    size_t key_size = NormalizedKeySize(Schema::CopySchema(&schema, key_attrs));
+    size_t payload_size = MaxSerializedTupleSize(schema);
+    if (key_size > 64 || payload_size > 512) {
+      throw NotImplementedException("primary key or tuple is too wide for a clustered table");
+    }
+    if (key_size <= 16 && payload_size <= 128) {
+      info = CreateClusteredTable<16, 128>(catalog_, txn, stmt, schema, key_attrs);
+    } else if (key_size <= 16) {
+      info = CreateClusteredTable<16, 512>(catalog_, txn, stmt, schema, key_attrs);
+    } else if (payload_size <= 128) {
+      info = CreateClusteredTable<64, 128>(catalog_, txn, stmt, schema, key_attrs);
+    } else {
+      info = CreateClusteredTable<64, 512>(catalog_, txn, stmt, schema, key_attrs);
+    }
+  }
   l.unlock();
 
   if (info == nullptr) {
@@ -56,25 +123,87 @@ void BustubInstance::HandleIndexStatement(Transaction *txn, const IndexStatement
   for (const auto &col : stmt.cols_) {
     auto idx = stmt.table_->schema_.GetColIdx(col->col_name_.back());
     col_ids.push_back(idx);
-    if (stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
-      throw NotImplementedException("only support creating index on integer column");
-    }
+  }
+  if (col_ids.empty()) {
+    throw NotImplementedException("cannot create an index without columns");
+  }
+  if (catalog_->GetTable(stmt.table_->table_)->clustered_ != nullptr) {
+    throw NotImplementedException("secondary indexes on clustered tables are not supported");
+  }
+  if (stmt.index_type_ == IndexType::HashTableIndex) {
+    HandleHashIndexStatement(txn, stmt, col_ids, writer);
+    return;
+  }
+  // Index keys are normalized so that any mix of column types compares with memcmp, plus the RID suffix of a
+  // non-unique index. Pick the smallest key type that holds them.
+  size_t key_size = NormalizedKeySize(Schema::CopySchema(&stmt.table_->schema_, col_ids)) + sizeof(int64_t);
+
+  // The INCLUDE columns of a covering index follow the key columns in the key schema, the entries store them all.
+  for (const auto &col : stmt.include_cols_) {
+    col_ids.push_back(stmt.table_->schema_.GetColIdx(col->col_name_.back()));
   }
   auto key_schema = Schema::CopySchema(&stmt.table_->schema_, col_ids);
 
-  // TODO(spring2023): If you want to support composite index key for leaderboard optimization, remove this assertion
-  // and create index with different key type that can hold multiple keys based on number of index columns.
-  //
-  // You can also create clustered index that directly stores value inside the index by modifying the value type.
+  std::unique_lock<std::shared_mutex> l(catalog_lock_);
+  IndexInfo *info;
+  if (!stmt.include_cols_.empty()) {
+    size_t payload_size = MaxSerializedTupleSize(key_schema);
+    if (key_size > 64 || payload_size > 256) {
+      throw NotImplementedException("index key or included columns are too wide for a covering index");
+    }
+    if (key_size <= 16 && payload_size <= 64) {
+      info = CreateCoveringIndex<16, 64>(catalog_, txn, stmt, key_schema, col_ids);
+    } else if (key_size <= 16) {
+      info = CreateCoveringIndex<16, 256>(catalog_, txn, stmt, key_schema, col_ids);
+    } else if (payload_size <= 64) {
+      info = CreateCoveringIndex<64, 64>(catalog_, txn, stmt, key_schema, col_ids);
+    } else {
+      info = CreateCoveringIndex<64, 256>(catalog_, txn, stmt, key_schema, col_ids);
+    }
+  } else if (key_size <= 16) {
+    info = CreateBPlusTreeIndex<16>(catalog_, txn, stmt, key_schema, col_ids);
+  } else if (key_size <= 32) {
+    info = CreateBPlusTreeIndex<32>(catalog_, txn, stmt, key_schema, col_ids);
+  } else if (key_size <= 64) {
+    info = CreateBPlusTreeIndex<64>(catalog_, txn, stmt, key_schema, col_ids);
+  } else if (key_size <= 128) {
+    info = CreateBPlusTreeIndex<128>(catalog_, txn, stmt, key_schema, col_ids);
+  } else if (key_size <= 256) {
+    info = CreateBPlusTreeIndex<256>(catalog_, txn, stmt, key_schema, col_ids);
+  } else {
+    throw NotImplementedException(fmt::format("index key of {} bytes is too wide", key_size));
+  }
+  l.unlock();
 
-  if (col_ids.empty() || col_ids.size() > 2) {
-    throw NotImplementedException("only support creating index with exactly one or two columns");
+  if (info == nullptr) {
+    throw bustub::Exception("Failed to create index");
   }
+  WriteOneCell(fmt::format("Index created with id = {}", info->index_oid_), writer);
+}
+
+void BustubInstance::HandleHashIndexStatement(Transaction *txn, const IndexStatement &stmt,
+                                              const std::vector<uint32_t> &col_ids, ResultWriter &writer) {
+  // A hash index only maps whole keys to RIDs, it cannot check uniqueness, store INCLUDE columns or use a Bloom filter
+  if (stmt.unique_ || !stmt.include_cols_.empty() || stmt.bloom_filter_bits_ > 0 || stmt.lazy_delete_) {
+    throw NotImplementedException("hash indexes support no UNIQUE, include, bloom_filter_bits or lazy_delete");
+  }
+  // Normalized keys hash the same exactly when they compare equal, no RID suffix is needed in a hash table
+  auto key_schema = Schema::CopySchema(&stmt.table_->schema_, col_ids);
+  size_t key_size = NormalizedKeySize(key_schema);
 
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
-  auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
-      txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, TWO_INTEGER_SIZE,
-      IntegerHashFunctionType{});
+  IndexInfo *info;
+  if (key_size <= 8) {
+    info = CreateHashIndex<8>(catalog_, txn, stmt, key_schema, col_ids);
+  } else if (key_size <= 16) {
+    info = CreateHashIndex<16>(catalog_, txn, stmt, key_schema, col_ids);
+  } else if (key_size <= 32) {
+    info = CreateHashIndex<32>(catalog_, txn, stmt, key_schema, col_ids);
+  } else if (key_size <= 64) {
+    info = CreateHashIndex<64>(catalog_, txn, stmt, key_schema, col_ids);
+  } else {
+    throw NotImplementedException(fmt::format("hash index key of {} bytes is too wide", key_size));
+  }
   l.unlock();
 
   if (info == nullptr) {
@@ -120,6 +249,16 @@ void BustubInstance::HandleExplainStatement(Transaction *txn, const ExplainState
     output += "\n";
     output += optimized_plan->ToString(show_schema);
     output += "\n";
+
+    // Print how the plan runs on several workers.
+    if (GetParallelism() > 1) {
+      auto exec_ctx = MakeExecutorContext(txn, false);
+      exec_ctx->SetParallelism(GetParallelism());
+      output += "=== PARALLEL ===";
+      output += "\n";
+      output += ExecutorFactory::ExplainParallelPlan(exec_ctx.get(), optimized_plan, show_schema);
+      output += "\n";
+    }
   }
 
   WriteOneCell(output, writer);
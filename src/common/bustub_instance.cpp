@@ -282,6 +282,8 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
 
     // Execute the query.
     auto exec_ctx = MakeExecutorContext(txn, is_delete);
+    exec_ctx->SetParallelism(GetParallelism());
+    exec_ctx->SetMemoryBudget(GetMemoryBudget());
     if (check_options != nullptr) {
       exec_ctx->InitCheckOptions(std::move(check_options));
     }
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -26,7 +27,16 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::DiskExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                          const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+  // start with global depth 0: one bucket that every key maps to
+  auto *dir_page =
+      reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->NewPage(&directory_page_id_)->GetData());
+  dir_page->SetPageId(directory_page_id_);
+  page_id_t bucket_page_id;
+  reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->NewPage(&bucket_page_id)->GetData())->Init();
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
 }
 
 /*****************************************************************************
@@ -46,30 +56,48 @@ auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+  return Hash(key) & dir_page->GetGlobalDepthMask();
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t {
-  return 0;
+  return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  return nullptr;
+  return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  return nullptr;
+  return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->FetchPage(bucket_page_id)->GetData());
 }
 
+/*
+ * Latching: lookups, inserts and removes that stay inside one bucket share the table latch, which keeps the
+ * directory and the overflow chains stable, and latch only the bucket pages they touch. Splits, merges and new
+ * overflow pages change the structure, they take the table latch exclusively and then need no page latches at all.
+ */
+
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  table_latch_.RLock();
+  page_id_t page_id = KeyToPageId(key, FetchDirectoryPage());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  bool found = false;
+  while (page_id != INVALID_PAGE_ID) {
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id);
+    const auto *bucket = guard.template As<HASH_TABLE_BUCKET_TYPE>();
+    found = bucket->GetValue(key, comparator_, result) || found;
+    page_id = bucket->GetOverflowPageId();
+  }
+  table_latch_.RUnlock();
+  return found;
 }
 
 /*****************************************************************************
@@ -77,12 +105,189 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.RLock();
+  page_id_t bucket_page_id = KeyToPageId(key, FetchDirectoryPage());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(bucket_page_id);
+  auto *bucket = guard.template AsMut<HASH_TABLE_BUCKET_TYPE>();
+  if (!bucket->IsFull() && bucket->GetOverflowPageId() == INVALID_PAGE_ID) {
+    bool inserted = bucket->Insert(key, value, comparator_);
+    guard.Drop();
+    table_latch_.RUnlock();
+    return inserted;
+  }
+  guard.Drop();
+  table_latch_.RUnlock();
+
+  // the bucket is full or has overflowed, split it or extend its chain under the exclusive table latch
+  return SplitInsert(transaction, key, value);
 }
 
+/*
+ * Split the bucket of the key until it has room. Another thread may have split it in the meantime, so the bucket
+ * is looked up again under the exclusive latch. The directory doubles one level at a time, only when the bucket
+ * to split is already at the global depth. A bucket that no split can help, because its entries share the hash of
+ * the key or the directory page cannot double any more, gets another overflow page instead.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.WLock();
+  auto *dir_page = FetchDirectoryPage();
+  bool inserted = false;
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    // a duplicate pair is refused
+    if (ChainContains(bucket_page_id, key, value)) {
+      break;
+    }
+    if (ChainInsert(bucket_page_id, key, value, false)) {
+      inserted = true;
+      break;
+    }
+
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    if ((local_depth == dir_page->GetGlobalDepth() && dir_page->Size() * 2 > DIRECTORY_ARRAY_SIZE) ||
+        !ChainCanSplit(bucket_page_id, key)) {
+      inserted = ChainInsert(bucket_page_id, key, value, true);
+      break;
+    }
+    if (local_depth == dir_page->GetGlobalDepth()) {
+      dir_page->IncrGlobalDepth();
+    }
+
+    // the pointers with the next hash bit set move to the split image, and so do the entries
+    page_id_t image_page_id;
+    auto *image = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->NewPage(&image_page_id)->GetData());
+    image->Init();
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    uint32_t high_bit = dir_page->GetLocalHighBit(bucket_idx);
+    for (uint32_t i = 0; i < dir_page->Size(); i++) {
+      if (dir_page->GetBucketPageId(i) == bucket_page_id) {
+        dir_page->IncrLocalDepth(i);
+        if ((i & high_bit) != 0) {
+          dir_page->SetBucketPageId(i, image_page_id);
+        }
+      }
+    }
+    for (const auto &[entry_key, entry_value] : ChainDrain(bucket_page_id)) {
+      ChainInsert((Hash(entry_key) & high_bit) != 0 ? image_page_id : bucket_page_id, entry_key, entry_value, true);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  table_latch_.WUnlock();
+  return inserted;
+}
+
+/*****************************************************************************
+ * OVERFLOW CHAINS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainInsert(page_id_t bucket_page_id, const KeyType &key, const ValueType &value, bool extend)
+    -> bool {
+  page_id_t page_id = bucket_page_id;
+  while (true) {
+    auto *bucket = FetchBucketPage(page_id);
+    if (!bucket->IsFull()) {
+      bool inserted = bucket->Insert(key, value, comparator_);
+      buffer_pool_manager_->UnpinPage(page_id, inserted);
+      return inserted;
+    }
+    page_id_t next_page_id = bucket->GetOverflowPageId();
+    bool linked = false;
+    if (next_page_id == INVALID_PAGE_ID) {
+      if (!extend) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        return false;
+      }
+      auto *overflow =
+          reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->NewPage(&next_page_id)->GetData());
+      overflow->Init();
+      buffer_pool_manager_->UnpinPage(next_page_id, true);
+      bucket->SetOverflowPageId(next_page_id);
+      linked = true;
+    }
+    buffer_pool_manager_->UnpinPage(page_id, linked);
+    page_id = next_page_id;
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainContains(page_id_t bucket_page_id, const KeyType &key, const ValueType &value) -> bool {
+  bool found = false;
+  for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID && !found;) {
+    auto *bucket = FetchBucketPage(page_id);
+    std::vector<ValueType> values;
+    bucket->GetValue(key, comparator_, &values);
+    found = std::find(values.begin(), values.end(), value) != values.end();
+    page_id_t next_page_id = bucket->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainIsEmpty(page_id_t bucket_page_id) -> bool {
+  bool empty = true;
+  for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID && empty;) {
+    auto *bucket = FetchBucketPage(page_id);
+    empty = bucket->IsEmpty();
+    page_id_t next_page_id = bucket->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return empty;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainCanSplit(page_id_t bucket_page_id, const KeyType &key) -> bool {
+  uint32_t hash = Hash(key);
+  bool can_split = false;
+  for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID && !can_split;) {
+    auto *bucket = FetchBucketPage(page_id);
+    for (uint32_t slot = 0; slot < BUCKET_ARRAY_SIZE && bucket->IsOccupied(slot) && !can_split; slot++) {
+      can_split = bucket->IsReadable(slot) && Hash(bucket->KeyAt(slot)) != hash;
+    }
+    page_id_t next_page_id = bucket->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return can_split;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ChainDrain(page_id_t bucket_page_id) -> std::vector<MappingType> {
+  std::vector<MappingType> entries;
+  for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID;) {
+    auto *bucket = FetchBucketPage(page_id);
+    for (uint32_t slot = 0; slot < BUCKET_ARRAY_SIZE && bucket->IsOccupied(slot); slot++) {
+      if (bucket->IsReadable(slot)) {
+        entries.emplace_back(bucket->KeyAt(slot), bucket->ValueAt(slot));
+      }
+    }
+    page_id_t next_page_id = bucket->GetOverflowPageId();
+    if (page_id == bucket_page_id) {
+      bucket->Init();
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    } else {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    page_id = next_page_id;
+  }
+  return entries;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ChainDelete(page_id_t bucket_page_id) {
+  for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID;) {
+    page_id_t next_page_id = FetchBucketPage(page_id)->GetOverflowPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
 }
 
 /*****************************************************************************
@@ -90,14 +295,76 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.RLock();
+  page_id_t page_id = KeyToPageId(key, FetchDirectoryPage());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  // the whole chain is visited, a merge only drops a bucket whose overflow pages are empty as well
+  bool removed = false;
+  bool empty = true;
+  while (page_id != INVALID_PAGE_ID) {
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(page_id);
+    auto *bucket = guard.template AsMut<HASH_TABLE_BUCKET_TYPE>();
+    removed = removed || bucket->Remove(key, value, comparator_);
+    empty = empty && bucket->IsEmpty();
+    page_id = bucket->GetOverflowPageId();
+  }
+  table_latch_.RUnlock();
+
+  if (removed && empty) {
+    Merge(transaction, key, value);
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.WLock();
+  auto *dir_page = FetchDirectoryPage();
+  bool merged = false;
+  // a merge may leave an empty bucket next to an empty split image one level up, keep merging until it cannot
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    if (local_depth == 0) {
+      break;
+    }
+    uint32_t image_idx = dir_page->GetSplitImageIndex(bucket_idx);
+    if (dir_page->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+
+    // an insert may have refilled the bucket before the exclusive latch was taken
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = dir_page->GetBucketPageId(image_idx);
+    bool bucket_empty = ChainIsEmpty(bucket_page_id);
+    bool image_empty = ChainIsEmpty(image_page_id);
+    if (!bucket_empty && !image_empty) {
+      break;
+    }
+
+    // keep the bucket that still holds entries
+    page_id_t kept_page_id = bucket_empty ? image_page_id : bucket_page_id;
+    page_id_t dropped_page_id = bucket_empty ? bucket_page_id : image_page_id;
+    for (uint32_t i = 0; i < dir_page->Size(); i++) {
+      page_id_t page_id = dir_page->GetBucketPageId(i);
+      if (page_id == bucket_page_id || page_id == image_page_id) {
+        dir_page->SetBucketPageId(i, kept_page_id);
+        dir_page->SetLocalDepth(i, local_depth - 1);
+      }
+    }
+    ChainDelete(dropped_page_id);
+    while (dir_page->CanShrink()) {
+      dir_page->DecrGlobalDepth();
+    }
+    merged = true;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, merged);
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
@@ -10,7 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include <iostream>
+#include <algorithm>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -23,46 +24,281 @@
 namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                      const KeyComparator &comparator, size_t num_buckets,
-                                      HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+LINEAR_PROBE_HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name,
+                                                   BufferPoolManager *buffer_pool_manager,
+                                                   const KeyComparator &comparator, size_t num_buckets,
+                                                   HashFunction<KeyType> hash_fn)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  auto header_guard = buffer_pool_manager_->NewPageGuarded(&header_page_id_);
+  auto *header_page = header_guard.AsMut<HashTableHeaderPage>();
+  header_page->SetPageId(header_page_id_);
+  size_t num_blocks = (num_buckets + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE;
+  CreateNewBlockPages(header_page, std::clamp<size_t>(num_blocks, 1, HashTableHeaderPage::MaxNumBlocks()));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::Hash(const KeyType &key) -> size_t {
+  return static_cast<size_t>(hash_fn_.GetHash(key));
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key,
+                                            std::vector<ValueType> *result) -> bool {
+  table_latch_.RLock();
+  ReadPageGuard header_guard = buffer_pool_manager_->FetchPageRead(header_page_id_);
+  const auto *header_page = header_guard.As<HashTableHeaderPage>();
+  size_t size = header_page->GetSize();
+  size_t slot = Hash(key) % size;
+  size_t remaining = BLOCK_ARRAY_SIZE;
+  bool found = false;
+  while (remaining > 0) {
+    size_t block_idx = slot / BLOCK_ARRAY_SIZE;
+    slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+    ReadPageGuard block_guard = buffer_pool_manager_->FetchPageRead(header_page->GetBlockPageId(block_idx));
+    const auto *block = block_guard.template As<HASH_TABLE_BLOCK_TYPE>();
+
+    // the entries of the key lie before the first free slot
+    slot_offset_t end = std::min<size_t>(block->NextUnoccupied(offset), offset + remaining);
+    for (auto i = block->NextReadable(offset); i < end; i = block->NextReadable(i + 1)) {
+      if (comparator_(block->KeyAt(i), key) == 0) {
+        result->push_back(block->ValueAt(i));
+        found = true;
+      }
+    }
+    remaining -= end - offset;
+    if (end < BLOCK_ARRAY_SIZE) {
+      break;
+    }
+    slot = (block_idx + 1) * BLOCK_ARRAY_SIZE % size;
+  }
+  header_guard.Drop();
+  table_latch_.RUnlock();
+  return found;
 }
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key,
+                                          const ValueType &value) -> bool {
+  while (true) {
+    resize_latch_.RLock();
+    ReadPageGuard header_guard = buffer_pool_manager_->FetchPageRead(header_page_id_);
+    const auto *header_page = header_guard.As<HashTableHeaderPage>();
+    size_t size = header_page->GetSize();
+    size_t slot = Hash(key) % size;
+    size_t remaining = BLOCK_ARRAY_SIZE;
+    size_t same_key = 0;
+    std::optional<bool> inserted;
+    while (remaining > 0 && !inserted.has_value()) {
+      size_t block_idx = slot / BLOCK_ARRAY_SIZE;
+      slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+      WritePageGuard block_guard = buffer_pool_manager_->FetchPageWrite(header_page->GetBlockPageId(block_idx));
+      auto *block = block_guard.template AsMut<HASH_TABLE_BLOCK_TYPE>();
+
+      // reject a duplicate pair, then take the first free slot
+      slot_offset_t free = block->NextUnoccupied(offset);
+      slot_offset_t end = std::min<size_t>(free, offset + remaining);
+      for (auto i = block->NextReadable(offset); i < end && !inserted.has_value(); i = block->NextReadable(i + 1)) {
+        if (comparator_(block->KeyAt(i), key) == 0) {
+          same_key++;
+          if (block->ValueAt(i) == value) {
+            inserted = false;
+          }
+        }
+      }
+      if (!inserted.has_value() && free < offset + remaining && free < BLOCK_ARRAY_SIZE) {
+        inserted = block->Insert(free, key, value);
+      }
+      remaining -= end - offset;
+      slot = (block_idx + 1) * BLOCK_ARRAY_SIZE % size;
+    }
+    header_guard.Drop();
+    resize_latch_.RUnlock();
+    if (inserted.has_value()) {
+      // grow early, past three quarters full the runs a lookup scans get long
+      if (inserted.value() && (num_occupied_.fetch_add(1) + 1) * 4 > size * 3 &&
+          size < HashTableHeaderPage::MaxNumBlocks() * BLOCK_ARRAY_SIZE) {
+        Resize(size);
+      }
+      return inserted.value();
+    }
+
+    // No free slot near the home slot. A bigger table spreads the entries out, unless most of them share the key.
+    if (same_key * 2 >= BLOCK_ARRAY_SIZE) {
+      return false;
+    }
+    Resize(size);
+    if (GetSize() == size) {
+      return false;
+    }
+  }
 }
 
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key,
+                                          const ValueType &value) -> bool {
+  resize_latch_.RLock();
+  ReadPageGuard header_guard = buffer_pool_manager_->FetchPageRead(header_page_id_);
+  const auto *header_page = header_guard.As<HashTableHeaderPage>();
+  size_t size = header_page->GetSize();
+  size_t slot = Hash(key) % size;
+  size_t remaining = BLOCK_ARRAY_SIZE;
+  bool removed = false;
+  while (remaining > 0 && !removed) {
+    size_t block_idx = slot / BLOCK_ARRAY_SIZE;
+    slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+    WritePageGuard block_guard = buffer_pool_manager_->FetchPageWrite(header_page->GetBlockPageId(block_idx));
+    auto *block = block_guard.template AsMut<HASH_TABLE_BLOCK_TYPE>();
+
+    // the slot stays occupied as a tombstone, so probes for other keys still run past it
+    slot_offset_t end = std::min<size_t>(block->NextUnoccupied(offset), offset + remaining);
+    for (auto i = block->NextReadable(offset); i < end; i = block->NextReadable(i + 1)) {
+      if (comparator_(block->KeyAt(i), key) == 0 && block->ValueAt(i) == value) {
+        block->Remove(i);
+        removed = true;
+        break;
+      }
+    }
+    remaining -= end - offset;
+    if (end < BLOCK_ARRAY_SIZE) {
+      break;
+    }
+    slot = (block_idx + 1) * BLOCK_ARRAY_SIZE % size;
+  }
+  header_guard.Drop();
+  resize_latch_.RUnlock();
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
+/*
+ * Rehash every entry into a new set of block pages. Inserts and removes wait on the resize latch until the new table
+ * is in place, lookups go on reading the old pages and only wait for the header page id to be swapped.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void LINEAR_PROBE_HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  resize_latch_.WLock();
+  ReadPageGuard old_header_guard = buffer_pool_manager_->FetchPageRead(header_page_id_);
+  const auto *old_header_page = old_header_guard.As<HashTableHeaderPage>();
+  // another insert may have grown the table while this one waited for the latch
+  if (old_header_page->GetSize() > initial_size) {
+    old_header_guard.Drop();
+    resize_latch_.WUnlock();
+    return;
+  }
+
+  size_t num_blocks = (2 * initial_size + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE;
+  page_id_t new_header_page_id = INVALID_PAGE_ID;
+  while (new_header_page_id == INVALID_PAGE_ID) {
+    num_blocks = std::min(num_blocks, HashTableHeaderPage::MaxNumBlocks());
+    if (num_blocks <= old_header_page->NumBlocks()) {
+      // the header page cannot list any more blocks
+      old_header_guard.Drop();
+      resize_latch_.WUnlock();
+      return;
+    }
+
+    page_id_t header_page_id;
+    auto header_guard = buffer_pool_manager_->NewPageGuarded(&header_page_id);
+    auto *header_page = header_guard.AsMut<HashTableHeaderPage>();
+    header_page->SetPageId(header_page_id);
+    CreateNewBlockPages(header_page, num_blocks);
+
+    bool rehashed = true;
+    size_t num_rehashed = 0;
+    for (size_t block_idx = 0; block_idx < old_header_page->NumBlocks() && rehashed; block_idx++) {
+      ReadPageGuard block_guard = buffer_pool_manager_->FetchPageRead(old_header_page->GetBlockPageId(block_idx));
+      const auto *block = block_guard.template As<HASH_TABLE_BLOCK_TYPE>();
+      for (auto i = block->NextReadable(0); i < BLOCK_ARRAY_SIZE && rehashed; i = block->NextReadable(i + 1)) {
+        rehashed = ResizeInsert(header_page, block->KeyAt(i), block->ValueAt(i));
+        num_rehashed++;
+      }
+    }
+    if (rehashed) {
+      new_header_page_id = header_page_id;
+      // the tombstones are gone, only the live entries occupy the new blocks
+      num_occupied_ = num_rehashed;
+    } else {
+      // a run of entries still does not fit, try again with twice the blocks
+      DeleteBlockPages(header_page);
+      header_guard.Drop();
+      buffer_pool_manager_->DeletePage(header_page_id);
+      num_blocks *= 2;
+    }
+  }
+
+  table_latch_.WLock();
+  page_id_t old_header_page_id = header_page_id_;
+  header_page_id_ = new_header_page_id;
+  table_latch_.WUnlock();
+
+  DeleteBlockPages(old_header_page);
+  old_header_guard.Drop();
+  buffer_pool_manager_->DeletePage(old_header_page_id);
+  resize_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::ResizeInsert(const HashTableHeaderPage *header_page, const KeyType &key,
+                                                const ValueType &value) -> bool {
+  size_t size = header_page->GetSize();
+  size_t slot = Hash(key) % size;
+  size_t remaining = BLOCK_ARRAY_SIZE;
+  while (remaining > 0) {
+    size_t block_idx = slot / BLOCK_ARRAY_SIZE;
+    slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+    WritePageGuard block_guard = buffer_pool_manager_->FetchPageWrite(header_page->GetBlockPageId(block_idx));
+    auto *block = block_guard.template AsMut<HASH_TABLE_BLOCK_TYPE>();
+    slot_offset_t free = block->NextUnoccupied(offset);
+    if (free < offset + remaining && free < BLOCK_ARRAY_SIZE) {
+      return block->Insert(free, key, value);
+    }
+    remaining -= std::min<size_t>(BLOCK_ARRAY_SIZE, offset + remaining) - offset;
+    slot = (block_idx + 1) * BLOCK_ARRAY_SIZE % size;
+  }
+  return false;
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void LINEAR_PROBE_HASH_TABLE_TYPE::DeleteBlockPages(const HashTableHeaderPage *old_header_page) {
+  for (size_t block_idx = 0; block_idx < old_header_page->NumBlocks(); block_idx++) {
+    buffer_pool_manager_->DeletePage(old_header_page->GetBlockPageId(block_idx));
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void LINEAR_PROBE_HASH_TABLE_TYPE::CreateNewBlockPages(HashTableHeaderPage *header_page, size_t num_blocks) {
+  for (size_t block_idx = 0; block_idx < num_blocks; block_idx++) {
+    // a fresh page is all zeros, a block with no occupied slot
+    page_id_t block_page_id;
+    buffer_pool_manager_->NewPage(&block_page_id);
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+    header_page->AddBlockPageId(block_page_id);
+  }
+  header_page->SetSize(header_page->NumBlocks() * BLOCK_ARRAY_SIZE);
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::GetSize() -> size_t {
-  return 0;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::GetSize() -> size_t {
+  table_latch_.RLock();
+  ReadPageGuard header_guard = buffer_pool_manager_->FetchPageRead(header_page_id_);
+  size_t size = header_guard.As<HashTableHeaderPage>()->GetSize();
+  header_guard.Drop();
+  table_latch_.RUnlock();
+  return size;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
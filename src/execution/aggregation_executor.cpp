@@ -9,7 +9,9 @@
 // Copyright (c) 2015-2021, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <atomic>
 #include <memory>
+#include <utility>
 #include <vector>
 #include "type/type.h"
 
@@ -22,38 +24,229 @@ AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const Aggreg
     : AbstractExecutor(exec_ctx),
       plan_(plan),
       child_(std::move(child)),
-      aht_(plan->GetAggregates(), plan->GetAggregateTypes()),
-      aht_iterator_(aht_.Begin()),
+      tables_(1, SimpleAggregationHashTable(plan->GetAggregates(), plan->GetAggregateTypes())),
+      aht_iterator_(tables_[0].Begin()),
       num_of_tuples_(0) {}
 
 void AggregationExecutor::Init() {
   child_->Init();
-  aht_.Clear();
+  ResetTables(1);
+  pending_partitions_.clear();
   num_of_tuples_ = 0;
-  Tuple tuple;
-  RID rid;
-  while (child_->Next(&tuple, &rid)) {
-    aht_.InsertCombine(MakeAggregateKey(&tuple), MakeAggregateValue(&tuple));
-    num_of_tuples_++;
+  // 子节点是并行扫描时, 先让每个 worker 在自己的表里预聚合, 再按分区合并
+  if (auto *gather = dynamic_cast<GatherExecutor *>(child_.get()); gather != nullptr && gather->NumPipelines() > 1) {
+    AggregateInParallel(gather);
   }
-  aht_iterator_ = aht_.Begin();
+  // 按批从子节点取 (剩下的) tuple; 超过内存预算后, 新出现的 group 的行按 hash 分区写到临时页里
+  std::vector<std::unique_ptr<TmpTupleFile>> spill_files;
+  TupleBatch batch;
+  while (child_->NextBatch(&batch)) {
+    AggregateBatch(batch, 0, &spill_files);
+    num_of_tuples_ += static_cast<int>(batch.NumRows());
+  }
+  AddSpilledPartitions(std::move(spill_files), 0);
+  table_idx_ = 0;
+  aht_iterator_ = tables_[0].Begin();
+}
+
+void AggregationExecutor::AggregateInParallel(GatherExecutor *gather) {
+  // 第一遍: 每个 worker 把自己流水线的 batch 聚合到自己的表里, 表按 group 的哈希分区
+  auto num_workers = gather->NumPipelines();
+  auto num_tables = 4 * num_workers;
+  std::vector<std::vector<SimpleAggregationHashTable>> local_tables(num_workers);
+  for (auto &tables : local_tables) {
+    tables.reserve(num_tables);
+    for (size_t i = 0; i < num_tables; i++) {
+      tables.emplace_back(plan_->GetAggregates(), plan_->GetAggregateTypes());
+    }
+  }
+  std::vector<size_t> num_rows(num_workers, 0);
+  std::atomic<size_t> local_size{0};
+  auto ran = gather->RunPipelines([&](size_t worker, TupleBatch *batch) {
+    std::vector<std::vector<Value>> group_by_columns;
+    std::vector<std::vector<Value>> aggregate_columns;
+    EvaluateColumns(*batch, &group_by_columns, &aggregate_columns);
+    auto &tables = local_tables[worker];
+    for (size_t row = 0; row < batch->NumRows(); row++) {
+      auto agg_key = MakeAggregateKey(group_by_columns, row);
+      auto &table = tables[TableOf(std::hash<AggregateKey>{}(agg_key), num_tables)];
+      auto num_groups = table.Size();
+      table.InsertCombine(agg_key, aggregate_columns, row);
+      if (table.Size() != num_groups) {
+        local_size += GroupSize(agg_key);
+      }
+    }
+    num_rows[worker] += batch->NumRows();
+    // 超过内存预算就都停下, 剩下的输入由调用线程接着聚合, 需要时溢出到临时页
+    return local_size <= exec_ctx_->GetMemoryBudget();
+  });
+  if (!ran) {
+    return;
+  }
+
+  // 第二遍: 每个 worker 负责一部分分区, 把所有 worker 在这些分区里的部分聚合合并起来, 不需要加锁
+  ResetTables(num_tables);
+  std::vector<size_t> merged_size(num_workers, 0);
+  RunWorkers(num_workers, [&](size_t worker) {
+    for (size_t i = worker; i < num_tables; i += num_workers) {
+      for (auto &tables : local_tables) {
+        for (auto iter = tables[i].Begin(); iter != tables[i].End(); ++iter) {
+          auto num_groups = tables_[i].Size();
+          tables_[i].InsertMerge(iter.Key(), iter.Val());
+          if (tables_[i].Size() != num_groups) {
+            merged_size[worker] += GroupSize(iter.Key());
+          }
+        }
+        tables[i].Clear();
+      }
+    }
+  });
+  for (size_t worker = 0; worker < num_workers; worker++) {
+    table_size_ += merged_size[worker];
+    num_of_tuples_ += static_cast<int>(num_rows[worker]);
+  }
+}
+
+auto AggregationExecutor::MixHash(hash_t group_hash, uint64_t seed) -> uint64_t {
+  uint64_t hash = group_hash ^ (seed * 0x9e3779b97f4a7c15ULL);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+auto AggregationExecutor::PartitionOf(hash_t group_hash, size_t level) -> size_t {
+  // 每层用不同的种子把哈希再混一遍, 上一层落在同一个分区的 group 在下一层会被分开
+  return MixHash(group_hash, level + 1) % SPILL_FANOUT;
+}
+
+auto AggregationExecutor::TableOf(hash_t group_hash, size_t num_tables) -> size_t {
+  return num_tables == 1 ? 0 : MixHash(group_hash, 0) % num_tables;
+}
+
+void AggregationExecutor::ResetTables(size_t num_tables) {
+  tables_.clear();
+  tables_.reserve(num_tables);
+  for (size_t i = 0; i < num_tables; i++) {
+    tables_.emplace_back(plan_->GetAggregates(), plan_->GetAggregateTypes());
+  }
+  table_size_ = 0;
+}
+
+void AggregationExecutor::EvaluateColumns(const TupleBatch &batch, std::vector<std::vector<Value>> *group_by_columns,
+                                          std::vector<std::vector<Value>> *aggregate_columns) const {
+  // group by 和聚合表达式对整个 batch 按列一次算完
+  const auto &group_bys = plan_->GetGroupBys();
+  const auto &aggregates = plan_->GetAggregates();
+  group_by_columns->resize(group_bys.size());
+  aggregate_columns->resize(aggregates.size());
+  for (size_t i = 0; i < group_bys.size(); i++) {
+    group_bys[i]->EvaluateBatch(batch, &(*group_by_columns)[i]);
+  }
+  for (size_t i = 0; i < aggregates.size(); i++) {
+    aggregates[i]->EvaluateBatch(batch, &(*aggregate_columns)[i]);
+  }
+}
+
+auto AggregationExecutor::GroupSize(const AggregateKey &agg_key) const -> size_t {
+  // 哈希表的节点, 每个 Value, 再加上 varchar 自己分配的数据
+  size_t size = 4 * sizeof(void *) + sizeof(AggregateKey) + sizeof(AggregateValue) +
+                (agg_key.group_bys_.size() + plan_->GetAggregates().size()) * sizeof(Value);
+  for (const auto &value : agg_key.group_bys_) {
+    if (value.GetTypeId() == TypeId::VARCHAR && !value.IsNull()) {
+      size += value.GetLength();
+    }
+  }
+  return size;
+}
+
+void AggregationExecutor::AggregateBatch(const TupleBatch &batch, size_t spill_level,
+                                         std::vector<std::unique_ptr<TmpTupleFile>> *spill_files) {
+  std::vector<std::vector<Value>> group_by_columns;
+  std::vector<std::vector<Value>> aggregate_columns;
+  EvaluateColumns(batch, &group_by_columns, &aggregate_columns);
+  for (size_t row = 0; row < batch.NumRows(); row++) {
+    auto agg_key = MakeAggregateKey(group_by_columns, row);
+    auto group_hash = std::hash<AggregateKey>{}(agg_key);
+    auto &table = tables_[TableOf(group_hash, tables_.size())];
+    if (!spill_files->empty()) {
+      // 已经在表里的 group 继续在内存里聚合, 其余的行写到所在的分区
+      if (!table.CombineExisting(agg_key, aggregate_columns, row)) {
+        (*spill_files)[PartitionOf(group_hash, spill_level)]->Append(batch.GetTuple(row));
+      }
+      continue;
+    }
+    auto num_groups = table.Size();
+    table.InsertCombine(agg_key, aggregate_columns, row);
+    if (table.Size() == num_groups) {
+      continue;
+    }
+    table_size_ += GroupSize(agg_key);
+    // 分区的层数有上限, 再往下分的分区就不管内存预算, 直接聚合
+    if (table_size_ > exec_ctx_->GetMemoryBudget() && spill_level <= MAX_SPILL_LEVEL) {
+      spill_files->reserve(SPILL_FANOUT);
+      for (size_t i = 0; i < SPILL_FANOUT; i++) {
+        spill_files->push_back(std::make_unique<TmpTupleFile>(exec_ctx_->GetBufferPoolManager()));
+      }
+    }
+  }
+}
+
+void AggregationExecutor::AddSpilledPartitions(std::vector<std::unique_ptr<TmpTupleFile>> &&files, size_t level) {
+  for (auto &file : files) {
+    // 写完就 unpin, 等着被聚合的分区不占 buffer pool 的帧
+    file->Finish();
+    if (file->NumTuples() > 0) {
+      pending_partitions_.push_back({std::move(file), level});
+    }
+  }
+}
+
+auto AggregationExecutor::NextPartition() -> bool {
+  if (pending_partitions_.empty()) {
+    return false;
+  }
+  auto partition = std::move(pending_partitions_.back());
+  pending_partitions_.pop_back();
+  ResetTables(1);
+  std::vector<std::unique_ptr<TmpTupleFile>> spill_files;
+  TupleBatch batch;
+  while (partition.file_->ReadBatch(&batch, &child_->GetOutputSchema())) {
+    AggregateBatch(batch, partition.level_ + 1, &spill_files);
+  }
+  AddSpilledPartitions(std::move(spill_files), partition.level_ + 1);
+  table_idx_ = 0;
+  aht_iterator_ = tables_[0].Begin();
+  return true;
+}
+
+auto AggregationExecutor::SeekGroup() -> bool {
+  // 先输出内存里各个表的 group, 再一个分区一个分区地聚合
+  while (aht_iterator_ == tables_[table_idx_].End()) {
+    if (table_idx_ + 1 < tables_.size()) {
+      aht_iterator_ = tables_[++table_idx_].Begin();
+    } else if (!NextPartition()) {
+      return false;
+    }
+  }
+  return true;
 }
 
 auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   // 空表搭配 group by 不需要有任何输出
   if (num_of_tuples_ == 0 && plan_->group_bys_.empty()) {  // empty table
-    Tuple output_tuple(aht_.GenerateInitialAggregateValue().aggregates_, &plan_->OutputSchema());
+    Tuple output_tuple(tables_[0].GenerateInitialAggregateValue().aggregates_, &plan_->OutputSchema());
     *tuple = output_tuple;
     *rid = output_tuple.GetRid();
     --num_of_tuples_;  // 防止下次再次进入相同的逻辑
     return true;
   }
-  if (aht_iterator_ == aht_.End()) {
+  if (!SeekGroup()) {
     return false;
   }
-  std::vector<Value> values = aht_iterator_.Key().group_bys_;
-  values.insert(values.end(), aht_iterator_.Val().aggregates_.begin(), aht_iterator_.Val().aggregates_.end());
-  Tuple output_tuple(values, &plan_->OutputSchema());
+  Tuple output_tuple(MakeOutputValues(), &plan_->OutputSchema());
 
   *tuple = output_tuple;
   *rid = output_tuple.GetRid();
@@ -61,6 +254,21 @@ auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   return true;
 }
 
+auto AggregationExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&plan_->OutputSchema());
+  // 空表且没有 group by, 与 Next() 一样只输出一行初始值
+  if (num_of_tuples_ == 0 && plan_->group_bys_.empty()) {
+    batch->AppendRow(tables_[0].GenerateInitialAggregateValue().aggregates_);
+    --num_of_tuples_;
+    return true;
+  }
+  while (!batch->IsFull() && SeekGroup()) {
+    batch->AppendRow(MakeOutputValues());
+    ++aht_iterator_;
+  }
+  return !batch->IsEmpty();
+}
+
 auto AggregationExecutor::GetChildExecutor() const -> const AbstractExecutor * { return child_.get(); }
 
 }  // namespace bustub
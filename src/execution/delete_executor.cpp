@@ -38,7 +38,16 @@ auto DeleteExecutor::Next(Tuple *tuple, RID *rid) -> bool {
         return false;
     }
     int num_deleted = 0;
+    // 聚簇表直接从主键索引里删掉 tuple.
+    // 子节点正扫描同一棵树并持有叶子页的读锁, 先把主键都取出来
+    std::vector<Tuple> clustered_keys;
     while(child_executor_->Next(tuple, rid)){
+        if(table_info_->clustered_ != nullptr){
+            const auto *index = table_info_->clustered_;
+            clustered_keys.push_back(
+                tuple->KeyFromTuple(table_info_->schema_, *index->GetKeySchema(), index->GetKeyAttrs()));
+            continue;
+        }
         // 逻辑删除tuple
         TupleMeta delete_tuplemeta{INVALID_TXN_ID, INVALID_TXN_ID, true};
         table_info_->table_->UpdateTupleMeta(delete_tuplemeta, *rid);
@@ -49,6 +58,10 @@ auto DeleteExecutor::Next(Tuple *tuple, RID *rid) -> bool {
         }
         num_deleted++;
     }
+    for(const auto &key : clustered_keys){
+        table_info_->clustered_->DeleteEntry(key, RID(), exec_ctx_->GetTransaction());
+        num_deleted++;
+    }
     // 返回
     std::vector<Value> values = {{TypeId::INTEGER, num_deleted}};
     Tuple res{values, &this->GetOutputSchema()};
@@ -13,12 +13,16 @@
 #include "execution/executor_factory.h"
 
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "common/util/string_util.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/executors/aggregation_executor.h"
 #include "execution/executors/delete_executor.h"
 #include "execution/executors/filter_executor.h"
+#include "execution/executors/gather_executor.h"
 #include "execution/executors/hash_join_executor.h"
 #include "execution/executors/index_scan_executor.h"
 #include "execution/executors/init_check_executor.h"
@@ -37,16 +41,119 @@
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/mock_scan_plan.h"
 #include "execution/plans/projection_plan.h"
+#include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/sort_plan.h"
 #include "execution/plans/topn_plan.h"
 #include "execution/plans/values_plan.h"
 #include "storage/index/generic_key.h"
+#include "storage/table/morsel_dispenser.h"
 // 根据执行计划创建执行器
 namespace bustub {
 
+auto ExecutorFactory::IsParallelPipeline(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan) -> bool {
+  switch (plan->GetType()) {
+    case PlanType::Filter:
+    case PlanType::Projection:
+      return IsParallelPipeline(exec_ctx, plan->GetChildAt(0));
+    case PlanType::SeqScan: {
+      const auto *seq_scan_plan = dynamic_cast<const SeqScanPlanNode *>(plan.get());
+      // 聚簇表没有堆表, 只能按主键顺序扫描
+      return exec_ctx->GetCatalog()->GetTable(seq_scan_plan->GetTableOid())->clustered_ == nullptr;
+    }
+    default:
+      return false;
+  }
+}
+
+auto ExecutorFactory::MakeMorselDispenser(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan)
+    -> std::shared_ptr<MorselDispenser> {
+  if (!IsParallelPipeline(exec_ctx, plan)) {
+    return nullptr;
+  }
+  // 流水线最下面是顺序扫描
+  const auto *scan_plan = plan.get();
+  while (scan_plan->GetType() != PlanType::SeqScan) {
+    scan_plan = scan_plan->GetChildAt(0).get();
+  }
+  auto table_info = exec_ctx->GetCatalog()->GetTable(dynamic_cast<const SeqScanPlanNode *>(scan_plan)->GetTableOid());
+  return std::make_shared<MorselDispenser>(exec_ctx->GetBufferPoolManager(), table_info->table_.get());
+}
+
+auto ExecutorFactory::ExplainParallelPlan(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan,
+                                          bool with_schema) -> std::string {
+  if (IsParallelPipeline(exec_ctx, plan)) {
+    return fmt::format("Gather {{ workers={} }}\n{}", exec_ctx->GetParallelism(),
+                       StringUtil::IndentAllLines(plan->ToString(with_schema), 2));
+  }
+
+  // 只取这个节点自己的一行, 子节点按并行执行的方式重新展开
+  auto node = StringUtil::Split(plan->ToString(with_schema), '\n')[0];
+  switch (plan->GetType()) {
+    case PlanType::HashJoin:
+      node += IsParallelPipeline(exec_ctx, plan->GetChildAt(0)) ? " [parallel build, parallel probe]"
+                                                                 : " [parallel build]";
+      break;
+    case PlanType::Aggregation:
+      if (IsParallelPipeline(exec_ctx, plan->GetChildAt(0))) {
+        node += " [parallel pre-aggregation, partitioned merge]";
+      }
+      break;
+    case PlanType::Sort:
+      node += " [parallel runs, range-partitioned merge]";
+      break;
+    default:
+      break;
+  }
+  const auto &children = plan->GetChildren();
+  for (size_t i = 0; i < children.size(); i++) {
+    // 嵌套循环连接的内表在调用线程上执行, 原样输出
+    auto child = plan->GetType() == PlanType::NestedLoopJoin && i == 1
+                     ? children[i]->ToString(with_schema)
+                     : ExplainParallelPlan(exec_ctx, children[i], with_schema);
+    node += "\n" + StringUtil::IndentAllLines(child, 2);
+  }
+  return node;
+}
+
+auto ExecutorFactory::CreatePipeline(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan,
+                                     const std::shared_ptr<MorselDispenser> &dispenser)
+    -> std::unique_ptr<AbstractExecutor> {
+  switch (plan->GetType()) {
+    case PlanType::Filter: {
+      const auto *filter_plan = dynamic_cast<const FilterPlanNode *>(plan.get());
+      auto child = CreatePipeline(exec_ctx, filter_plan->GetChildPlan(), dispenser);
+      return std::make_unique<FilterExecutor>(exec_ctx, filter_plan, std::move(child));
+    }
+    case PlanType::Projection: {
+      const auto *projection_plan = dynamic_cast<const ProjectionPlanNode *>(plan.get());
+      auto child = CreatePipeline(exec_ctx, projection_plan->GetChildPlan(), dispenser);
+      return std::make_unique<ProjectionExecutor>(exec_ctx, projection_plan, std::move(child));
+    }
+    case PlanType::SeqScan:
+      return std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan.get()), dispenser);
+    default:
+      UNREACHABLE("Not a pipeline over a sequential scan.");
+  }
+}
+
 auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan)
     -> std::unique_ptr<AbstractExecutor> {
+  return ExecutorFactory::CreateExecutor(exec_ctx, plan, exec_ctx->GetParallelism());
+}
+
+auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan, size_t parallelism)
+    -> std::unique_ptr<AbstractExecutor> {
   auto check_options_set = exec_ctx->GetCheckOptions()->check_options_set_;
+  // 扫描 + 过滤 + 投影的流水线可以并行: 每个 worker 一份流水线, 从同一个 dispenser 领取 morsel
+  if (parallelism > 1) {
+    if (auto dispenser = MakeMorselDispenser(exec_ctx, plan); dispenser != nullptr) {
+      std::vector<std::unique_ptr<AbstractExecutor>> pipelines;
+      for (size_t i = 0; i < parallelism; i++) {
+        pipelines.push_back(CreatePipeline(exec_ctx, plan, dispenser));
+      }
+      return std::make_unique<GatherExecutor>(exec_ctx, plan.get(), std::move(dispenser), std::move(pipelines));
+    }
+  }
   switch (plan->GetType()) {
     // Create a new sequential scan executor
     case PlanType::SeqScan: {
@@ -61,43 +168,44 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
     // Create a new insert executor
     case PlanType::Insert: {
       auto insert_plan = dynamic_cast<const InsertPlanNode *>(plan.get());
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, insert_plan->GetChildPlan());
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, insert_plan->GetChildPlan(), parallelism);
       return std::make_unique<InsertExecutor>(exec_ctx, insert_plan, std::move(child_executor));
     }
 
     // Create a new update executor
     case PlanType::Update: {
       auto update_plan = dynamic_cast<const UpdatePlanNode *>(plan.get());
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, update_plan->GetChildPlan());
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, update_plan->GetChildPlan(), parallelism);
       return std::make_unique<UpdateExecutor>(exec_ctx, update_plan, std::move(child_executor));
     }
 
     // Create a new delete executor
     case PlanType::Delete: {
       auto delete_plan = dynamic_cast<const DeletePlanNode *>(plan.get());
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, delete_plan->GetChildPlan());
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, delete_plan->GetChildPlan(), parallelism);
       return std::make_unique<DeleteExecutor>(exec_ctx, delete_plan, std::move(child_executor));
     }
 
     // Create a new limit executor
     case PlanType::Limit: {
       auto limit_plan = dynamic_cast<const LimitPlanNode *>(plan.get());
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, limit_plan->GetChildPlan());
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, limit_plan->GetChildPlan(), parallelism);
       return std::make_unique<LimitExecutor>(exec_ctx, limit_plan, std::move(child_executor));
     }
 
     // Create a new aggregation executor
     case PlanType::Aggregation: {
       auto agg_plan = dynamic_cast<const AggregationPlanNode *>(plan.get());
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, agg_plan->GetChildPlan());
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, agg_plan->GetChildPlan(), parallelism);
       return std::make_unique<AggregationExecutor>(exec_ctx, agg_plan, std::move(child_executor));
     }
 
     // Create a new nested-loop join executor
     case PlanType::NestedLoopJoin: {
       auto nested_loop_join_plan = dynamic_cast<const NestedLoopJoinPlanNode *>(plan.get());
-      auto left = ExecutorFactory::CreateExecutor(exec_ctx, nested_loop_join_plan->GetLeftPlan());
-      auto right = ExecutorFactory::CreateExecutor(exec_ctx, nested_loop_join_plan->GetRightPlan());
+      auto left = ExecutorFactory::CreateExecutor(exec_ctx, nested_loop_join_plan->GetLeftPlan(), parallelism);
+      // 内表每读一行外表就要重新 Init 一次, 每次都重新起线程得不偿失, 整棵内表子树都在调用线程上执行
+      auto right = ExecutorFactory::CreateExecutor(exec_ctx, nested_loop_join_plan->GetRightPlan(), 1);
       if (check_options_set.find(CheckOption::ENABLE_NLJ_CHECK) != check_options_set.end()) {
         auto left_check =
             std::make_unique<InitCheckExecutor>(exec_ctx, nested_loop_join_plan->GetLeftPlan(), std::move(left));
@@ -114,16 +222,17 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
     // Create a new nested-index join executor
     case PlanType::NestedIndexJoin: {
       auto nested_index_join_plan = dynamic_cast<const NestedIndexJoinPlanNode *>(plan.get());
-      auto left = ExecutorFactory::CreateExecutor(exec_ctx, nested_index_join_plan->GetChildPlan());
+      auto left = ExecutorFactory::CreateExecutor(exec_ctx, nested_index_join_plan->GetChildPlan(), parallelism);
       return std::make_unique<NestIndexJoinExecutor>(exec_ctx, nested_index_join_plan, std::move(left));
     }
 
     // Create a new hash join executor
     case PlanType::HashJoin: {
       auto hash_join_plan = dynamic_cast<const HashJoinPlanNode *>(plan.get());
-      auto left = ExecutorFactory::CreateExecutor(exec_ctx, hash_join_plan->GetLeftPlan());
-      auto right = ExecutorFactory::CreateExecutor(exec_ctx, hash_join_plan->GetRightPlan());
-      return std::make_unique<HashJoinExecutor>(exec_ctx, hash_join_plan, std::move(left), std::move(right));
+      auto left = ExecutorFactory::CreateExecutor(exec_ctx, hash_join_plan->GetLeftPlan(), parallelism);
+      auto right = ExecutorFactory::CreateExecutor(exec_ctx, hash_join_plan->GetRightPlan(), parallelism);
+      return std::make_unique<HashJoinExecutor>(exec_ctx, hash_join_plan, std::move(left), std::move(right),
+                                                parallelism);
     }
 
     // Create a new mock scan executor
@@ -135,14 +244,14 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
     // Create a new projection executor
     case PlanType::Projection: {
       const auto *projection_plan = dynamic_cast<const ProjectionPlanNode *>(plan.get());
-      auto child = ExecutorFactory::CreateExecutor(exec_ctx, projection_plan->GetChildPlan());
+      auto child = ExecutorFactory::CreateExecutor(exec_ctx, projection_plan->GetChildPlan(), parallelism);
       return std::make_unique<ProjectionExecutor>(exec_ctx, projection_plan, std::move(child));
     }
 
       // Create a new filter executor
     case PlanType::Filter: {
       const auto *filter_plan = dynamic_cast<const FilterPlanNode *>(plan.get());
-      auto child = ExecutorFactory::CreateExecutor(exec_ctx, filter_plan->GetChildPlan());
+      auto child = ExecutorFactory::CreateExecutor(exec_ctx, filter_plan->GetChildPlan(), parallelism);
       return std::make_unique<FilterExecutor>(exec_ctx, filter_plan, std::move(child));
     }
 
@@ -155,14 +264,14 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
       // Create a new sort executor
     case PlanType::Sort: {
       const auto *sort_plan = dynamic_cast<const SortPlanNode *>(plan.get());
-      auto child = ExecutorFactory::CreateExecutor(exec_ctx, sort_plan->GetChildPlan());
-      return std::make_unique<SortExecutor>(exec_ctx, sort_plan, std::move(child));
+      auto child = ExecutorFactory::CreateExecutor(exec_ctx, sort_plan->GetChildPlan(), parallelism);
+      return std::make_unique<SortExecutor>(exec_ctx, sort_plan, std::move(child), parallelism);
     }
 
       // Create a new topN executor
     case PlanType::TopN: {
       const auto *topn_plan = dynamic_cast<const TopNPlanNode *>(plan.get());
-      auto child = ExecutorFactory::CreateExecutor(exec_ctx, topn_plan->GetChildPlan());
+      auto child = ExecutorFactory::CreateExecutor(exec_ctx, topn_plan->GetChildPlan(), parallelism);
       if (check_options_set.find(CheckOption::ENABLE_TOPN_CHECK) != check_options_set.end()) {
         auto topn_executor = std::make_unique<TopNExecutor>(exec_ctx, topn_plan, nullptr);
         auto check = std::make_unique<TopNCheckExecutor>(exec_ctx, topn_plan, std::move(child), topn_executor.get());
@@ -31,4 +31,26 @@ auto FilterExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   }
 }
 
+auto FilterExecutor::NextBatch(TupleBatch *batch) -> bool {
+  const auto &filter_expr = plan_->GetPredicate();
+  std::vector<Value> values;
+  std::vector<uint32_t> sel;
+
+  // The filter keeps the schema of its child, the child fills the batch and the filter drops the rows that fail
+  while (child_executor_->NextBatch(batch)) {
+    filter_expr->EvaluateBatch(*batch, &values);
+    sel.clear();
+    for (uint32_t row = 0; row < values.size(); row++) {
+      if (!values[row].IsNull() && values[row].GetAs<bool>()) {
+        sel.push_back(row);
+      }
+    }
+    if (!sel.empty()) {
+      batch->Select(sel);
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace bustub
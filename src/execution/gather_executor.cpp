@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// gather_executor.cpp
+//
+// Identification: src/execution/gather_executor.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/gather_executor.h"
+
+#include <utility>
+
+namespace bustub {
+
+GatherExecutor::GatherExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan,
+                               std::shared_ptr<MorselDispenser> dispenser,
+                               std::vector<std::unique_ptr<AbstractExecutor>> &&pipelines)
+    : AbstractExecutor(exec_ctx), plan_(plan), dispenser_(std::move(dispenser)), pipelines_(std::move(pipelines)) {}
+
+GatherExecutor::~GatherExecutor() { exchange_.Stop(); }
+
+void GatherExecutor::Init() {
+  exchange_.Stop();
+  dispenser_->Reset();
+  run_inline_ = dispenser_->IsSinglePage();
+  for (auto &pipeline : pipelines_) {
+    pipeline->Init();
+  }
+  current_batch_.Reset(&GetOutputSchema());
+  current_row_ = 0;
+}
+
+auto GatherExecutor::NextBatch(TupleBatch *batch) -> bool {
+  if (run_inline_) {
+    return pipelines_[0]->NextBatch(batch);
+  }
+  if (!exchange_.IsStarted()) {
+    exchange_.Start(pipelines_.size(), [this](size_t worker) {
+      TupleBatch batch;
+      while (pipelines_[worker]->NextBatch(&batch)) {
+        if (!exchange_.Push(&batch)) {
+          return;
+        }
+      }
+    });
+  }
+  return exchange_.Pop(batch, &GetOutputSchema());
+}
+
+auto GatherExecutor::RunPipelines(const std::function<bool(size_t, TupleBatch *)> &consume) -> bool {
+  if (run_inline_ || exchange_.IsStarted()) {
+    return false;
+  }
+  RunWorkers(pipelines_.size(), [&](size_t worker) {
+    TupleBatch batch;
+    while (pipelines_[worker]->NextBatch(&batch)) {
+      if (!consume(worker, &batch)) {
+        return;
+      }
+    }
+  });
+  return true;
+}
+
+auto GatherExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (current_row_ == current_batch_.NumRows()) {
+    current_row_ = 0;
+    if (!NextBatch(&current_batch_)) {
+      return false;
+    }
+  }
+  *tuple = current_batch_.GetTuple(current_row_);
+  *rid = current_batch_.GetRID(current_row_);
+  current_row_++;
+  return true;
+}
+
+}  // namespace bustub
@@ -11,8 +11,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "execution/executors/hash_join_executor.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
 #include "binder/table_ref/bound_join_ref.h"
 #include "common/config.h"
 #include "common/rid.h"
@@ -22,8 +26,12 @@ namespace bustub {
 
 HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                                    std::unique_ptr<AbstractExecutor> &&left_child,
-                                   std::unique_ptr<AbstractExecutor> &&right_child)
-    : AbstractExecutor(exec_ctx),plan_(plan), left_executor_(std::move(left_child)), right_executor_(std::move(right_child)) {
+                                   std::unique_ptr<AbstractExecutor> &&right_child, size_t parallelism)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_child)),
+      right_executor_(std::move(right_child)),
+      parallelism_(parallelism) {
   if (plan->GetJoinType() != JoinType::LEFT && plan->GetJoinType() != JoinType::INNER) {
     // Note for 2023 Spring: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
@@ -31,24 +39,258 @@ HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlan
 }
 
 void HashJoinExecutor::Init() {
+  // 先停掉上一轮的探测线程, 它们还在读左表
+  exchange_.Stop();
   // 方便left_join, 对右边/内表进行hash
   left_executor_->Init();
   right_executor_->Init();
-  ht_.clear();
   is_begin_ = true;
+  left_batch_.Reset(&plan_->GetLeftPlan()->OutputSchema());
+  left_row_ = 0;
+  spilled_ = false;
+  pending_partitions_.clear();
+  current_partition_ = {};
+  output_batch_.Reset(&plan_->OutputSchema());
+  output_row_ = 0;
 
-  Tuple tuple;
-  RID rid;
-  while (right_executor_->Next(&tuple, &rid)) {
-    JoinKey join_key = MakeJoinKey(tuple, plan_->RightJoinKeyExpressions(), plan_->GetRightPlan());
-    InsertJoinKey(join_key, tuple);
+  // 右表超过内存预算就改成 grace hash join: 两边按 join key 分区写到临时页里, 再一个分区一个分区地做
+  std::vector<TupleBatch> right_batches;
+  size_t right_size = 0;
+  TupleBatch batch;
+  while (right_executor_->NextBatch(&batch)) {
+    for (size_t row = 0; row < batch.NumRows(); row++) {
+      right_size += batch.GetTupleSize(row);
+    }
+    right_batches.push_back(std::move(batch));
+    if (right_size > exec_ctx_->GetMemoryBudget()) {
+      Spill(std::move(right_batches));
+      return;
+    }
+  }
+  Build(std::move(right_batches));
+}
+
+auto HashJoinExecutor::PartitionOf(hash_t join_key_hash, size_t level) -> size_t {
+  // 每层用不同的种子把哈希再混一遍, 上一层落在同一个分区的 key 在下一层会被分开
+  uint64_t hash = join_key_hash ^ ((level + 1) * 0x9e3779b97f4a7c15ULL);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash % SPILL_FANOUT;
+}
+
+auto HashJoinExecutor::MakeSpillFiles() -> std::vector<std::unique_ptr<TmpTupleFile>> {
+  std::vector<std::unique_ptr<TmpTupleFile>> files;
+  files.reserve(SPILL_FANOUT);
+  for (size_t i = 0; i < SPILL_FANOUT; i++) {
+    files.push_back(std::make_unique<TmpTupleFile>(exec_ctx_->GetBufferPoolManager()));
+  }
+  return files;
+}
+
+void HashJoinExecutor::SpillBatch(const TupleBatch &batch, bool is_left, size_t level,
+                                  std::vector<std::unique_ptr<TmpTupleFile>> *files) {
+  std::vector<std::vector<Value>> key_columns;
+  EvaluateKeys(batch, is_left ? plan_->LeftJoinKeyExpressions() : plan_->RightJoinKeyExpressions(), &key_columns);
+  std::vector<char> key;
+  for (size_t row = 0; row < batch.NumRows(); row++) {
+    if (!JoinHashTable::SerializeKey(key_columns, row, &key)) {
+      // join key 有 null 的行匹配不上, 只有 left join 的左表还要输出它
+      if (!is_left || plan_->GetJoinType() != JoinType::LEFT) {
+        continue;
+      }
+      key.clear();
+    }
+    (*files)[PartitionOf(JoinHashTable::HashKey(key), level)]->Append(batch.GetTuple(row));
+  }
+}
+
+void HashJoinExecutor::AddSpilledPartitions(std::vector<std::unique_ptr<TmpTupleFile>> &&left_files,
+                                            std::vector<std::unique_ptr<TmpTupleFile>> &&right_files, size_t level) {
+  for (size_t i = 0; i < SPILL_FANOUT; i++) {
+    // 写完就 unpin, 等着被 join 的分区不占 buffer pool 的帧
+    left_files[i]->Finish();
+    right_files[i]->Finish();
+    pending_partitions_.push_back({std::move(left_files[i]), std::move(right_files[i]), level});
+  }
+}
+
+void HashJoinExecutor::Spill(std::vector<TupleBatch> &&right_batches) {
+  spilled_ = true;
+  partitions_.clear();
+  auto right_files = MakeSpillFiles();
+  for (const auto &batch : right_batches) {
+    SpillBatch(batch, false, 0, &right_files);
+  }
+  right_batches.clear();
+  TupleBatch batch;
+  while (right_executor_->NextBatch(&batch)) {
+    SpillBatch(batch, false, 0, &right_files);
+  }
+  auto left_files = MakeSpillFiles();
+  while (left_executor_->NextBatch(&batch)) {
+    SpillBatch(batch, true, 0, &left_files);
+  }
+  AddSpilledPartitions(std::move(left_files), std::move(right_files), 0);
+}
+
+void HashJoinExecutor::Repartition(SpilledPartition &&partition) {
+  auto level = partition.level_ + 1;
+  TupleBatch batch;
+  auto right_files = MakeSpillFiles();
+  while (partition.right_->ReadBatch(&batch, &plan_->GetRightPlan()->OutputSchema())) {
+    SpillBatch(batch, false, level, &right_files);
+  }
+  auto left_files = MakeSpillFiles();
+  while (partition.left_->ReadBatch(&batch, &plan_->GetLeftPlan()->OutputSchema())) {
+    SpillBatch(batch, true, level, &left_files);
+  }
+  AddSpilledPartitions(std::move(left_files), std::move(right_files), level);
+}
+
+auto HashJoinExecutor::NextLeftBatch(TupleBatch *batch) -> bool {
+  if (!spilled_) {
+    return left_executor_->NextBatch(batch);
+  }
+  const auto &left_schema = plan_->GetLeftPlan()->OutputSchema();
+  while (true) {
+    if (current_partition_.left_ != nullptr && current_partition_.left_->ReadBatch(batch, &left_schema)) {
+      return true;
+    }
+    // 释放做完的分区, 它的页也一起删掉
+    current_partition_ = {};
+    if (pending_partitions_.empty()) {
+      batch->Reset(&left_schema);
+      return false;
+    }
+    auto partition = std::move(pending_partitions_.back());
+    pending_partitions_.pop_back();
+    // 左边为空没有输出; inner join 右边为空也没有输出
+    if (partition.left_->NumTuples() == 0 ||
+        (partition.right_->NumTuples() == 0 && plan_->GetJoinType() == JoinType::INNER)) {
+      continue;
+    }
+    // 右边还是放不下就再分一次区; 层数有上限, 同一个 key 的行太多时再分也不会变小
+    if (partition.right_->GetSize() > exec_ctx_->GetMemoryBudget() && partition.level_ < MAX_SPILL_LEVEL) {
+      Repartition(std::move(partition));
+      continue;
+    }
+    std::vector<TupleBatch> right_batches;
+    TupleBatch right_batch;
+    while (partition.right_->ReadBatch(&right_batch, &plan_->GetRightPlan()->OutputSchema())) {
+      right_batches.push_back(std::move(right_batch));
+    }
+    Build(std::move(right_batches));
+    current_partition_ = std::move(partition);
+  }
+}
+
+void HashJoinExecutor::EvaluateKeys(const TupleBatch &batch, const std::vector<AbstractExpressionRef> &exprs,
+                                    std::vector<std::vector<Value>> *key_columns) {
+  // 每批的 join key 按列一次算完
+  key_columns->resize(exprs.size());
+  for (size_t i = 0; i < exprs.size(); i++) {
+    exprs[i]->EvaluateBatch(batch, &(*key_columns)[i]);
+  }
+}
+
+void HashJoinExecutor::Build(std::vector<TupleBatch> &&right_batches) {
+  const auto &right_schema = plan_->GetRightPlan()->OutputSchema();
+  const auto &right_exprs = plan_->RightJoinKeyExpressions();
+  auto num_workers = std::min(parallelism_, right_batches.size());
+  std::vector<std::vector<Value>> key_columns;
+  std::vector<char> key;
+  if (num_workers <= 1) {
+    partitions_.assign(1, JoinHashTable(&right_schema));
+    size_t num_rows = 0;
+    for (const auto &batch : right_batches) {
+      num_rows += batch.NumRows();
+    }
+    partitions_[0].Reserve(num_rows);
+    for (const auto &batch : right_batches) {
+      EvaluateKeys(batch, right_exprs, &key_columns);
+      for (size_t row = 0; row < batch.NumRows(); row++) {
+        if (JoinHashTable::SerializeKey(key_columns, row, &key)) {
+          partitions_[0].Insert(key, JoinHashTable::HashKey(key), batch, row);
+        }
+      }
+    }
+    return;
+  }
+
+  // 分区数取 worker 数的几倍, 建表时各 worker 的工作量更均匀
+  auto num_partitions = 4 * num_workers;
+  partitions_.assign(num_partitions, JoinHashTable(&right_schema));
+  // 第一遍: 每个 worker 算出自己那部分右表的 join key 和哈希, 按分区记下行的位置
+  struct BuildRow {
+    uint32_t batch_;
+    uint32_t row_;
+    hash_t hash_;
+  };
+  std::vector<std::vector<std::vector<Value>>> batch_key_columns(right_batches.size());
+  std::vector<std::vector<std::vector<BuildRow>>> buffers(num_workers,
+                                                          std::vector<std::vector<BuildRow>>(num_partitions));
+  RunWorkers(num_workers, [&](size_t worker) {
+    std::vector<char> worker_key;
+    for (size_t i = worker; i < right_batches.size(); i += num_workers) {
+      EvaluateKeys(right_batches[i], right_exprs, &batch_key_columns[i]);
+      for (size_t row = 0; row < right_batches[i].NumRows(); row++) {
+        if (JoinHashTable::SerializeKey(batch_key_columns[i], row, &worker_key)) {
+          auto hash = JoinHashTable::HashKey(worker_key);
+          buffers[worker][(hash >> 32) % num_partitions].push_back(
+              {static_cast<uint32_t>(i), static_cast<uint32_t>(row), hash});
+        }
+      }
+    }
+  });
+  // 第二遍: 每个分区只由一个 worker 建表, 不需要加锁
+  RunWorkers(num_workers, [&](size_t worker) {
+    std::vector<char> worker_key;
+    for (size_t partition = worker; partition < num_partitions; partition += num_workers) {
+      auto &table = partitions_[partition];
+      size_t num_rows = 0;
+      for (const auto &buffer : buffers) {
+        num_rows += buffer[partition].size();
+      }
+      table.Reserve(num_rows);
+      for (const auto &buffer : buffers) {
+        for (const auto &build_row : buffer[partition]) {
+          JoinHashTable::SerializeKey(batch_key_columns[build_row.batch_], build_row.row_, &worker_key);
+          table.Insert(worker_key, build_row.hash_, right_batches[build_row.batch_], build_row.row_);
+        }
+      }
+    }
+  });
+}
+
+auto HashJoinExecutor::FindMatch(const std::vector<std::vector<Value>> &key_columns, size_t row,
+                                 std::vector<char> *key) const -> std::pair<const JoinHashTable *, uint64_t> {
+  if (!JoinHashTable::SerializeKey(key_columns, row, key)) {
+    return {nullptr, JoinHashTable::NO_ROW};
   }
+  auto hash = JoinHashTable::HashKey(*key);
+  const auto &table = FindPartition(hash);
+  return {&table, table.Find(*key, hash)};
 }
 
 auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   auto &left_plan_schema = plan_->GetLeftPlan()->OutputSchema();
   auto &right_plan_schema = plan_->GetRightPlan()->OutputSchema();
 
+  if (spilled_) {
+    // 左表已经写进了临时页, 从 NextBatch 的输出里一个一个取
+    while (output_row_ >= output_batch_.NumRows()) {
+      output_row_ = 0;
+      if (!NextBatch(&output_batch_)) {
+        return false;
+      }
+    }
+    *tuple = output_batch_.GetTuple(output_row_++);
+    return true;
+  }
+
   while (true) {
     if (is_begin_) {
       is_begin_ = false;
@@ -56,32 +298,151 @@ auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
       if (!status) {
         return false;
       }
-      JoinKey left_join_key = MakeJoinKey(left_tuple_, plan_->LeftJoinKeyExpressions(), plan_->GetLeftPlan());
-      range_pair_it_ = ht_.equal_range(left_join_key);
-      cur_it_ = range_pair_it_.first;
-      bucket_finished_ = (cur_it_ == range_pair_it_.second);
+      std::vector<std::vector<Value>> key_columns;
+      for (const auto &expr : plan_->LeftJoinKeyExpressions()) {
+        key_columns.push_back({expr->Evaluate(&left_tuple_, left_plan_schema)});
+      }
+      std::tie(cur_table_, cur_row_) = FindMatch(key_columns, 0, &left_key_);
+      bucket_finished_ = (cur_row_ == JoinHashTable::NO_ROW);
     }
     // 没有对应的kv
     if (bucket_finished_) {
       is_begin_ = true;
       if (plan_->join_type_ == JoinType::LEFT) {
-        OutputTuple(left_plan_schema, right_plan_schema, nullptr, tuple, false);  // left join
+        OutputTuple(left_plan_schema, right_plan_schema, nullptr, JoinHashTable::NO_ROW, tuple, false);  // left join
         return true;
       }
       continue;
     }
 
-    Tuple right_tuple = cur_it_->second;
-    cur_it_++;
-    OutputTuple(left_plan_schema, right_plan_schema, &right_tuple, tuple, true);
-    if (cur_it_ == range_pair_it_.second) {
+    OutputTuple(left_plan_schema, right_plan_schema, cur_table_, cur_row_, tuple, true);
+    cur_row_ = cur_table_->NextRow(cur_row_);
+    if (cur_row_ == JoinHashTable::NO_ROW) {
       is_begin_ = true;
     }
     return true;
   }
 }
-auto HashJoinExecutor::OutputTuple(const Schema &left_table_schema, const Schema &right_table_schema, Tuple *right_tuple,
-                                   Tuple *tuple, bool matched)->void{
+auto HashJoinExecutor::NextBatch(TupleBatch *batch) -> bool {
+  // 只有左表是并行扫描时才并行探测: 每个 worker 探测自己流水线的 batch, 别的子节点只能在一个线程上拉取.
+  // 溢出到临时页以后分区是一个一个建表的, 只串行探测
+  auto *gather = dynamic_cast<GatherExecutor *>(left_executor_.get());
+  if (gather != nullptr && gather->NumPipelines() > 1 && !spilled_) {
+    if (!exchange_.IsStarted()) {
+      exchange_.Start(1, [this, gather](size_t /* worker */) { ProbeInParallel(gather); });
+    }
+    return exchange_.Pop(batch, &plan_->OutputSchema());
+  }
+
+  batch->Reset(&plan_->OutputSchema());
+  const auto &left_exprs = plan_->LeftJoinKeyExpressions();
+
+  // 一个左表 tuple 的匹配可能跨越多个输出 batch, 探测位置保存在 left_row_ 和 cur_row_ 里
+  while (!batch->IsFull()) {
+    if (is_begin_) {
+      if (left_row_ == left_batch_.NumRows()) {
+        left_row_ = 0;
+        if (!NextLeftBatch(&left_batch_)) {
+          break;
+        }
+        EvaluateKeys(left_batch_, left_exprs, &left_key_columns_);
+      }
+      std::tie(cur_table_, cur_row_) = FindMatch(left_key_columns_, left_row_, &left_key_);
+      if (cur_row_ == JoinHashTable::NO_ROW) {
+        if (plan_->join_type_ == JoinType::LEFT) {
+          OutputRow(left_batch_, left_row_, nullptr, JoinHashTable::NO_ROW, &output_values_, batch);  // left join
+        }
+        left_row_++;
+        continue;
+      }
+      is_begin_ = false;
+    }
+
+    OutputRow(left_batch_, left_row_, cur_table_, cur_row_, &output_values_, batch);
+    cur_row_ = cur_table_->NextRow(cur_row_);
+    if (cur_row_ == JoinHashTable::NO_ROW) {
+      is_begin_ = true;
+      left_row_++;
+    }
+  }
+  return !batch->IsEmpty();
+}
+
+void HashJoinExecutor::ProbeInParallel(GatherExecutor *gather) {
+  std::vector<ProbeState> states(gather->NumPipelines());
+  for (auto &state : states) {
+    state.output_.Reset(&plan_->OutputSchema());
+  }
+  // 探测本身不加锁: 建好的分区是只读的
+  auto ran = gather->RunPipelines(
+      [&](size_t worker, TupleBatch *left_batch) { return ProbeBatch(*left_batch, &states[worker]); });
+  if (!ran) {
+    // 左表只有一页, gather 在当前线程上扫描
+    TupleBatch left_batch;
+    while (gather->NextBatch(&left_batch)) {
+      if (!ProbeBatch(left_batch, &states[0])) {
+        return;
+      }
+    }
+  }
+  for (auto &state : states) {
+    if (!state.output_.IsEmpty() && !exchange_.Push(&state.output_)) {
+      return;
+    }
+  }
+}
+
+auto HashJoinExecutor::ProbeBatch(const TupleBatch &left_batch, ProbeState *state) -> bool {
+  // 输出批满了就交给父节点, 返回 false 表示 exchange 已经停了
+  auto flush_if_full = [&]() -> bool {
+    if (!state->output_.IsFull()) {
+      return true;
+    }
+    if (!exchange_.Push(&state->output_)) {
+      return false;
+    }
+    state->output_.Reset(&plan_->OutputSchema());
+    return true;
+  };
+
+  EvaluateKeys(left_batch, plan_->LeftJoinKeyExpressions(), &state->key_columns_);
+  for (size_t row = 0; row < left_batch.NumRows(); row++) {
+    auto [table, first] = FindMatch(state->key_columns_, row, &state->key_);
+    if (first == JoinHashTable::NO_ROW && plan_->join_type_ == JoinType::LEFT) {
+      OutputRow(left_batch, row, nullptr, JoinHashTable::NO_ROW, &state->values_, &state->output_);  // left join
+      if (!flush_if_full()) {
+        return false;
+      }
+    }
+    for (auto right_row = first; right_row != JoinHashTable::NO_ROW; right_row = table->NextRow(right_row)) {
+      OutputRow(left_batch, row, table, right_row, &state->values_, &state->output_);
+      if (!flush_if_full()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+auto HashJoinExecutor::OutputRow(const TupleBatch &left_batch, size_t left_row, const JoinHashTable *table,
+                                 uint64_t right_row, std::vector<Value> *values, TupleBatch *batch) const -> void {
+  values->clear();
+  for (uint32_t i = 0; i < left_batch.GetSchema()->GetColumnCount(); i++) {
+    values->push_back(left_batch.GetValue(left_row, i));
+  }
+  if (right_row == JoinHashTable::NO_ROW) {
+    const auto &right_table_schema = plan_->GetRightPlan()->OutputSchema();
+    for (uint32_t i = 0; i < right_table_schema.GetColumnCount(); ++i) {
+      values->push_back(ValueFactory::GetNullValueByType(right_table_schema.GetColumn(i).GetType()));
+    }
+  } else {
+    table->AppendRowValues(right_row, values);
+  }
+  batch->AppendRow(*values);
+}
+
+auto HashJoinExecutor::OutputTuple(const Schema &left_table_schema, const Schema &right_table_schema,
+                                   const JoinHashTable *table, uint64_t right_row, Tuple *tuple, bool matched)->void{
   std::vector<Value> values;
   values.reserve(GetOutputSchema().GetColumnCount());
   for(uint32_t i = 0; i < left_table_schema.GetColumnCount(); i++){
@@ -94,9 +455,7 @@ auto HashJoinExecutor::OutputTuple(const Schema &left_table_schema, const Schema
       values.emplace_back(ValueFactory::GetNullValueByType(type_id));
     }
   } else {
-    for (uint32_t i = 0; i < right_table_schema.GetColumnCount(); ++i) {
-      values.emplace_back(right_tuple->GetValue(&right_table_schema, i));
-    }
+    table->AppendRowValues(right_row, &values);
   }
   *tuple = {values, &plan_->OutputSchema()};
 }
@@ -9,8 +9,12 @@
 // Copyright (c) 2015-19, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <optional>
+#include <vector>
+
 #include "execution/executors/index_scan_executor.h"
 #include "type/value.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
@@ -18,29 +22,114 @@ IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanP
 
 void IndexScanExecutor::Init() {
     auto catalog = exec_ctx_->GetCatalog();
-    auto index_info = catalog->GetIndex(plan_->GetIndexOid());
-    table_info_ = catalog->GetTable(index_info->table_name_);
-    index_ = dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(index_info->index_.get());
-    it_ = index_->GetBeginIterator();
-    end_ = index_->GetEndIterator();
+    index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+    table_info_ = catalog->GetTable(index_info_->table_name_);
+    // 游标会一直持有叶子页的读锁, 重新 Init 时先放掉上一次扫描留下的锁
+    cursor_.reset();
+    tuple_cursor_.reset();
+    point_rids_.clear();
+    point_rid_idx_ = 0;
+
+    // 等值查找: 哈希索引没有顺序, 用完整的 key 一次拿到所有匹配的 RID
+    if (!plan_->point_key_.empty()) {
+        const auto &key_schema = index_info_->key_schema_;
+        std::vector<Value> values;
+        values.reserve(plan_->point_key_.size());
+        for (const auto &expr : plan_->point_key_) {
+            values.push_back(expr->Evaluate(nullptr, GetOutputSchema()));
+        }
+        index_info_->index_->ScanKey(Tuple(values, &key_schema), &point_rids_, exec_ctx_->GetTransaction());
+        return;
+    }
+
+    // 范围扫描: 只下降一次到边界所在的叶子, 越过另一个边界后游标即结束
+    std::optional<Tuple> lo;
+    std::optional<Tuple> hi;
+    if (plan_->lower_bound_ != nullptr) {
+        lo = MakeBoundKey(plan_->lower_bound_);
+    }
+    if (plan_->upper_bound_ != nullptr) {
+        hi = MakeBoundKey(plan_->upper_bound_);
+    }
+    const Tuple *lo_key = lo.has_value() ? &lo.value() : nullptr;
+    const Tuple *hi_key = hi.has_value() ? &hi.value() : nullptr;
+    // 聚簇表的主键索引里直接存着 tuple, 不需要再回表
+    if (table_info_->clustered_ == index_info_->index_.get()) {
+        tuple_cursor_ = table_info_->clustered_->ScanTuples(lo_key, plan_->lower_inclusive_, hi_key,
+                                                            plan_->upper_inclusive_, plan_->reverse_);
+        return;
+    }
+    // 覆盖索引: 条目里存着所有被索引的列, 直接用它们拼出输出 tuple, 同样不回表
+    if (plan_->index_only_) {
+        const auto &key_attrs = index_info_->index_->GetKeyAttrs();
+        entry_columns_.assign(GetOutputSchema().GetColumnCount(), std::nullopt);
+        for (uint32_t i = 0; i < key_attrs.size(); i++) {
+            entry_columns_[key_attrs[i]] = i;
+        }
+        tuple_cursor_ = index_info_->index_->ScanEntries(lo_key, plan_->lower_inclusive_, hi_key,
+                                                         plan_->upper_inclusive_, plan_->reverse_);
+        return;
+    }
+    cursor_ = index_info_->index_->Scan(lo_key, plan_->lower_inclusive_, hi_key, plan_->upper_inclusive_,
+                                        plan_->reverse_);
+}
+
+auto IndexScanExecutor::MakeBoundKey(const AbstractExpressionRef &bound) const -> Tuple {
+    const auto &key_schema = index_info_->key_schema_;
+    std::vector<Value> values;
+    values.reserve(key_schema.GetColumnCount());
+    values.push_back(bound->Evaluate(nullptr, GetOutputSchema()));
+    // 索引只比较边界的第一列, 其余的列填 null 占位
+    for (uint32_t i = 1; i < key_schema.GetColumnCount(); i++) {
+        values.push_back(ValueFactory::GetNullValueByType(key_schema.GetColumn(i).GetType()));
+    }
+    return {values, &key_schema};
 }
 
 auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-    while(true){
-        if(it_ == end_){
+    if (tuple_cursor_ != nullptr && plan_->index_only_) {
+        Tuple entry;
+        if (!tuple_cursor_->Next(&entry)) {
             return false;
         }
-
-        RID cur_rid = (*it_).second;
+        // 索引没有存的列上层不会读到, 填 null 即可
+        const auto &schema = GetOutputSchema();
+        std::vector<Value> values;
+        values.reserve(schema.GetColumnCount());
+        for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+            values.push_back(entry_columns_[i].has_value()
+                                 ? entry.GetValue(&index_info_->key_schema_, entry_columns_[i].value())
+                                 : ValueFactory::GetNullValueByType(schema.GetColumn(i).GetType()));
+        }
+        *tuple = Tuple(values, &schema);
+        *rid = RID();
+        return true;
+    }
+    if (tuple_cursor_ != nullptr) {
+        *rid = RID();
+        return tuple_cursor_->Next(tuple);
+    }
+    if (!plan_->point_key_.empty()) {
+        while (point_rid_idx_ < point_rids_.size()) {
+            auto [meta, cur_tuple] = table_info_->table_->GetTuple(point_rids_[point_rid_idx_++]);
+            if (!meta.is_deleted_) {
+                *rid = cur_tuple.GetRid();
+                *tuple = std::move(cur_tuple);
+                return true;
+            }
+        }
+        return false;
+    }
+    RID cur_rid;
+    while (cursor_->Next(&cur_rid)) {
         auto tuple_pair = table_info_->table_->GetTuple(cur_rid);
         if(!tuple_pair.first.is_deleted_){
             *rid = cur_rid;
             *tuple = tuple_pair.second;
-            ++it_;
             return true;
         }
-        ++it_;
     }
+    return false;
 }
 
 }  // namespace bustub
@@ -12,7 +12,10 @@
 
 #include <memory>
 #include <optional>
+#include <string>
 #include "common/config.h"
+#include "common/exception.h"
+#include "storage/index/generic_key.h"
 #include "storage/table/tuple.h"
 
 #include "execution/executors/insert_executor.h"
@@ -29,6 +32,9 @@ void InsertExecutor::Init() {
     index_info_ = catalog->GetTableIndexes(table_info_->name_);
     child_executor_->Init();
     has_finished_ = false;
+    index_keys_.assign(index_info_.size(), std::vector<Tuple>{});
+    index_rids_.clear();
+    pending_keys_.assign(index_info_.size(), std::unordered_set<std::string>{});
 }
   /**
    * Yield the number of rows inserted into the table.
@@ -45,22 +51,60 @@ auto InsertExecutor::Next(Tuple *tuple, RID *rid) -> bool {
     }
 
     int num_inserted = 0;
+    // 聚簇表的 tuple 存放在主键索引的叶子节点里.
+    // 子节点可能正扫描同一棵树并持有叶子页的读锁, 先把 tuple 都取出来
+    std::vector<Tuple> clustered_tuples;
     while(child_executor_->Next(tuple, rid)){
+        if(table_info_->clustered_ != nullptr){
+            clustered_tuples.push_back(*tuple);
+            continue;
+        }
+        // 索引放不下的 key 和唯一索引里重复的 key 都在写表之前就报错, 之前插入的行连同它们攒着的索引项都已写完
+        std::vector<Tuple> keys;
+        keys.reserve(index_info_.size());
+        for(size_t i = 0; i < index_info_.size(); ++i){
+            const auto &index_info = index_info_[i];
+            keys.push_back(
+                tuple->KeyFromTuple(table_info_->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs()));
+            if(!index_info->index_->KeyFits(keys.back())){
+                FlushIndexEntries();
+                throw Exception(ExceptionType::OUT_OF_RANGE,
+                                "varchar is too long for the key of index " + index_info->name_);
+            }
+            if(index_info->index_->GetMetadata()->IsUnique()){
+                // 还攒在批里的 key 树里查不到, 另外记一份
+                std::vector<RID> found;
+                index_info->index_->ScanKey(keys.back(), &found, exec_ctx_->GetTransaction());
+                bool pending = !pending_keys_[i].insert(UniqueKeyBytes(*index_info->index_, keys.back())).second;
+                if(!found.empty() || pending){
+                    FlushIndexEntries();
+                    throw Exception(ExceptionType::EXECUTION, "duplicate key for unique index " + index_info->name_);
+                }
+            }
+        }
         TupleMeta tuple_meta = {INVALID_TXN_ID, INVALID_TXN_ID, false};
         std::optional<RID> opt = table_info_->table_->InsertTuple(tuple_meta, *tuple);
         if(!opt.has_value()){
-            return false;
+            FlushIndexEntries();
+            throw Exception(ExceptionType::EXECUTION, "table " + table_info_->name_ + " has no room for the tuple");
         }
         ++num_inserted;
         *rid = opt.value();
 
-        for(auto& index_info : index_info_){
-            auto key = tuple->KeyFromTuple(table_info_->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs());
-            if(!index_info->index_->InsertEntry(key, *rid, exec_ctx_->GetTransaction())){
-                return false;
-            }
+        // 索引项先攒成一批, 排好序后一起插入, 相邻的 key 可以复用同一个叶子节点
+        for(size_t i = 0; i < index_info_.size(); ++i){
+            index_keys_[i].push_back(std::move(keys[i]));
+        }
+        index_rids_.push_back(*rid);
+        if(index_rids_.size() >= static_cast<size_t>(INDEX_BATCH_SIZE)){
+            FlushIndexEntries();
         }
     }
+    FlushIndexEntries();
+    if(!clustered_tuples.empty()){
+        InsertClusteredTuples(clustered_tuples);
+        num_inserted = static_cast<int>(clustered_tuples.size());
+    }
     // 最后的 tuple 应该包含插入的 tuple 数量的信息
     std::vector<Value> values{{TypeId::INTEGER, num_inserted}};
     Tuple output_tuple(values, &GetOutputSchema());
@@ -70,4 +114,59 @@ auto InsertExecutor::Next(Tuple *tuple, RID *rid) -> bool {
     return true;
 }
 
+void InsertExecutor::FlushIndexEntries() {
+    std::string refused;
+    for(size_t i = 0; i < index_info_.size(); ++i){
+        auto *index = index_info_[i]->index_.get();
+        if(!index->InsertEntries(index_keys_[i], index_rids_, exec_ctx_->GetTransaction()) && refused.empty()){
+            refused = index_info_[i]->name_;
+        }
+        index_keys_[i].clear();
+        pending_keys_[i].clear();
+    }
+    index_rids_.clear();
+    // 重复的 key 已经在写表前查过, 走到这里说明索引本身出了问题
+    if(!refused.empty()){
+        throw Exception(ExceptionType::EXECUTION, "index " + refused + " refused an entry");
+    }
+}
+
+void InsertExecutor::InsertClusteredTuples(const std::vector<Tuple> &tuples) {
+    auto *index = table_info_->clustered_;
+    std::vector<Tuple> keys;
+    keys.reserve(tuples.size());
+    std::unordered_set<std::string> seen;
+    // 先把所有主键查一遍, 有一个放不下或重复就整条语句都不插入
+    for(const auto &tuple : tuples){
+        keys.push_back(tuple.KeyFromTuple(table_info_->schema_, *index->GetKeySchema(), index->GetKeyAttrs()));
+        if(!index->KeyFits(keys.back())){
+            throw Exception(ExceptionType::OUT_OF_RANGE, "varchar is too long for the primary key");
+        }
+        Tuple existing;
+        if(index->GetTuple(keys.back(), &existing, exec_ctx_->GetTransaction()) ||
+           !seen.insert(UniqueKeyBytes(*index, keys.back())).second){
+            throw Exception(ExceptionType::EXECUTION, "duplicate primary key for table " + table_info_->name_);
+        }
+    }
+    for(size_t i = 0; i < tuples.size(); ++i){
+        if(!index->InsertTuple(keys[i], tuples[i], exec_ctx_->GetTransaction())){
+            throw Exception(ExceptionType::EXECUTION, "clustered index of table " + table_info_->name_ +
+                                                      " refused a tuple");
+        }
+    }
+}
+
+auto InsertExecutor::UniqueKeyBytes(const Index &index, const Tuple &key) -> std::string {
+    const auto *metadata = index.GetMetadata();
+    const Schema &key_schema = *metadata->GetKeySchema();
+    std::string bytes;
+    for(uint32_t i = 0; i < metadata->GetKeyColumnCount(); ++i){
+        const Column &column = key_schema.GetColumn(i);
+        size_t offset = bytes.size();
+        bytes.resize(offset + NormalizedColumnSize(column));
+        NormalizeValue(key.GetValue(&key_schema, i), column, bytes.data() + offset);
+    }
+    return bytes;
+}
+
 }  // namespace bustub
@@ -0,0 +1,205 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_hash_table.cpp
+//
+// Identification: src/execution/join_hash_table.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/join_hash_table.h"
+
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+namespace {
+
+template <typename T>
+void AppendBytes(const T &value, std::vector<char> *key) {
+  const auto *bytes = reinterpret_cast<const char *>(&value);
+  key->insert(key->end(), bytes, bytes + sizeof(T));
+}
+
+/** Tags of the serialized numbers, an integer and a double may have the same bytes */
+constexpr char INTEGER_TAG = 0;
+constexpr char DOUBLE_TAG = 1;
+
+void AppendInteger(int64_t value, std::vector<char> *key) {
+  key->push_back(INTEGER_TAG);
+  AppendBytes(value, key);
+}
+
+/** A decimal with an integral value is serialized like the integer, so INTEGER = DECIMAL keys can match */
+void AppendDecimal(double value, std::vector<char> *key) {
+  // 2^63, the first double above the int64 range
+  constexpr double INT64_END = 9223372036854775808.0;
+  if (std::trunc(value) == value && value >= -INT64_END && value < INT64_END) {
+    AppendInteger(static_cast<int64_t>(value), key);
+    return;
+  }
+  key->push_back(DOUBLE_TAG);
+  AppendBytes(value, key);
+}
+
+/** @return `size` rounded up to 8, rows and the tuples in them start 8-byte aligned */
+auto Align8(size_t size) -> size_t { return (size + 7) & ~static_cast<size_t>(7); }
+
+template <typename T>
+auto ReadAt(const std::vector<char> &arena, size_t offset) -> T {
+  T value;
+  memcpy(&value, arena.data() + offset, sizeof(T));
+  return value;
+}
+
+}  // namespace
+
+auto JoinHashTable::SerializeKey(const std::vector<std::vector<Value>> &key_columns, size_t row,
+                                 std::vector<char> *key) -> bool {
+  key->clear();
+  for (const auto &column : key_columns) {
+    const auto &value = column[row];
+    if (value.IsNull()) {
+      return false;
+    }
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        AppendInteger(value.GetAs<int8_t>(), key);
+        break;
+      case TypeId::SMALLINT:
+        AppendInteger(value.GetAs<int16_t>(), key);
+        break;
+      case TypeId::INTEGER:
+        AppendInteger(value.GetAs<int32_t>(), key);
+        break;
+      case TypeId::BIGINT:
+        AppendInteger(value.GetAs<int64_t>(), key);
+        break;
+      case TypeId::DECIMAL:
+        // -0.0 equals 0.0 but not byte for byte, both become the integer 0
+        AppendDecimal(value.GetAs<double>(), key);
+        break;
+      case TypeId::TIMESTAMP:
+        AppendBytes(value.GetAs<uint64_t>(), key);
+        break;
+      case TypeId::VARCHAR: {
+        // the length first, so the values of a key of several columns cannot run into each other
+        auto len = value.GetLength();
+        AppendBytes(len, key);
+        key->insert(key->end(), value.GetData(), value.GetData() + len);
+        break;
+      }
+      default:
+        UNREACHABLE("type cannot be a join key");
+    }
+  }
+  return true;
+}
+
+auto JoinHashTable::HashKey(const std::vector<char> &key) -> hash_t {
+  // HashBytes alone leaves the low bits poorly mixed, and the probe sequence starts at the low bits
+  uint64_t hash = HashUtil::HashBytes(key.data(), key.size());
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+void JoinHashTable::Reserve(size_t num_rows) {
+  // at most half of the entries are in use, so probe sequences stay short
+  size_t capacity = 16;
+  while (capacity < 2 * num_rows) {
+    capacity *= 2;
+  }
+  if (capacity > entries_.size()) {
+    auto old_entries = std::move(entries_);
+    entries_.assign(capacity, Entry{0, NO_ROW});
+    for (const auto &entry : old_entries) {
+      if (entry.row_ != NO_ROW) {
+        auto slot = entry.hash_ & (entries_.size() - 1);
+        while (entries_[slot].row_ != NO_ROW) {
+          slot = (slot + 1) & (entries_.size() - 1);
+        }
+        entries_[slot] = entry;
+      }
+    }
+  }
+}
+
+void JoinHashTable::Grow() { Reserve(entries_.size()); }
+
+void JoinHashTable::Insert(const std::vector<char> &key, hash_t hash, const TupleBatch &batch, size_t row) {
+  if (2 * (num_keys_ + 1) > entries_.size()) {
+    Grow();
+  }
+
+  // serialize the row to the end of the arena
+  uint64_t offset = arena_.size();
+  auto key_size = static_cast<uint32_t>(key.size());
+  auto tuple_offset = offset + Align8(SIZE_ROW_HEADER + key_size);
+  arena_.resize(Align8(tuple_offset + batch.GetTupleSize(row)));
+  memcpy(arena_.data() + offset + OFFSET_KEY_SIZE, &key_size, sizeof(uint32_t));
+  memcpy(arena_.data() + offset + SIZE_ROW_HEADER, key.data(), key_size);
+  batch.SerializeTuple(row, arena_.data() + tuple_offset);
+  num_rows_++;
+
+  auto slot = hash & (entries_.size() - 1);
+  while (entries_[slot].row_ != NO_ROW) {
+    if (entries_[slot].hash_ == hash && KeyEquals(entries_[slot].row_, key)) {
+      // push the row in front of the chain of its key
+      memcpy(arena_.data() + offset + OFFSET_NEXT, &entries_[slot].row_, sizeof(uint64_t));
+      entries_[slot].row_ = offset;
+      return;
+    }
+    slot = (slot + 1) & (entries_.size() - 1);
+  }
+  memcpy(arena_.data() + offset + OFFSET_NEXT, &NO_ROW, sizeof(uint64_t));
+  entries_[slot] = {hash, offset};
+  num_keys_++;
+}
+
+auto JoinHashTable::Find(const std::vector<char> &key, hash_t hash) const -> uint64_t {
+  if (entries_.empty()) {
+    return NO_ROW;
+  }
+  auto slot = hash & (entries_.size() - 1);
+  while (entries_[slot].row_ != NO_ROW) {
+    if (entries_[slot].hash_ == hash && KeyEquals(entries_[slot].row_, key)) {
+      return entries_[slot].row_;
+    }
+    slot = (slot + 1) & (entries_.size() - 1);
+  }
+  return NO_ROW;
+}
+
+auto JoinHashTable::NextRow(uint64_t row) const -> uint64_t { return ReadAt<uint64_t>(arena_, row + OFFSET_NEXT); }
+
+auto JoinHashTable::KeyEquals(uint64_t row, const std::vector<char> &key) const -> bool {
+  return ReadAt<uint32_t>(arena_, row + OFFSET_KEY_SIZE) == key.size() &&
+         memcmp(arena_.data() + row + SIZE_ROW_HEADER, key.data(), key.size()) == 0;
+}
+
+void JoinHashTable::AppendRowValues(uint64_t row, std::vector<Value> *values) const {
+  // the same layout as Tuple: an uninlined column holds the offset of its size+data
+  auto key_size = ReadAt<uint32_t>(arena_, row + OFFSET_KEY_SIZE);
+  const char *data = arena_.data() + row + Align8(SIZE_ROW_HEADER + key_size);
+  for (const auto &column : schema_->GetColumns()) {
+    const char *value_data = data + column.GetOffset();
+    if (!column.IsInlined()) {
+      uint32_t offset;
+      memcpy(&offset, value_data, sizeof(uint32_t));
+      value_data = data + offset;
+    }
+    values->push_back(Value::DeserializeFrom(value_data, column.GetType()));
+  }
+}
+
+}  // namespace bustub
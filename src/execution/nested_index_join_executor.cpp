@@ -11,20 +11,132 @@
 //===----------------------------------------------------------------------===//
 
 #include "execution/executors/nested_index_join_executor.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
                                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2023 Spring: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void NestIndexJoinExecutor::Init() { throw NotImplementedException("NestIndexJoinExecutor is not implemented"); }
+void NestIndexJoinExecutor::Init() {
+  auto catalog = exec_ctx_->GetCatalog();
+  index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+  inner_table_info_ = catalog->GetTable(plan_->GetInnerTableOid());
+  child_executor_->Init();
+  outer_tuples_.clear();
+  inner_rids_.clear();
+  inner_tuples_.clear();
+  outer_idx_ = 0;
+  inner_rid_idx_ = 0;
+  joined_ = false;
+}
+
+auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (true) {
+    if (outer_idx_ < outer_tuples_.size()) {
+      // 聚簇表的主键索引直接给出 tuple, 至多匹配一个
+      const auto &clustered_tuple = inner_tuples_[outer_idx_];
+      if (clustered_tuple.has_value() && !joined_) {
+        OutputTuple(&clustered_tuple.value(), tuple);
+        return true;
+      }
+
+      // 当前外表 tuple 在索引里的所有匹配项
+      const auto &inner_rids = inner_rids_[outer_idx_];
+      while (inner_rid_idx_ < inner_rids.size()) {
+        auto [meta, inner_tuple] = inner_table_info_->table_->GetTuple(inner_rids[inner_rid_idx_++]);
+        if (meta.is_deleted_) {
+          continue;
+        }
+        OutputTuple(&inner_tuple, tuple);
+        return true;
+      }
+
+      if (plan_->GetJoinType() == JoinType::LEFT && !joined_) {
+        OutputTuple(nullptr, tuple);
+        return true;
+      }
+
+      ++outer_idx_;
+      inner_rid_idx_ = 0;
+      joined_ = false;
+      continue;
+    }
 
-auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+    if (!FetchOuterBatch()) {
+      return false;
+    }
+  }
+}
+
+auto NestIndexJoinExecutor::FetchOuterBatch() -> bool {
+  outer_tuples_.clear();
+  outer_idx_ = 0;
+  inner_rid_idx_ = 0;
+  joined_ = false;
+
+  // 用一批外表 tuple 的 join key 一起探测内表的索引, 排好序的 key 可以复用同一个叶子节点
+  const auto &key_schema = index_info_->key_schema_;
+  std::vector<Tuple> keys;
+  std::vector<size_t> key_owners;
+  Tuple outer_tuple;
+  RID outer_rid;
+  while (outer_tuples_.size() < static_cast<size_t>(INDEX_BATCH_SIZE) &&
+         child_executor_->Next(&outer_tuple, &outer_rid)) {
+    auto key_value = plan_->KeyPredicate()->Evaluate(&outer_tuple, child_executor_->GetOutputSchema());
+    if (!key_value.IsNull()) {
+      if (key_value.GetTypeId() != key_schema.GetColumn(0).GetType()) {
+        key_value = key_value.CastAs(key_schema.GetColumn(0).GetType());
+      }
+      keys.emplace_back(std::vector<Value>{key_value}, &key_schema);
+      key_owners.push_back(outer_tuples_.size());
+    }
+    outer_tuples_.push_back(std::move(outer_tuple));
+  }
+
+  inner_rids_.assign(outer_tuples_.size(), std::vector<RID>{});
+  inner_tuples_.assign(outer_tuples_.size(), std::nullopt);
+  if (inner_table_info_->clustered_ != nullptr) {
+    Tuple inner_tuple;
+    for (size_t i = 0; i < key_owners.size(); i++) {
+      if (inner_table_info_->clustered_->GetTuple(keys[i], &inner_tuple, exec_ctx_->GetTransaction())) {
+        inner_tuples_[key_owners[i]] = std::move(inner_tuple);
+      }
+    }
+    return !outer_tuples_.empty();
+  }
+
+  std::vector<std::vector<RID>> probe_results;
+  index_info_->index_->ScanKeys(keys, &probe_results, exec_ctx_->GetTransaction());
+  for (size_t i = 0; i < key_owners.size(); i++) {
+    inner_rids_[key_owners[i]] = std::move(probe_results[i]);
+  }
+  return !outer_tuples_.empty();
+}
+
+void NestIndexJoinExecutor::OutputTuple(const Tuple *inner_tuple, Tuple *tuple) {
+  const auto &outer_schema = child_executor_->GetOutputSchema();
+  const auto &inner_schema = plan_->InnerTableSchema();
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema().GetColumnCount());
+  for (uint32_t i = 0; i < outer_schema.GetColumnCount(); i++) {
+    values.emplace_back(outer_tuples_[outer_idx_].GetValue(&outer_schema, i));
+  }
+  for (uint32_t i = 0; i < inner_schema.GetColumnCount(); i++) {
+    if (inner_tuple != nullptr) {
+      values.emplace_back(inner_tuple->GetValue(&inner_schema, i));
+    } else {
+      values.emplace_back(ValueFactory::GetNullValueByType(inner_schema.GetColumn(i).GetType()));
+    }
+  }
+  joined_ = true;
+  *tuple = Tuple(values, &GetOutputSchema());
+}
 
 }  // namespace bustub
@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel.cpp
+//
+// Identification: src/execution/parallel.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/parallel.h"
+
+#include <utility>
+
+namespace bustub {
+
+void RunWorkers(size_t num_workers, const std::function<void(size_t)> &work) {
+  std::mutex latch;
+  std::exception_ptr error;
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers);
+  for (size_t worker = 0; worker < num_workers; worker++) {
+    workers.emplace_back([&, worker] {
+      try {
+        work(worker);
+      } catch (...) {
+        std::scoped_lock lock(latch);
+        if (error == nullptr) {
+          error = std::current_exception();
+        }
+      }
+    });
+  }
+  for (auto &thread : workers) {
+    thread.join();
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+void BatchExchange::Start(size_t num_workers, std::function<void(size_t)> work) {
+  // Two batches per worker are enough to keep the workers busy while the parent consumes
+  max_queued_ = 2 * num_workers;
+  stopped_ = false;
+  num_running_ = num_workers;
+  for (size_t worker = 0; worker < num_workers; worker++) {
+    workers_.emplace_back([this, work, worker] {
+      try {
+        work(worker);
+      } catch (...) {
+        std::scoped_lock lock(latch_);
+        if (error_ == nullptr) {
+          error_ = std::current_exception();
+        }
+      }
+      std::scoped_lock lock(latch_);
+      num_running_--;
+      not_empty_.notify_one();
+    });
+  }
+}
+
+auto BatchExchange::Push(TupleBatch *batch) -> bool {
+  std::unique_lock lock(latch_);
+  not_full_.wait(lock, [&] { return stopped_ || batches_.size() < max_queued_; });
+  if (stopped_) {
+    return false;
+  }
+  batches_.push_back(std::move(*batch));
+  not_empty_.notify_one();
+  return true;
+}
+
+auto BatchExchange::Pop(TupleBatch *batch, const Schema *schema) -> bool {
+  std::unique_lock lock(latch_);
+  not_empty_.wait(lock, [&] { return error_ != nullptr || !batches_.empty() || num_running_ == 0; });
+  if (error_ != nullptr) {
+    std::rethrow_exception(error_);
+  }
+  if (batches_.empty()) {
+    batch->Reset(schema);
+    return false;
+  }
+  *batch = std::move(batches_.front());
+  batches_.pop_front();
+  lock.unlock();
+  not_full_.notify_one();
+  return true;
+}
+
+void BatchExchange::Stop() {
+  {
+    std::scoped_lock lock(latch_);
+    stopped_ = true;
+  }
+  not_full_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+  batches_.clear();
+  error_ = nullptr;
+}
+
+}  // namespace bustub
@@ -33,4 +33,20 @@ auto ProjectionExecutor::Next(Tuple *tuple, RID *rid) -> bool {
 
   return true;
 }
+
+auto ProjectionExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  if (!child_executor_->NextBatch(&child_batch_)) {
+    return false;
+  }
+
+  // Compute expressions, each one into a whole column of the output
+  std::vector<std::vector<Value>> columns(plan_->GetExpressions().size());
+  for (size_t i = 0; i < columns.size(); i++) {
+    plan_->GetExpressions()[i]->EvaluateBatch(child_batch_, &columns[i]);
+  }
+
+  batch->SetColumns(std::move(columns), child_batch_.NumRows());
+  return true;
+}
 }  // namespace bustub
@@ -12,12 +12,23 @@
 
 #include "execution/executors/seq_scan_executor.h"
 #include <cstddef>
+#include <memory>
+#include <utility>
+#include "storage/page/table_page.h"
 #include "storage/table/table_iterator.h"
 
 namespace bustub {
 
 SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx), plan_(plan), iter_(nullptr) {}
 
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan,
+                                 std::shared_ptr<MorselDispenser> dispenser)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      iter_(nullptr),
+      dispenser_(std::move(dispenser)),
+      shared_dispenser_(true) {}
+
 SeqScanExecutor::~SeqScanExecutor(){
     delete iter_;
     iter_ = nullptr;
@@ -27,6 +38,12 @@ void SeqScanExecutor::Init() {
     // std::cout << "SeqScanExecutor::Init()" << '\n';
     auto catalog = exec_ctx_->GetCatalog();
     auto table_info = catalog->GetTable(plan_->GetTableOid());
+    // 聚簇表没有堆表, 按主键顺序扫描叶子节点即可
+    if(table_info->clustered_ != nullptr){
+        tuple_cursor_.reset();
+        tuple_cursor_ = table_info->clustered_->ScanTuples(nullptr, true, nullptr, true, false);
+        return;
+    }
     // hash join 的时候, seqscan 作为 right_child 会被多次调用 Init()
     // 所以每次初始化都需要把之前的 TableIterator 内存释放掉
     if(iter_ != nullptr){
@@ -35,9 +52,22 @@ void SeqScanExecutor::Init() {
     } else {
         iter_ = new TableIterator(table_info->table_->MakeIterator());  
     }
+    // NextBatch 按 morsel 扫描; 共享的 dispenser 由并行扫描的发起者负责 Reset
+    if(dispenser_ == nullptr){
+        dispenser_ = std::make_shared<MorselDispenser>(exec_ctx_->GetBufferPoolManager(), table_info->table_.get());
+    } else if(!shared_dispenser_){
+        dispenser_->Reset();
+    }
+    morsel_.clear();
+    morsel_idx_ = 0;
+    slot_ = 0;
 }
 
 auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+    if(tuple_cursor_ != nullptr){
+        *rid = RID();
+        return tuple_cursor_->Next(tuple);
+    }
     while(true){
         if(iter_->IsEnd()){
             return false;
@@ -54,5 +84,44 @@ auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
     }
 }
 
+auto SeqScanExecutor::NextBatch(TupleBatch *batch) -> bool {
+    batch->Reset(&GetOutputSchema());
+    if(tuple_cursor_ != nullptr){
+        Tuple tuple;
+        while(!batch->IsFull() && tuple_cursor_->Next(&tuple)){
+            batch->AppendTuple(tuple, RID());
+        }
+        return !batch->IsEmpty();
+    }
+    // 一次取满一批: 按 morsel 逐页扫描, 每页只 fetch 一次, 每个 tuple 直接拆成列追加到 batch 里
+    auto bpm = exec_ctx_->GetBufferPoolManager();
+    while(!batch->IsFull()){
+        if(morsel_idx_ >= morsel_.size()){
+            if(!dispenser_->Next(&morsel_)){
+                break;
+            }
+            morsel_idx_ = 0;
+            slot_ = 0;
+        }
+        auto page_id = morsel_[morsel_idx_];
+        auto page_guard = bpm->FetchPageRead(page_id);
+        auto page = page_guard.As<TablePage>();
+        auto num_slots = dispenser_->GetNumSlots(page_id, page->GetNumTuples());
+        for(; slot_ < num_slots && !batch->IsFull(); slot_++){
+            RID rid{page_id, slot_};
+            auto [meta, tuple] = page->GetTuple(rid);
+            if(!meta.is_deleted_){
+                batch->AppendTuple(tuple, rid);
+            }
+        }
+        // 这一页扫完了才换下一页, 否则下次从 slot_ 接着扫
+        if(slot_ == num_slots){
+            morsel_idx_++;
+            slot_ = 0;
+        }
+    }
+    return !batch->IsEmpty();
+}
+
 }  // namespace bustub
 
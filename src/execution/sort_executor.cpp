@@ -1,56 +1,210 @@
 #include "execution/executors/sort_executor.h"
+#include <algorithm>
+#include <iterator>
 #include "common/rid.h"
+#include "execution/parallel.h"
+#include "execution/sort_key.h"
 
 namespace bustub {
 
 SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
-                           std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+                           std::unique_ptr<AbstractExecutor> &&child_executor, size_t parallelism)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)), parallelism_(parallelism) {}
 
 void SortExecutor::Init() {
   child_executor_->Init();
-  ordered_pairs_.clear();
+  batches_.clear();
+  run_size_ = 0;
+  entries_.clear();
+  runs_.clear();
+  merging_ = false;
+  merge_runs_.clear();
 
+  // 超过内存预算就把已经读进来的 batch 排好序写成一个 run
+  TupleBatch batch;
+  while (child_executor_->NextBatch(&batch)) {
+    for (size_t row = 0; row < batch.NumRows(); row++) {
+      run_size_ += batch.GetTupleSize(row);
+    }
+    batches_.push_back(std::move(batch));
+    if (run_size_ > exec_ctx_->GetMemoryBudget()) {
+      SpillRun();
+    }
+  }
+
+  if (runs_.empty()) {
+    SortInMemory();
+    cur_iterator_ = entries_.begin();
+    return;
+  }
+  if (!batches_.empty()) {
+    SpillRun();
+  }
+
+  // 归并时每个 run 占一页; run 太多时, 先把最前面的几个合成一个长 run
   Tuple tuple;
-  RID rid;
-  while (child_executor_->Next(&tuple, &rid)) {
-    ordered_pairs_.emplace_back(tuple, rid);
-  }
-
-  auto &order_bys = plan_->GetOrderBy();
-  auto &schema = plan_->OutputSchema();
-  auto sort_by = [&order_bys, &schema](std::pair<Tuple, RID> &t1, std::pair<Tuple, RID> &t2) -> bool {
-    for (const auto &order_by : order_bys) {
-      Value val1 = order_by.second->Evaluate(&t1.first, schema);
-      Value val2 = order_by.second->Evaluate(&t2.first, schema);
-      /*
-      std::cout << "order_by.second: " << order_by.second->ToString() << std::endl;
-      std::cout << "val1: " << val1.ToString() << std::endl;
-      std::cout << "val2: " << val2.ToString() << std::endl << std::endl;
-      */
-      if (val1.CompareEquals(val2) == CmpBool::CmpTrue) {  // continue if they equal in this val
-        continue;
-      }
+  auto fan_in = std::max<size_t>(2, exec_ctx_->GetMemoryBudget() / BUSTUB_PAGE_SIZE);
+  while (runs_.size() > fan_in) {
+    std::vector<std::unique_ptr<TmpTupleFile>> files;
+    for (size_t i = 0; i < fan_in; i++) {
+      files.push_back(std::move(runs_.front()));
+      runs_.pop_front();
+    }
+    StartMerge(std::move(files));
+    auto merged = std::make_unique<TmpTupleFile>(exec_ctx_->GetBufferPoolManager());
+    while (NextMerged(&tuple)) {
+      merged->Append(tuple);
+    }
+    merged->Finish();
+    runs_.push_back(std::move(merged));
+  }
+  StartMerge({std::make_move_iterator(runs_.begin()), std::make_move_iterator(runs_.end())});
+  runs_.clear();
+  merging_ = true;
+}
 
-      return order_by.first == OrderByType::DEFAULT || order_by.first == OrderByType::ASC
-                 ? val1.CompareLessThan(val2) == CmpBool::CmpTrue
-                 : val1.CompareGreaterThan(val2) == CmpBool::CmpTrue;
+void SortExecutor::SortInMemory() {
+  // 每个 worker 负责连续的几个 batch: 排序键按列一次算完, 排好序成为一个 run
+  auto num_workers = std::max<size_t>(1, std::min(parallelism_, batches_.size()));
+  std::vector<std::vector<SortEntry>> runs(num_workers);
+  auto sort_run = [&](size_t worker) {
+    auto &run = runs[worker];
+    std::vector<std::string> keys;
+    for (size_t i = worker * batches_.size() / num_workers; i < (worker + 1) * batches_.size() / num_workers; i++) {
+      SortKey::EncodeBatch(plan_->GetOrderBy(), batches_[i], &keys);
+      for (size_t row = 0; row < batches_[i].NumRows(); row++) {
+        run.push_back(SortEntry{std::move(keys[row]), batches_[i].GetTuple(row), batches_[i].GetRID(row)});
+      }
+      batches_[i] = TupleBatch{};
     }
-    return false;  // return false if they equal in every val (namely themself)
+    std::sort(run.begin(), run.end(), [](const SortEntry &e1, const SortEntry &e2) { return e1.key_ < e2.key_; });
   };
+  // 只有一个 worker 时在当前线程上排序, 不用起线程
+  if (num_workers == 1) {
+    sort_run(0);
+  } else {
+    RunWorkers(num_workers, sort_run);
+  }
+  batches_.clear();
+  run_size_ = 0;
+  if (num_workers == 1) {
+    entries_ = std::move(runs[0]);
+    return;
+  }
+  MergeInParallel(std::move(runs));
+}
 
-  std::sort(ordered_pairs_.begin(), ordered_pairs_.end(), sort_by);
-  cur_iterator_ = ordered_pairs_.begin();
+void SortExecutor::MergeInParallel(std::vector<std::vector<SortEntry>> &&runs) {
+  // 从每个 run 里等距取样, 样本排序后取分位点作为分界 key, 把 key 空间切成 worker 个区间
+  auto num_workers = runs.size();
+  auto samples_per_run = 16 * num_workers;
+  std::vector<std::string> samples;
+  for (const auto &run : runs) {
+    auto step = std::max<size_t>(1, run.size() / samples_per_run);
+    for (size_t i = 0; i < run.size(); i += step) {
+      samples.push_back(run[i].key_);
+    }
+  }
+  std::sort(samples.begin(), samples.end());
+
+  // bounds[r][p] 是第 r 个 run 里第 p 个区间的起点; 相同的 key 总是落在同一个区间
+  std::vector<std::vector<size_t>> bounds(runs.size(), std::vector<size_t>(num_workers + 1));
+  std::vector<size_t> output_begin(num_workers + 1, 0);
+  for (size_t r = 0; r < runs.size(); r++) {
+    bounds[r][num_workers] = runs[r].size();
+    for (size_t p = 1; p < num_workers; p++) {
+      const auto &splitter = samples[p * samples.size() / num_workers];
+      bounds[r][p] = std::lower_bound(runs[r].begin(), runs[r].end(), splitter,
+                                      [](const SortEntry &entry, const std::string &key) { return entry.key_ < key; }) -
+                     runs[r].begin();
+    }
+    for (size_t p = 1; p <= num_workers; p++) {
+      output_begin[p] += bounds[r][p];
+    }
+  }
+
+  // 每个 worker 用败者树把所有 run 在自己区间里的部分归并到输出里属于它的那一段
+  entries_.resize(output_begin[num_workers]);
+  RunWorkers(num_workers, [&](size_t worker) {
+    std::vector<size_t> next(runs.size());
+    LoserTree tree;
+    tree.Reset(runs.size());
+    for (size_t r = 0; r < runs.size(); r++) {
+      next[r] = bounds[r][worker];
+      if (next[r] == bounds[r][worker + 1]) {
+        tree.SetExhausted(r);
+      }
+    }
+    auto less = [&](size_t a, size_t b) { return runs[a][next[a]].key_ < runs[b][next[b]].key_; };
+    tree.Build(less);
+    for (auto out = output_begin[worker]; tree.Top() != runs.size(); out++) {
+      auto r = tree.Top();
+      entries_[out] = std::move(runs[r][next[r]++]);
+      tree.Update(next[r] == bounds[r][worker + 1], less);
+    }
+  });
+}
+
+void SortExecutor::SpillRun() {
+  SortInMemory();
+  auto run = std::make_unique<TmpTupleFile>(exec_ctx_->GetBufferPoolManager());
+  for (const auto &entry : entries_) {
+    run->Append(entry.tuple_);
+  }
+  run->Finish();
+  runs_.push_back(std::move(run));
+  entries_.clear();
+}
+
+void SortExecutor::StartMerge(std::vector<std::unique_ptr<TmpTupleFile>> &&files) {
+  merge_runs_.clear();
+  merge_runs_.resize(files.size());
+  loser_tree_.Reset(files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    merge_runs_[i].file_ = std::move(files[i]);
+    if (!Advance(&merge_runs_[i])) {
+      loser_tree_.SetExhausted(i);
+    }
+  }
+  loser_tree_.Build([this](size_t a, size_t b) { return HeadLess(a, b); });
+}
+
+auto SortExecutor::Advance(SortedRun *run) -> bool {
+  while (run->next_row_ >= run->page_.NumRows()) {
+    run->next_row_ = 0;
+    if (!run->file_->ReadBatch(&run->page_, &plan_->OutputSchema())) {
+      return false;
+    }
+    SortKey::EncodeBatch(plan_->GetOrderBy(), run->page_, &run->page_keys_);
+  }
+  run->head_key_ = std::move(run->page_keys_[run->next_row_]);
+  run->head_ = run->page_.GetTuple(run->next_row_++);
+  return true;
+}
+
+auto SortExecutor::NextMerged(Tuple *tuple) -> bool {
+  auto source = loser_tree_.Top();
+  if (source == merge_runs_.size()) {
+    return false;
+  }
+  *tuple = std::move(merge_runs_[source].head_);
+  auto exhausted = !Advance(&merge_runs_[source]);
+  loser_tree_.Update(exhausted, [this](size_t a, size_t b) { return HeadLess(a, b); });
+  return true;
 }
 
 auto SortExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-    if(cur_iterator_ == ordered_pairs_.end()){
+    if (merging_) {
+        *rid = RID{};
+        return NextMerged(tuple);
+    }
+    if(cur_iterator_ == entries_.end()){
         return false;
     }
     auto& res = *cur_iterator_;
     cur_iterator_++;
-    *tuple = res.first;
-    *rid = res.second;
+    *tuple = res.tuple_;
+    *rid = res.rid_;
     return true;
 }
 
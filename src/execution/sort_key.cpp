@@ -0,0 +1,122 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key.cpp
+//
+// Identification: src/execution/sort_key.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/sort_key.h"
+
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr char NULL_FLAG = 0x00;
+constexpr char NOT_NULL_FLAG = 0x01;
+
+/** Append `value` most significant byte first, so the byte order is the order of the unsigned integers */
+void AppendBigEndian(uint64_t value, std::string *key) {
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    key->push_back(static_cast<char>(value >> shift));
+  }
+}
+
+/** Flip the sign bit, so negative integers come before positive ones as unsigned integers */
+auto NormalizeInteger(int64_t value) -> uint64_t { return static_cast<uint64_t>(value) ^ (1ULL << 63); }
+
+/** Flip the sign bit of a positive double and every bit of a negative one, the bits then order like the doubles */
+auto NormalizeDouble(double value) -> uint64_t {
+  // -0.0 equals 0.0
+  if (value == 0) {
+    value = 0.0;
+  }
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return (bits & (1ULL << 63)) != 0 ? ~bits : bits ^ (1ULL << 63);
+}
+
+}  // namespace
+
+void SortKey::Encode(const std::vector<std::pair<OrderByType, AbstractExpressionRef>> &order_bys, const Tuple &tuple,
+                     const Schema &schema, std::string *key) {
+  key->clear();
+  for (const auto &[type, expr] : order_bys) {
+    AppendValue(expr->Evaluate(&tuple, schema), type == OrderByType::DESC, key);
+  }
+}
+
+void SortKey::EncodeBatch(const std::vector<std::pair<OrderByType, AbstractExpressionRef>> &order_bys,
+                          const TupleBatch &batch, std::vector<std::string> *keys) {
+  keys->resize(batch.NumRows());
+  for (auto &key : *keys) {
+    key.clear();
+  }
+  std::vector<Value> column;
+  for (const auto &[type, expr] : order_bys) {
+    expr->EvaluateBatch(batch, &column);
+    for (size_t row = 0; row < batch.NumRows(); row++) {
+      AppendValue(column[row], type == OrderByType::DESC, &(*keys)[row]);
+    }
+  }
+}
+
+void SortKey::AppendValue(const Value &value, bool descending, std::string *key) {
+  auto begin = key->size();
+  if (value.IsNull()) {
+    key->push_back(NULL_FLAG);
+  } else {
+    key->push_back(NOT_NULL_FLAG);
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+        key->push_back(static_cast<char>(value.GetAs<int8_t>()));
+        break;
+      case TypeId::TINYINT:
+        AppendBigEndian(NormalizeInteger(value.GetAs<int8_t>()), key);
+        break;
+      case TypeId::SMALLINT:
+        AppendBigEndian(NormalizeInteger(value.GetAs<int16_t>()), key);
+        break;
+      case TypeId::INTEGER:
+        AppendBigEndian(NormalizeInteger(value.GetAs<int32_t>()), key);
+        break;
+      case TypeId::BIGINT:
+        AppendBigEndian(NormalizeInteger(value.GetAs<int64_t>()), key);
+        break;
+      case TypeId::DECIMAL:
+        AppendBigEndian(NormalizeDouble(value.GetAs<double>()), key);
+        break;
+      case TypeId::TIMESTAMP:
+        AppendBigEndian(value.GetAs<uint64_t>(), key);
+        break;
+      case TypeId::VARCHAR: {
+        // the length of a varchar counts its trailing '\0'
+        const char *data = value.GetData();
+        for (uint32_t i = 0; i + 1 < value.GetLength(); i++) {
+          key->push_back(data[i]);
+          if (data[i] == 0x00) {
+            key->push_back(static_cast<char>(0xFF));
+          }
+        }
+        key->push_back(0x00);
+        key->push_back(0x00);
+        break;
+      }
+      default:
+        UNREACHABLE("type cannot be sorted");
+    }
+  }
+  if (descending) {
+    for (auto i = begin; i < key->size(); i++) {
+      (*key)[i] = static_cast<char>(~(*key)[i]);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -1,7 +1,10 @@
 #include "execution/executors/topn_executor.h"
+#include <algorithm>
 #include <cstddef>
 #include <queue>
+#include <string>
 #include <vector>
+#include "execution/sort_key.h"
 
 namespace bustub {
 
@@ -13,35 +16,21 @@ void TopNExecutor::Init() {
   count_ = 0;
   child_executor_->Init();
   vec_.clear();
-  // heap Init
-  auto &order_bys = plan_->GetOrderBy();
-  auto &schema = child_executor_->GetOutputSchema();
-  auto sort_by = [&order_bys, &schema](std::pair<Tuple, RID> &t1, std::pair<Tuple, RID> &t2) -> bool {
-    for (const auto &order_by : order_bys) {
-      Value val1 = order_by.second->Evaluate(&t1.first, schema);
-      Value val2 = order_by.second->Evaluate(&t2.first, schema);
-      /*
-      std::cout << "order_by.second: " << order_by.second->ToString() << std::endl;
-      std::cout << "val1: " << val1.ToString() << std::endl;
-      std::cout << "val2: " << val2.ToString() << std::endl << std::endl;
-      */
-      if (val1.CompareEquals(val2) == CmpBool::CmpTrue) {  // continue if they equal in this val
-        continue;
-      }
-
-      return order_by.first == OrderByType::DEFAULT || order_by.first == OrderByType::ASC
-                 ? val1.CompareLessThan(val2) == CmpBool::CmpTrue
-                 : val1.CompareGreaterThan(val2) == CmpBool::CmpTrue;
-    }
-    return false;  // return false if they equal in every val (namely themself)
-  };
-  std::priority_queue<std::pair<Tuple, RID>, std::vector<std::pair<Tuple, RID>>, decltype(sort_by)> heap(sort_by);
+  // heap Init, 堆顶是目前 N 个里最大的
+  auto cmp = [](const HeapEntry &e1, const HeapEntry &e2) -> bool { return e1.key_ < e2.key_; };
+  std::priority_queue<HeapEntry, std::vector<HeapEntry>, decltype(cmp)> heap(cmp);
   // next
   Tuple tuple;
   RID rid;
+  std::string key;
   size_t n = GetNumInHeap();
   while(child_executor_->Next(&tuple, &rid)){
-    heap.emplace(tuple, rid);
+    SortKey::Encode(plan_->GetOrderBy(), tuple, child_executor_->GetOutputSchema(), &key);
+    // 不比堆顶小的 tuple 进堆后也会马上被弹出
+    if(heap.size() >= n && (n == 0 || !(key < heap.top().key_))){
+        continue;
+    }
+    heap.push(HeapEntry{key, tuple, rid});
     if(heap.size() > n){
         heap.pop();
     }
@@ -49,10 +38,9 @@ void TopNExecutor::Init() {
   // std::cout << heap.size() << std::endl;
   // copy to my vec...
   while(!heap.empty()){
-    auto pair = heap.top();
+    const auto &entry = heap.top();
+    vec_.emplace_back(entry.tuple_, entry.rid_);
     heap.pop();
-    // std::cout << pair.first.ToString(&plan_->OutputSchema()) << " " << pair.second.ToString() << std::endl;
-    vec_.emplace_back(pair);
   }
   std::reverse(vec_.begin(), vec_.end());
 }
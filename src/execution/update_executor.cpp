@@ -12,6 +12,7 @@
 #include <memory>
 #include "catalog/catalog.h"
 #include "common/config.h"
+#include "common/exception.h"
 #include "concurrency/lock_manager.h"
 #include "type/type_id.h"
 #include "type/value.h"
@@ -38,12 +39,14 @@ auto UpdateExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   }
 
   int num_inserted = 0;
+  // 聚簇表的 tuple 存放在主键索引的叶子节点里.
+  // 子节点正扫描同一棵树并持有叶子页的读锁, 先把 tuple 都取出来
+  std::vector<Tuple> clustered_tuples;
   while (child_executor_->Next(tuple, rid)) {
-    // 先删除 
-    TupleMeta tuple_meta = {INVALID_TXN_ID, INVALID_TXN_ID, true};
-    table_info_->table_->UpdateTupleMeta(tuple_meta, *rid);
-
-    // 插入
+    if (table_info_->clustered_ != nullptr) {
+      clustered_tuples.push_back(*tuple);
+      continue;
+    }
     std::vector<Value> values;
     values.reserve(plan_->target_expressions_.size());
     for (const auto &expression : plan_->target_expressions_) {
@@ -51,6 +54,21 @@ auto UpdateExecutor::Next(Tuple *tuple, RID *rid) -> bool {
       // std::cout<<values.back().ToString() << " ";
     }
     Tuple new_tuple{values, &table_info_->schema_};
+    // 新的 key 放不进索引时, 在改动这一行之前就报错
+    std::vector<Tuple> new_keys;
+    new_keys.reserve(indexes_info_.size());
+    for (auto &index : indexes_info_) {
+      new_keys.push_back(new_tuple.KeyFromTuple(table_info_->schema_, index->key_schema_, index->index_->GetKeyAttrs()));
+      if (!index->index_->KeyFits(new_keys.back())) {
+        throw Exception(ExceptionType::OUT_OF_RANGE, "varchar is too long for the key of index " + index->name_);
+      }
+    }
+
+    // 先删除
+    TupleMeta tuple_meta = {INVALID_TXN_ID, INVALID_TXN_ID, true};
+    table_info_->table_->UpdateTupleMeta(tuple_meta, *rid);
+
+    // 插入
     tuple_meta.is_deleted_ = false;
     std::optional<RID> res = table_info_->table_->InsertTuple(tuple_meta, new_tuple, exec_ctx_->GetLockManager(), exec_ctx_->GetTransaction(), plan_->TableOid());
     if (!res.has_value()) {
@@ -59,17 +77,22 @@ auto UpdateExecutor::Next(Tuple *tuple, RID *rid) -> bool {
     num_inserted++;
 
     // 修改索引
-    for (auto &index : indexes_info_) {
+    for (size_t i = 0; i < indexes_info_.size(); i++) {
+      auto &index = indexes_info_[i];
       // 删除旧的索引
       Tuple removed_key = tuple->KeyFromTuple(table_info_->schema_, index->key_schema_, index->index_->GetKeyAttrs());
       index->index_->DeleteEntry(removed_key, *rid, exec_ctx_->GetTransaction());
       // 增加新索引
-      Tuple new_key = new_tuple.KeyFromTuple(table_info_->schema_, index->key_schema_, index->index_->GetKeyAttrs());
-      if(!index->index_->InsertEntry(new_key, res.value(), exec_ctx_->GetTransaction())){
+      if(!index->index_->InsertEntry(new_keys[i], res.value(), exec_ctx_->GetTransaction())){
         return false;
       }
     }
   }
+  if (!clustered_tuples.empty() && !UpdateClusteredTable(clustered_tuples)) {
+    return false;
+  }
+  num_inserted += static_cast<int>(clustered_tuples.size());
+
   std::vector<Value> value = {{TypeId::INTEGER, num_inserted}};
   Tuple res_tuple{value, &this->GetOutputSchema()};
   *tuple = res_tuple;
@@ -77,4 +100,36 @@ auto UpdateExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   return true;
 }
 
+auto UpdateExecutor::UpdateClusteredTable(const std::vector<Tuple> &old_tuples) -> bool {
+  auto *index = table_info_->clustered_;
+  auto *txn = exec_ctx_->GetTransaction();
+  std::vector<Tuple> new_tuples;
+  new_tuples.reserve(old_tuples.size());
+  // 先删掉所有旧的 tuple 再插入新的, 主键被修改时新旧主键才不会互相冲突
+  for (const auto &old_tuple : old_tuples) {
+    std::vector<Value> values;
+    values.reserve(plan_->target_expressions_.size());
+    for (const auto &expression : plan_->target_expressions_) {
+      values.push_back(expression->Evaluate(&old_tuple, table_info_->schema_));
+    }
+    new_tuples.emplace_back(values, &table_info_->schema_);
+    // 新主键放不进索引时, 在删掉任何旧的 tuple 之前就报错
+    if (!index->KeyFits(
+            new_tuples.back().KeyFromTuple(table_info_->schema_, *index->GetKeySchema(), index->GetKeyAttrs()))) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "varchar is too long for the primary key");
+    }
+  }
+  for (const auto &old_tuple : old_tuples) {
+    index->DeleteEntry(old_tuple.KeyFromTuple(table_info_->schema_, *index->GetKeySchema(), index->GetKeyAttrs()),
+                       RID(), txn);
+  }
+  for (const auto &new_tuple : new_tuples) {
+    Tuple key = new_tuple.KeyFromTuple(table_info_->schema_, *index->GetKeySchema(), index->GetKeyAttrs());
+    if (!index->InsertTuple(key, new_tuple, txn)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace bustub
@@ -21,10 +21,12 @@ namespace bustub {
 
 class CreateStatement : public BoundStatement {
  public:
-  explicit CreateStatement(std::string table, std::vector<Column> columns);
+  explicit CreateStatement(std::string table, std::vector<Column> columns, std::vector<std::string> primary_key = {});
 
   std::string table_;
   std::vector<Column> columns_;
+  /** The primary key columns, a table with a primary key is stored in a clustered index */
+  std::vector<std::string> primary_key_;
 
   auto ToString() const -> std::string override;
 };
@@ -14,6 +14,7 @@
 #include "binder/bound_statement.h"
 #include "binder/expressions/bound_column_ref.h"
 #include "binder/table_ref/bound_base_table_ref.h"
+#include "catalog/catalog.h"
 #include "catalog/column.h"
 
 namespace bustub {
@@ -21,7 +22,9 @@ namespace bustub {
 class IndexStatement : public BoundStatement {
  public:
   explicit IndexStatement(std::string index_name, std::unique_ptr<BoundBaseTableRef> table,
-                          std::vector<std::unique_ptr<BoundColumnRef>> cols);
+                          std::vector<std::unique_ptr<BoundColumnRef>> cols, bool unique = false,
+                          std::vector<std::unique_ptr<BoundColumnRef>> include_cols = {}, size_t bloom_filter_bits = 0,
+                          IndexType index_type = IndexType::BPlusTreeIndex, bool lazy_delete = false);
 
   /** Name of the index */
   std::string index_name_;
@@ -32,6 +35,21 @@ class IndexStatement : public BoundStatement {
   /** Name of the columns */
   std::vector<std::unique_ptr<BoundColumnRef>> cols_;
 
+  /** CREATE UNIQUE INDEX, a plain index accepts duplicate keys */
+  bool unique_;
+
+  /** INCLUDE columns, stored with the entries of a covering index but not part of the key */
+  std::vector<std::unique_ptr<BoundColumnRef>> include_cols_;
+
+  /** Size of the Bloom filter over the index keys, 0 if the index has none */
+  size_t bloom_filter_bits_;
+
+  /** CREATE INDEX ... USING HASH builds a hash index, any other access method a B+ tree */
+  IndexType index_type_;
+
+  /** `WITH (lazy_delete = true)`: deletes leave underfull pages to a background compaction */
+  bool lazy_delete_;
+
   auto ToString() const -> std::string override;
 };
 
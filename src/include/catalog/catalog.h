@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -21,6 +22,7 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/b_plus_tree_clustered_index.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
@@ -35,6 +37,9 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/** The access method of an index */
+enum class IndexType { BPlusTreeIndex, HashTableIndex };
+
 /**
  * The TableInfo class maintains metadata about a table.
  */
@@ -52,10 +57,12 @@ struct TableInfo {
   Schema schema_;
   /** The table name */
   const std::string name_;
-  /** An owning pointer to the table heap */
+  /** An owning pointer to the table heap, nullptr for an index-organized table */
   std::unique_ptr<TableHeap> table_;
   /** The table OID */
   const table_oid_t oid_;
+  /** The primary key index that stores the tuples of an index-organized table, nullptr for a heap table */
+  ClusteredIndex *clustered_{nullptr};
 };
 
 /**
@@ -70,15 +77,17 @@ struct IndexInfo {
    * @param index_oid The unique OID for the index
    * @param table_name The name of the table on which the index is created
    * @param key_size The size of the index key, in bytes
+   * @param index_type The access method of the index
    */
   IndexInfo(Schema key_schema, std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid,
-            std::string table_name, size_t key_size)
+            std::string table_name, size_t key_size, IndexType index_type = IndexType::BPlusTreeIndex)
       : key_schema_{std::move(key_schema)},
         name_{std::move(name)},
         index_{std::move(index)},
         index_oid_{index_oid},
         table_name_{std::move(table_name)},
-        key_size_{key_size} {}
+        key_size_{key_size},
+        index_type_{index_type} {}
   /** The schema for the index key */
   Schema key_schema_;
   /** The name of the index */
@@ -91,6 +100,8 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** The access method of the index, a hash index only answers equality lookups on its full key */
+  const IndexType index_type_;
 };
 
 /**
@@ -154,6 +165,39 @@ class Catalog {
     return tmp;
   }
 
+  /**
+   * Create a new index-organized table and return its metadata. The tuples of the table live in the leaf pages of a
+   * clustered B+ tree index on the primary key, which is registered as the index `<table_name>_pkey`, and there is
+   * no table heap.
+   * @param txn The transaction in which the table is being created
+   * @param table_name The name of the new table
+   * @param schema The schema of the new table
+   * @param key_attrs The primary key columns
+   * @param keysize Size of the key
+   * @return A (non-owning) pointer to the metadata for the table
+   */
+  template <class KeyType, class ValueType, class KeyComparator>
+  auto CreateClusteredTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                            const std::vector<uint32_t> &key_attrs, std::size_t keysize) -> TableInfo * {
+    auto *table_info = CreateTable(txn, table_name, schema, false);
+    if (table_info == NULL_TABLE_INFO) {
+      return NULL_TABLE_INFO;
+    }
+
+    auto index_name = table_name + "_pkey";
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &table_info->schema_, key_attrs, true);
+    auto key_schema = *meta->GetKeySchema();
+    auto index = std::make_unique<BPlusTreeClusteredIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    table_info->clustered_ = index.get();
+
+    const auto index_oid = next_index_oid_.fetch_add(1);
+    indexes_.emplace(index_oid, std::make_unique<IndexInfo>(std::move(key_schema), index_name, std::move(index),
+                                                            index_oid, table_name, keysize));
+    index_names_.find(table_name)->second.emplace(index_name, index_oid);
+
+    return table_info;
+  }
+
   /**
    * Query table metadata by name.
    * @param table_name The name of the table
@@ -196,12 +240,19 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param is_unique Whether the index rejects duplicate keys
+   * @param include_column_count The number of trailing key attributes that are INCLUDE columns of a covering index
+   * @param bloom_filter_bits The size of the Bloom filter over the index keys, 0 for none
+   * @param index_type The access method of the index
+   * @param lazy_delete Whether deletes from a B+ tree index leave underfull pages to a background compaction
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, bool is_unique = true, uint32_t include_column_count = 0,
+                   size_t bloom_filter_bits = 0, IndexType index_type = IndexType::BPlusTreeIndex,
+                   bool lazy_delete = false) -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -218,29 +269,43 @@ class Catalog {
     }
 
     // Construct index metdata
-    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, is_unique,
+                                                include_column_count, bloom_filter_bits, lazy_delete);
 
     // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-
-    // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    std::unique_ptr<Index> index;
+    if (index_type == IndexType::HashTableIndex) {
+      // The hash table maps keys to RIDs and is only instantiated for keys of up to 64 bytes
+      if constexpr (std::is_same_v<ValueType, RID> && sizeof(KeyType) <= 64) {
+        index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                              hash_function);
+      } else {
+        return NULL_INDEX_INFO;
+      }
+    } else {
+      index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    }
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap. The index is not registered yet, a row it refuses fails the
+    // creation without leaving a partial index behind
     auto *table_meta = GetTable(table_name);
     for (auto iter = table_meta->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
       auto [meta, tuple] = iter.GetTuple();
-      index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn);
+      if (meta.is_deleted_) {
+        continue;
+      }
+      if (!index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn)) {
+        throw Exception(ExceptionType::EXECUTION,
+                        "index " + index_name + " refused the row " + tuple.GetRid().ToString());
+      }
     }
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
 
     // Construct index information; IndexInfo takes ownership of the Index itself
-    auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto index_info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name,
+                                                  keysize, index_type);
     auto *tmp = index_info.get();
 
     // Update internal tracking
@@ -298,7 +363,7 @@ class Catalog {
    * @param index_oid The OID of the index for which to query
    * @return A (non-owning) pointer to the metadata for the index
    */
-  auto GetIndex(index_oid_t index_oid) -> IndexInfo * {
+  auto GetIndex(index_oid_t index_oid) const -> IndexInfo * {
     auto index = indexes_.find(index_oid);
     if (index == indexes_.end()) {
       return NULL_INDEX_INFO;
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -276,6 +277,23 @@ class BustubInstance {
     return variable == "1" || variable == "true" || variable == "yes";
   }
 
+  /** @return the session variable `key` as a non-negative number, `default_value` if it is unset or not a number */
+  auto GetNumericSessionVariable(const std::string &key, size_t default_value) -> size_t {
+    auto variable = GetSessionVariable(key);
+    if (variable.empty() || variable.size() > 12 || variable.find_first_not_of("0123456789") != std::string::npos) {
+      return default_value;
+    }
+    return std::stoull(variable);
+  }
+
+  /** @return the number of worker threads a query may use, set with `SET parallelism = n` */
+  auto GetParallelism() -> size_t { return std::clamp<size_t>(GetNumericSessionVariable("parallelism", 1), 1, 9999); }
+
+  /** @return the bytes an executor may hold in memory before it spills, set with `SET memory_budget = n` */
+  auto GetMemoryBudget() -> size_t {
+    return std::max<size_t>(1, GetNumericSessionVariable("memory_budget", DEFAULT_MEMORY_BUDGET));
+  }
+
  private:
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
@@ -284,6 +302,8 @@ class BustubInstance {
 
   void HandleCreateStatement(Transaction *txn, const CreateStatement &stmt, ResultWriter &writer);
   void HandleIndexStatement(Transaction *txn, const IndexStatement &stmt, ResultWriter &writer);
+  void HandleHashIndexStatement(Transaction *txn, const IndexStatement &stmt, const std::vector<uint32_t> &col_ids,
+                                ResultWriter &writer);
   void HandleExplainStatement(Transaction *txn, const ExplainStatement &stmt, ResultWriter &writer);
   void HandleVariableShowStatement(Transaction *txn, const VariableShowStatement &stmt, ResultWriter &writer);
   void HandleVariableSetStatement(Transaction *txn, const VariableSetStatement &stmt, ResultWriter &writer);
@@ -36,6 +36,11 @@ static constexpr int BUFFER_POOL_SIZE = 10;
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int INDEX_BATCH_SIZE = 1024;  // number of keys an executor buffers for one batched index operation
+static constexpr int TUPLE_BATCH_SIZE = 1024;  // max number of tuples an executor returns from one NextBatch() call
+static constexpr int MORSEL_SIZE = 16;         // number of table heap pages a parallel scan worker claims at once
+static constexpr int SPILL_FANOUT = 16;        // number of partitions an input that does not fit in memory is spilled to
+static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 << 20;  // bytes of tuples an executor may hold in memory
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
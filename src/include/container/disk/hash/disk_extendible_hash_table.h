@@ -146,6 +146,47 @@ class DiskExtendibleHashTable {
    */
   auto SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool;
 
+  /**
+   * Inserts a pair into the first page of a bucket's overflow chain that has room.
+   *
+   * @param bucket_page_id the page_id of the bucket
+   * @param key the key to insert
+   * @param value the value to insert
+   * @param extend whether to append an overflow page when every page of the chain is full
+   * @return whether or not the pair was inserted
+   */
+  auto ChainInsert(page_id_t bucket_page_id, const KeyType &key, const ValueType &value, bool extend) -> bool;
+
+  /**
+   * @return whether a key and value pair is in the overflow chain of a bucket
+   */
+  auto ChainContains(page_id_t bucket_page_id, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * @return whether no page of a bucket's overflow chain holds an entry
+   */
+  auto ChainIsEmpty(page_id_t bucket_page_id) -> bool;
+
+  /**
+   * Splitting a bucket only helps if the hash of some entry differs from the hash of the key to insert.
+   *
+   * @return whether a split could make room for the key
+   */
+  auto ChainCanSplit(page_id_t bucket_page_id, const KeyType &key) -> bool;
+
+  /**
+   * Takes every entry out of a bucket, deletes its overflow pages and leaves it an empty bucket page.
+   *
+   * @param bucket_page_id the page_id of the bucket
+   * @return the entries of the bucket
+   */
+  auto ChainDrain(page_id_t bucket_page_id) -> std::vector<MappingType>;
+
+  /**
+   * Deletes the overflow pages of a bucket and the bucket page itself.
+   */
+  void ChainDelete(page_id_t bucket_page_id);
+
   /**
    * Optionally merges an empty bucket into it's pair.  This is called by Remove,
    * if Remove makes a bucket empty.
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
 #include <vector>
@@ -24,12 +25,20 @@
 
 namespace bustub {
 
-#define HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator>
+#define LINEAR_PROBE_HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator>
 
 /**
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * The slots are spread over block pages listed in the header page. An entry lies at most one block's worth of slots
+ * past its home slot, so a probe touches at most two blocks; an insert that finds no free slot within that distance
+ * grows the table instead. The table also grows once three quarters of its slots are occupied, which keeps the runs a
+ * lookup scans short. Removed entries leave tombstones that count as occupied until a resize clears them.
+ *
+ * Probes latch one block page at a time. A resize rehashes into new pages while lookups keep reading the old ones,
+ * and only stalls them to swap in the new header page.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable {
@@ -85,21 +94,26 @@ class LinearProbeHashTable {
   auto GetSize() -> size_t;
 
  private:
-  auto GetHeaderPage() -> HashTableHeaderPage *;
-  auto GetBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE *;
-  void ResizeInsert(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value);
-  void DeleteBlockPages(HashTableHeaderPage *old_header_page);
+  auto Hash(const KeyType &key) -> size_t;
+  /** Insert into a table under construction, no other thread can see it yet. Returns false if the probe is too long */
+  auto ResizeInsert(const HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value) -> bool;
+  void DeleteBlockPages(const HashTableHeaderPage *old_header_page);
   void CreateNewBlockPages(HashTableHeaderPage *header_page, size_t num_blocks);
-  auto GetValueLatchFree(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
 
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // Readers are lookups, the writer is a resize swapping in its new header page
   ReaderWriterLatch table_latch_;
 
+  // Readers are inserts and removes, the writer is a resize copying the entries. Lookups never take it.
+  ReaderWriterLatch resize_latch_;
+
+  // Occupied slots, tombstones included. Only a resize, holding the resize latch exclusively, resets it.
+  std::atomic<size_t> num_occupied_{0};
+
   // Hash function
   HashFunction<KeyType> hash_fn_;
 };
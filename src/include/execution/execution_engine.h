@@ -94,11 +94,12 @@ class ExecutionEngine {
    */
   static void PollExecutor(AbstractExecutor *executor, const AbstractPlanNodeRef &plan,
                            std::vector<Tuple> *result_set) {
-    RID rid{};
-    Tuple tuple{};
-    while (executor->Next(&tuple, &rid)) {
+    TupleBatch batch;
+    while (executor->NextBatch(&batch)) {
       if (result_set != nullptr) {
-        result_set->push_back(tuple);
+        for (size_t row = 0; row < batch.NumRows(); row++) {
+          result_set->push_back(batch.GetTuple(row));
+        }
       }
     }
   }
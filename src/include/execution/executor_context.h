@@ -93,6 +93,16 @@ class ExecutorContext {
 
   auto IsDelete() const -> bool { return is_delete_; }
 
+  /** @return the number of worker threads a parallel executor may use, 1 runs every executor on the calling thread */
+  auto GetParallelism() const -> size_t { return parallelism_; }
+
+  void SetParallelism(size_t parallelism) { parallelism_ = parallelism; }
+
+  /** @return the bytes of tuples an executor may hold in memory, a larger input is spilled to temporary pages */
+  auto GetMemoryBudget() const -> size_t { return memory_budget_; }
+
+  void SetMemoryBudget(size_t memory_budget) { memory_budget_ = memory_budget; }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -109,6 +119,10 @@ class ExecutorContext {
   /** The set of check options associated with this executor context */
   std::shared_ptr<CheckOptions> check_options_;
   bool is_delete_;
+  /** The number of worker threads a parallel executor may use */
+  size_t parallelism_{1};
+  /** The bytes of tuples an executor may hold in memory */
+  size_t memory_budget_{DEFAULT_MEMORY_BUDGET};
 };
 
 }  // namespace bustub
@@ -13,9 +13,11 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/abstract_plan.h"
+#include "storage/table/morsel_dispenser.h"
 
 namespace bustub {
 /**
@@ -31,5 +33,40 @@ class ExecutorFactory {
    */
   static auto CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan)
       -> std::unique_ptr<AbstractExecutor>;
+
+  /**
+   * Render a plan the way CreateExecutor() runs it on `exec_ctx->GetParallelism()` workers: every pipeline that runs
+   * in parallel sits under a Gather node, and the operators that build, probe, aggregate or sort on several workers
+   * are marked. The inner side of a nested loop join is re-initialized for every outer tuple and always runs on the
+   * calling thread. The decisions taken while running, like a hash join that spills, are not shown.
+   * @param exec_ctx The executor context, its parallelism should be above 1
+   * @param plan The optimized plan
+   * @param with_schema Whether to print the output schema of every node
+   * @return The plan, one node per line
+   */
+  static auto ExplainParallelPlan(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan, bool with_schema)
+      -> std::string;
+
+ private:
+  /**
+   * Creates the executors of `plan` that may use `parallelism` workers. Subtrees that are re-initialized over and over,
+   * the inner side of a nested loop join, are created with a single worker.
+   */
+  static auto CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan, size_t parallelism)
+      -> std::unique_ptr<AbstractExecutor>;
+
+  /**
+   * @return whether `plan` is a pipeline that can run in parallel, a sequential scan of a table heap under filters and
+   * projections
+   */
+  static auto IsParallelPipeline(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan) -> bool;
+
+  /** @return a dispenser over the table scanned by `plan` if it is a pipeline that can run in parallel, else nullptr */
+  static auto MakeMorselDispenser(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan)
+      -> std::shared_ptr<MorselDispenser>;
+
+  /** Creates one worker's copy of a pipeline, whose scan claims its pages from `dispenser` */
+  static auto CreatePipeline(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan,
+                             const std::shared_ptr<MorselDispenser> &dispenser) -> std::unique_ptr<AbstractExecutor>;
 };
 }  // namespace bustub
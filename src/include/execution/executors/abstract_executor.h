@@ -14,6 +14,7 @@
 
 #include "execution/executor_context.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_batch.h"
 
 namespace bustub {
 class ExecutorContext;
@@ -47,6 +48,23 @@ class AbstractExecutor {
    */
   virtual auto Next(Tuple *tuple, RID *rid) -> bool = 0;
 
+  /**
+   * Yield the next batch of tuples from this executor. The default fills the batch from Next(); executors on the hot
+   * path of analytic queries override it to produce a whole batch at a time and to evaluate their expressions on whole
+   * columns. A parent drives a child either through Next() or through NextBatch(), never through both.
+   * @param[out] batch The batch to fill, always reset to the output schema of this executor, even when it is empty
+   * @return `true` if the batch holds at least one tuple, `false` if there are no more tuples
+   */
+  virtual auto NextBatch(TupleBatch *batch) -> bool {
+    batch->Reset(&GetOutputSchema());
+    Tuple tuple{};
+    RID rid{};
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+      batch->AppendTuple(tuple, rid);
+    }
+    return !batch->IsEmpty();
+  }
+
   /** @return The schema of the tuples that this executor produces */
   virtual auto GetOutputSchema() const -> const Schema & = 0;
 
@@ -21,8 +21,10 @@
 #include "container/hash/hash_function.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/executors/gather_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/aggregation_plan.h"
+#include "storage/table/tmp_tuple_file.h"
 #include "storage/table/tuple.h"
 #include "type/type_id.h"
 #include "type/value_factory.h"
@@ -73,37 +75,7 @@ class SimpleAggregationHashTable {
    */
   void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) {
     for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
-      Value& cur_aggregate_value = result->aggregates_[i];
-      const Value& new_aggregate_value = input.aggregates_[i];
-      // 边界情况
-      if (agg_types_[i] == AggregationType::CountStarAggregate){
-        cur_aggregate_value = cur_aggregate_value.Add({TypeId::INTEGER, 1});
-        continue;
-      }
-      if (new_aggregate_value.IsNull()){
-        continue;
-      }
-      if (cur_aggregate_value.IsNull()){
-        cur_aggregate_value = (agg_types_[i] == AggregationType::CountAggregate) ? Value{TypeId::INTEGER, 1} : new_aggregate_value;
-        continue;
-      }
-
-      switch (agg_types_[i]) {
-        case AggregationType::CountStarAggregate:
-          break;
-        case AggregationType::CountAggregate:
-          cur_aggregate_value = cur_aggregate_value.Add({TypeId::INTEGER, 1});
-          break;
-        case AggregationType::SumAggregate:
-          cur_aggregate_value = cur_aggregate_value.Add(new_aggregate_value);
-          break;
-        case AggregationType::MinAggregate:
-          cur_aggregate_value = cur_aggregate_value.Min(new_aggregate_value);
-          break;
-        case AggregationType::MaxAggregate:
-          cur_aggregate_value = cur_aggregate_value.Max(new_aggregate_value);
-          break;
-      }
+      CombineAggregateValue(&result->aggregates_[i], input.aggregates_[i], agg_types_[i]);
     }
   }
 
@@ -113,12 +85,66 @@ class SimpleAggregationHashTable {
    * @param agg_val the value to be inserted
    */
   void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht_.count(agg_key) == 0) {
-      ht_.insert({agg_key, GenerateInitialAggregateValue()});
+    auto iter = ht_.find(agg_key);
+    if (iter == ht_.end()) {
+      iter = ht_.insert({agg_key, GenerateInitialAggregateValue()}).first;
+    }
+    CombineAggregateValues(&iter->second, agg_val);
+  }
+
+  /**
+   * Inserts one row of a batch into the hash table and then combines it with the current aggregation.
+   * @param agg_key the key to be inserted
+   * @param aggregate_columns the values of every aggregate expression for the whole batch
+   * @param row the row of the batch to combine
+   */
+  void InsertCombine(const AggregateKey &agg_key, const std::vector<std::vector<Value>> &aggregate_columns,
+                     size_t row) {
+    auto iter = ht_.find(agg_key);
+    if (iter == ht_.end()) {
+      iter = ht_.insert({agg_key, GenerateInitialAggregateValue()}).first;
+    }
+    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+      CombineAggregateValue(&iter->second.aggregates_[i], aggregate_columns[i][row], agg_types_[i]);
+    }
+  }
+
+  /**
+   * Combines one row of a batch with the current aggregation of its group, if the group is in the hash table.
+   * @return `false` if the group is not in the hash table, nothing is combined
+   */
+  auto CombineExisting(const AggregateKey &agg_key, const std::vector<std::vector<Value>> &aggregate_columns,
+                       size_t row) -> bool {
+    auto iter = ht_.find(agg_key);
+    if (iter == ht_.end()) {
+      return false;
+    }
+    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+      CombineAggregateValue(&iter->second.aggregates_[i], aggregate_columns[i][row], agg_types_[i]);
+    }
+    return true;
+  }
+
+  /**
+   * Inserts a group with a partial aggregation, aggregated over a part of its rows, and then merges it with the
+   * current aggregation. COUNT and COUNT(*) add up the partial counts instead of counting them.
+   * @param agg_key the key to be inserted
+   * @param partial the partial aggregation of the group
+   */
+  void InsertMerge(const AggregateKey &agg_key, const AggregateValue &partial) {
+    auto iter = ht_.find(agg_key);
+    if (iter == ht_.end()) {
+      ht_.insert({agg_key, partial});
+      return;
+    }
+    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+      MergeAggregateValue(&iter->second.aggregates_[i], partial.aggregates_[i], agg_types_[i]);
     }
-    CombineAggregateValues(&ht_[agg_key], agg_val);
   }
 
+  /** @return The number of groups in the hash table */
+  auto Size() const -> size_t { return ht_.size(); }
+
   /**
    * Clear the hash table
    */
@@ -160,6 +186,65 @@ class SimpleAggregationHashTable {
   auto End() -> Iterator { return Iterator{ht_.cend()}; }
 
  private:
+  /** Combines one input value into the value of one aggregate */
+  static void CombineAggregateValue(Value *cur_aggregate_value, const Value &new_aggregate_value,
+                                    AggregationType agg_type) {
+    // 边界情况
+    if (agg_type == AggregationType::CountStarAggregate){
+      *cur_aggregate_value = cur_aggregate_value->Add({TypeId::INTEGER, 1});
+      return;
+    }
+    if (new_aggregate_value.IsNull()){
+      return;
+    }
+    if (cur_aggregate_value->IsNull()){
+      *cur_aggregate_value =
+          (agg_type == AggregationType::CountAggregate) ? Value{TypeId::INTEGER, 1} : new_aggregate_value;
+      return;
+    }
+
+    switch (agg_type) {
+      case AggregationType::CountStarAggregate:
+        break;
+      case AggregationType::CountAggregate:
+        *cur_aggregate_value = cur_aggregate_value->Add({TypeId::INTEGER, 1});
+        break;
+      case AggregationType::SumAggregate:
+        *cur_aggregate_value = cur_aggregate_value->Add(new_aggregate_value);
+        break;
+      case AggregationType::MinAggregate:
+        *cur_aggregate_value = cur_aggregate_value->Min(new_aggregate_value);
+        break;
+      case AggregationType::MaxAggregate:
+        *cur_aggregate_value = cur_aggregate_value->Max(new_aggregate_value);
+        break;
+    }
+  }
+
+  /** Merges the partial value of one aggregate into the value of the same aggregate */
+  static void MergeAggregateValue(Value *cur_aggregate_value, const Value &partial_value, AggregationType agg_type) {
+    if (partial_value.IsNull()) {
+      return;
+    }
+    if (cur_aggregate_value->IsNull()) {
+      *cur_aggregate_value = partial_value;
+      return;
+    }
+    switch (agg_type) {
+      case AggregationType::CountStarAggregate:
+      case AggregationType::CountAggregate:
+      case AggregationType::SumAggregate:
+        *cur_aggregate_value = cur_aggregate_value->Add(partial_value);
+        break;
+      case AggregationType::MinAggregate:
+        *cur_aggregate_value = cur_aggregate_value->Min(partial_value);
+        break;
+      case AggregationType::MaxAggregate:
+        *cur_aggregate_value = cur_aggregate_value->Max(partial_value);
+        break;
+    }
+  }
+
   /** The hash table is just a map from aggregate keys to aggregate values */
   std::unordered_map<AggregateKey, AggregateValue> ht_{};
   /** The aggregate expressions that we have */
@@ -171,6 +256,17 @@ class SimpleAggregationHashTable {
 /**
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX)
  * over the tuples produced by a child executor.
+ *
+ * Once the groups in the hash table take more bytes than the memory budget, the rows of groups already in the table
+ * are still combined in memory, while the rows of every new group are partitioned on the hash of the group into
+ * temporary files. The groups in memory are complete and are output first, then every partition is aggregated on its
+ * own. A partition whose groups still do not fit is partitioned again with another hash, up to MAX_SPILL_LEVEL times.
+ *
+ * Over a parallel scan, every worker pre-aggregates the batches of its own pipeline into tables of its own, one per
+ * radix partition of the group hash. Each worker then merges one set of partitions of every worker into the final
+ * table of those partitions, so no table is shared between workers. If the groups exceed the memory budget while the
+ * workers pre-aggregate, they stop, and the rest of the input is aggregated serially into the merged tables, spilling
+ * as above.
  */
 class AggregationExecutor : public AbstractExecutor {
  public:
@@ -194,6 +290,13 @@ class AggregationExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the aggregation.
+   * @param[out] batch The next batch produced by the aggregation
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the aggregation */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
@@ -201,22 +304,69 @@ class AggregationExecutor : public AbstractExecutor {
   auto GetChildExecutor() const -> const AbstractExecutor *;
 
  private:
-  /** @return The tuple as an AggregateKey */
-  auto MakeAggregateKey(const Tuple *tuple) -> AggregateKey {
+  /** A partition of the input rows spilled to a temporary file */
+  struct SpilledPartition {
+    std::unique_ptr<TmpTupleFile> file_;
+    /** The number of times the rows have been partitioned before, 0 for the first split of the input */
+    size_t level_{0};
+  };
+
+  /** @return the hash of a group mixed with `seed`, the bits of std::hash<AggregateKey> alone are poorly mixed */
+  static auto MixHash(hash_t group_hash, uint64_t seed) -> uint64_t;
+
+  /** @return the partition of a group on `level`, each level hashes with another seed */
+  static auto PartitionOf(hash_t group_hash, size_t level) -> size_t;
+
+  /** @return the table of a group among `num_tables` tables partitioned on the group hash */
+  static auto TableOf(hash_t group_hash, size_t num_tables) -> size_t;
+
+  /** Replace the hash table by `num_tables` empty tables partitioned on the group hash */
+  void ResetTables(size_t num_tables);
+
+  /** Evaluate the group bys and the aggregates on the whole batch */
+  void EvaluateColumns(const TupleBatch &batch, std::vector<std::vector<Value>> *group_by_columns,
+                       std::vector<std::vector<Value>> *aggregate_columns) const;
+
+  /**
+   * Pre-aggregate the pipelines of a parallel scan on their workers and merge the partial aggregations into
+   * partitioned tables. Stops early once the groups exceed the memory budget.
+   */
+  void AggregateInParallel(GatherExecutor *gather);
+
+  /** @return an estimate of the bytes a group takes in the hash table */
+  auto GroupSize(const AggregateKey &agg_key) const -> size_t;
+
+  /**
+   * Combine the rows of a batch into the hash table. Once `spill_files` is set up, the rows of groups that are not in
+   * the table go to the partition of their group instead, partitioned on `spill_level`.
+   */
+  void AggregateBatch(const TupleBatch &batch, size_t spill_level,
+                      std::vector<std::unique_ptr<TmpTupleFile>> *spill_files);
+
+  /** Queue the non-empty files partitioned on `level` to be aggregated */
+  void AddSpilledPartitions(std::vector<std::unique_ptr<TmpTupleFile>> &&files, size_t level);
+
+  /** Aggregate the next spilled partition into the emptied hash table. @return false if there is none */
+  auto NextPartition() -> bool;
+
+  /** Move aht_iterator_ to the next group to output, going through the tables and the spilled partitions */
+  auto SeekGroup() -> bool;
+
+  /** @return The row of a batch as an AggregateKey, given the values of the group bys for the whole batch */
+  auto MakeAggregateKey(const std::vector<std::vector<Value>> &group_by_columns, size_t row) -> AggregateKey {
     std::vector<Value> keys;
-    for (const auto &expr : plan_->GetGroupBys()) {
-      keys.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
+    keys.reserve(group_by_columns.size());
+    for (const auto &column : group_by_columns) {
+      keys.emplace_back(column[row]);
     }
     return {keys};
   }
 
-  /** @return The tuple as an AggregateValue */
-  auto MakeAggregateValue(const Tuple *tuple) -> AggregateValue {
-    std::vector<Value> vals;
-    for (const auto &expr : plan_->GetAggregates()) {
-      vals.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
-    }
-    return {vals};
+  /** @return The current entry of the aggregation hash table as an output row */
+  auto MakeOutputValues() -> std::vector<Value> {
+    std::vector<Value> values = aht_iterator_.Key().group_bys_;
+    values.insert(values.end(), aht_iterator_.Val().aggregates_.begin(), aht_iterator_.Val().aggregates_.end());
+    return values;
   }
 
  private:
@@ -224,10 +374,19 @@ class AggregationExecutor : public AbstractExecutor {
   const AggregationPlanNode *plan_;
   /** The child executor that produces tuples over which the aggregation is computed */
   std::unique_ptr<AbstractExecutor> child_;
-  /** Simple aggregation hash table */
-  SimpleAggregationHashTable aht_;
+  /** Simple aggregation hash table, partitioned on the group hash after a parallel aggregation */
+  std::vector<SimpleAggregationHashTable> tables_;
+  /** The table aht_iterator_ is in */
+  size_t table_idx_{0};
   /** Simple aggregation hash table iterator */
   SimpleAggregationHashTable::Iterator aht_iterator_;
   int num_of_tuples_;
+
+  /** The estimated bytes of the groups in the hash table */
+  size_t table_size_{0};
+  /** The partitions still to be aggregated */
+  std::vector<SpilledPartition> pending_partitions_;
+  /** The number of times a partition is split again before it is aggregated however many groups it has */
+  static constexpr size_t MAX_SPILL_LEVEL = 3;
 };
 }  // namespace bustub
@@ -48,6 +48,13 @@ class FilterExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the filter.
+   * @param[out] batch The next batch produced by the filter
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the filter plan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// gather_executor.h
+//
+// Identification: src/include/execution/executors/gather_executor.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/parallel.h"
+#include "execution/plans/abstract_plan.h"
+#include "storage/table/morsel_dispenser.h"
+#include "storage/table/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * GatherExecutor runs copies of a pipeline, a sequential scan under filters and projections, on worker threads and
+ * gathers the batches they produce. The scans of all copies claim their pages from one MorselDispenser, so every page
+ * is scanned by exactly one worker. The rows come out in no particular order.
+ */
+class GatherExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new GatherExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The plan of the pipeline, the root of every copy
+   * @param dispenser The dispenser shared by the scans of the copies
+   * @param pipelines One copy of the pipeline per worker
+   */
+  GatherExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan, std::shared_ptr<MorselDispenser> dispenser,
+                 std::vector<std::unique_ptr<AbstractExecutor>> &&pipelines);
+
+  ~GatherExecutor() override;
+
+  /** Initialize the pipelines, the workers start on the first call to Next or NextBatch */
+  void Init() override;
+
+  /**
+   * Yield the next tuple produced by any of the workers.
+   * @param[out] tuple The next tuple
+   * @param[out] rid The RID of the next tuple
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /**
+   * Yield the next batch produced by any of the workers.
+   * @param[out] batch The next batch
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  /**
+   * Run every pipeline on its own worker and hand each batch it produces to `consume(worker, batch)` on that worker,
+   * for a parent that consumes the batches in parallel. A worker stops once `consume` returns false; NextBatch() then
+   * yields the rows the pipelines have not produced yet.
+   * @return false if the scan is not split among workers, nothing was consumed
+   */
+  auto RunPipelines(const std::function<bool(size_t, TupleBatch *)> &consume) -> bool;
+
+  /** @return The number of pipelines, one per worker */
+  auto NumPipelines() const -> size_t { return pipelines_.size(); }
+
+  /** @return The output schema of the pipeline */
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
+
+ private:
+  const AbstractPlanNode *plan_;
+  std::shared_ptr<MorselDispenser> dispenser_;
+  std::vector<std::unique_ptr<AbstractExecutor>> pipelines_;
+  /** A table of a single page is scanned by the first pipeline on the calling thread */
+  bool run_inline_{false};
+  /** Runs one pipeline per worker and collects their batches */
+  BatchExchange exchange_;
+
+  /** The batch Next() hands out row by row */
+  TupleBatch current_batch_;
+  size_t current_row_{0};
+};
+
+}  // namespace bustub
@@ -13,57 +13,37 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "common/util/hash_util.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/executors/gather_executor.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/join_hash_table.h"
+#include "execution/parallel.h"
 #include "execution/plans/hash_join_plan.h"
+#include "storage/table/tmp_tuple_file.h"
 #include "storage/table/tuple.h"
 #include "type/type.h"
 
 namespace bustub {
 
-/** My JoinKey*/
-struct JoinKey {
-  std::vector<Value> join_keys_;
-  /**
-   * Compares two join keys for equality.
-   * @param other the other join key to be compared with
-   * @return `true` if both join keys have equivalent expressions, `false` otherwise
-   */
-  auto operator==(const JoinKey &other) const -> bool {
-    for (uint32_t i = 0; i < other.join_keys_.size(); i++) {
-      if (join_keys_[i].CompareEquals(other.join_keys_[i]) != CmpBool::CmpTrue) {
-        return false;
-      }
-    }
-    return true;
-  }
-};
-}  // namespace bustub
-
-namespace std {
-/** My Implements std::hash on JoinKey */
-template <>
-struct hash<bustub::JoinKey> {
-  auto operator()(const bustub::JoinKey &join_key) const -> std::size_t {
-    size_t curr_hash = 0;
-    for (const auto &key : join_key.join_keys_) {
-      if (!key.IsNull()) {
-        curr_hash = bustub::HashUtil::CombineHashes(curr_hash, bustub::HashUtil::HashValue(&key));
-      }
-    }
-    return curr_hash;
-  }
-};
-}  // namespace std
-
-namespace bustub {
 /**
- * HashJoinExecutor executes a nested-loop JOIN on two tables.
+ * HashJoinExecutor executes a hash JOIN on two tables. The right side is built into a JoinHashTable, rows with a null
+ * join key never match.
+ *
+ * With a parallelism above 1, the build side is radix-partitioned on the hash of the join key by several workers and
+ * every partition is then built by a single worker, so no table is latched. When the left side is a parallel scan
+ * (a GatherExecutor), NextBatch() probes on its workers, each joining the batches of its own pipeline, and the output
+ * rows come in no particular order. Any other left side is pulled and probed on the calling thread only: an index scan
+ * keeps a page latched between calls, which must not be released by another thread.
+ *
+ * When the right side takes more bytes than the memory budget, the join turns into a grace hash join: both sides are
+ * partitioned on the hash of the join key into temporary files, and the partitions are joined one pair at a time. A
+ * right partition that is still too large is partitioned again with another hash, up to MAX_SPILL_LEVEL times. The
+ * partitions are probed serially.
  */
 class HashJoinExecutor : public AbstractExecutor {
  public:
@@ -73,9 +53,11 @@ class HashJoinExecutor : public AbstractExecutor {
    * @param plan The HashJoin join plan to be executed
    * @param left_child The child executor that produces tuples for the left side of join
    * @param right_child The child executor that produces tuples for the right side of join
+   * @param parallelism The number of workers that may build the hash table
    */
   HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
-                   std::unique_ptr<AbstractExecutor> &&left_child, std::unique_ptr<AbstractExecutor> &&right_child);
+                   std::unique_ptr<AbstractExecutor> &&left_child, std::unique_ptr<AbstractExecutor> &&right_child,
+                   size_t parallelism);
 
   /** Initialize the join */
   void Init() override;
@@ -88,40 +70,135 @@ class HashJoinExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the join.
+   * @param[out] batch The next batch produced by the join
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the join */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
  private:
-  /** MyADD: @return The tuple as an JoinKey */
-  auto MakeJoinKey(const Tuple &tuple, const std::vector<AbstractExpressionRef> &exprs,
-                        const AbstractPlanNodeRef &plan) -> JoinKey {
-    std::vector<Value> keys;
-    keys.reserve(exprs.size());
-    for (const auto &expr : exprs) {
-      keys.emplace_back(expr->Evaluate(&tuple, plan->OutputSchema()));
-    }
-    return {keys};
+  /** Evaluate the join key expressions `exprs` for every row of `batch`, one vector per expression */
+  static void EvaluateKeys(const TupleBatch &batch, const std::vector<AbstractExpressionRef> &exprs,
+                           std::vector<std::vector<Value>> *key_columns);
+
+  /** @return the partition of the build side holding the right rows whose join key has the hash `hash` */
+  auto FindPartition(hash_t hash) const -> const JoinHashTable & {
+    // the high bits, the table of the partition probes from the low bits
+    return partitions_[(hash >> 32) % partitions_.size()];
   }
 
-  auto InsertJoinKey(const JoinKey& join_key, const Tuple& tuple) -> void{
-    ht_.insert({join_key, tuple});
-  }
+  /** Build the partitioned hash table from the batches of the right side */
+  void Build(std::vector<TupleBatch> &&right_batches);
+
+  /** The scratch space and the output batch of one probe worker */
+  struct ProbeState {
+    std::vector<std::vector<Value>> key_columns_;
+    std::vector<char> key_;
+    std::vector<Value> values_;
+    TupleBatch output_;
+  };
+
+  /**
+   * Join a batch of the left side on a probe worker, pushing every full output batch to the exchange.
+   * @return false if the exchange is being stopped
+   */
+  auto ProbeBatch(const TupleBatch &left_batch, ProbeState *state) -> bool;
 
-  auto OutputTuple(const Schema &left_table_schema, const Schema &right_table_schema, Tuple *right_tuple,
-                                   Tuple *tuple, bool matched) -> void;  
+  /** Parallel NextBatch(): probe with the batches of every pipeline of `gather` on the worker that produced them */
+  void ProbeInParallel(GatherExecutor *gather);
+
+  /** A pair of spilled partitions of the left and right side holding the same join keys */
+  struct SpilledPartition {
+    std::unique_ptr<TmpTupleFile> left_;
+    std::unique_ptr<TmpTupleFile> right_;
+    /** The number of times the rows have been partitioned before, 0 for the first split of the inputs */
+    size_t level_{0};
+  };
+
+  /** @return the spill partition of a join key hash, with a different hash function at every level */
+  static auto PartitionOf(hash_t hash, size_t level) -> size_t;
+
+  /** @return SPILL_FANOUT empty temporary files */
+  auto MakeSpillFiles() -> std::vector<std::unique_ptr<TmpTupleFile>>;
+
+  /**
+   * Append the rows of a batch of the left or right side to the file of their partition. A right row with a null join
+   * key is dropped, a left one is kept only by a left join.
+   */
+  void SpillBatch(const TupleBatch &batch, bool is_left, size_t level,
+                  std::vector<std::unique_ptr<TmpTupleFile>> *files);
+
+  /** Queue the pairs of files partitioned on `level` to be joined */
+  void AddSpilledPartitions(std::vector<std::unique_ptr<TmpTupleFile>> &&left_files,
+                            std::vector<std::unique_ptr<TmpTupleFile>> &&right_files, size_t level);
+
+  /** Partition the right side, starting with the rows already read into `right_batches`, then the left side */
+  void Spill(std::vector<TupleBatch> &&right_batches);
+
+  /** Partition both sides of a spilled partition once more, on the next level */
+  void Repartition(SpilledPartition &&partition);
+
+  /**
+   * Read the next batch of the left side to probe with. Once spilled, the hash table is rebuilt from the right side
+   * of the next partition whenever the left side of the current one is exhausted.
+   */
+  auto NextLeftBatch(TupleBatch *batch) -> bool;
+
+  /** @return the first right row matching the row `row` of the left join keys, NO_ROW if there is none */
+  auto FindMatch(const std::vector<std::vector<Value>> &key_columns, size_t row, std::vector<char> *key) const
+      -> std::pair<const JoinHashTable *, uint64_t>;
+
+  auto OutputTuple(const Schema &left_table_schema, const Schema &right_table_schema, const JoinHashTable *table,
+                   uint64_t right_row, Tuple *tuple, bool matched) -> void;
+
+  /**
+   * Append a left row joined with the row `right_row` of `table`, or with nulls if it is NO_ROW, using `values` as
+   * scratch space.
+   */
+  auto OutputRow(const TupleBatch &left_batch, size_t left_row, const JoinHashTable *table, uint64_t right_row,
+                 std::vector<Value> *values, TupleBatch *batch) const -> void;
 
  private:
   /** The NestedLoopJoin plan node to be executed. */
   const HashJoinPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> left_executor_;
   std::unique_ptr<AbstractExecutor> right_executor_;
+  /** The number of workers that may build the hash table */
+  size_t parallelism_;
 
-  std::unordered_multimap<JoinKey, Tuple> ht_;
+  /** The right rows, in partitions on the hash of the join key */
+  std::vector<JoinHashTable> partitions_;
   Tuple left_tuple_;
-  std::pair<std::unordered_multimap<JoinKey, Tuple>::iterator, std::unordered_multimap<JoinKey, Tuple>::iterator> range_pair_it_;
-  std::unordered_multimap<JoinKey, Tuple>::iterator cur_it_;
+  /** The table holding the matches of the left tuple being probed, and the next match */
+  const JoinHashTable *cur_table_{nullptr};
+  uint64_t cur_row_{JoinHashTable::NO_ROW};
   bool is_begin_;
   bool bucket_finished_;
+
+  /** NextBatch(): the batch of left tuples being probed, their join keys, and the row under the probe cursor */
+  TupleBatch left_batch_;
+  std::vector<std::vector<Value>> left_key_columns_;
+  size_t left_row_{0};
+  std::vector<char> left_key_;
+  std::vector<Value> output_values_;
+
+  /** Grace hash join: set once the right side exceeds the memory budget */
+  bool spilled_{false};
+  /** The partitions still to be joined, and the one whose left side is being probed */
+  std::vector<SpilledPartition> pending_partitions_;
+  SpilledPartition current_partition_;
+  /** Next() after spilling hands out the rows of NextBatch() one at a time */
+  TupleBatch output_batch_;
+  size_t output_row_{0};
+  /** The number of times a partition is split again before it is joined however large it is */
+  static constexpr size_t MAX_SPILL_LEVEL = 3;
+
+  /** Declared last, so the probe workers are stopped before the members they use are destroyed */
+  BatchExchange exchange_;
 };
 
 }  // namespace bustub
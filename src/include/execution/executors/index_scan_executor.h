@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include "catalog/catalog.h"
@@ -43,12 +45,24 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /**
+   * Build the index key for one side of the range. Index::Scan only compares the leading key column of a bound, the
+   * other key columns are null
+   */
+  auto MakeBoundKey(const AbstractExpressionRef &bound) const -> Tuple;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
   // my
   TableInfo *table_info_;
-  BPlusTreeIndexForTwoIntegerColumn *index_;
-  BPlusTreeIndexIteratorForTwoIntegerColumn it_;
-  BPlusTreeIndexIteratorForTwoIntegerColumn end_;
+  IndexInfo *index_info_;
+  std::unique_ptr<IndexCursor> cursor_;
+  /** Cursor over the tuples of an index-organized table, used instead of cursor_ to scan its primary key */
+  std::unique_ptr<TupleCursor> tuple_cursor_;
+  /** For an index-only scan, the position of each output column in the index entries, if the index stores it */
+  std::vector<std::optional<uint32_t>> entry_columns_;
+  /** For an equality lookup, the RIDs matching the key and the next one to fetch from the table */
+  std::vector<RID> point_rids_;
+  size_t point_rid_idx_{0};
 };
 }  // namespace bustub
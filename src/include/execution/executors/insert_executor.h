@@ -13,6 +13,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <unordered_set>
 #include <utility>
 #include "catalog/catalog.h"
 #include "execution/executor_context.h"
@@ -62,6 +64,21 @@ class InsertExecutor : public AbstractExecutor {
   TableInfo* table_info_; // my
   std::vector<IndexInfo *> index_info_; // my
   bool has_finished_;
+
+  /** Insert the buffered entries into the indexes with one batched call per index, throws if an index refuses one */
+  void FlushIndexEntries();
+
+  /** Insert the tuples of a clustered table, throws before inserting any of them if a primary key is taken */
+  void InsertClusteredTuples(const std::vector<Tuple> &tuples);
+
+  /** @return the normalized search columns of `key`, equal for keys that a unique index treats as duplicates */
+  static auto UniqueKeyBytes(const Index &index, const Tuple &key) -> std::string;
+
+  /** index_keys_[i] buffers the keys of index_info_[i], all of them share the RIDs in index_rids_ */
+  std::vector<std::vector<Tuple>> index_keys_;
+  std::vector<RID> index_rids_;
+  /** pending_keys_[i] holds UniqueKeyBytes of the keys buffered for the unique index index_info_[i] */
+  std::vector<std::unordered_set<std::string>> pending_keys_;
 };
 
 }  // namespace bustub
@@ -13,11 +13,13 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "catalog/catalog.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
@@ -48,7 +50,28 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Emit the outer tuple joined with `inner_tuple`, or padded with nulls if `inner_tuple` is nullptr */
+  void OutputTuple(const Tuple *inner_tuple, Tuple *tuple);
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  const IndexInfo *index_info_{nullptr};
+  const TableInfo *inner_table_info_{nullptr};
+
+  /** Pull the next batch of outer tuples and probe the index with all of their keys at once */
+  auto FetchOuterBatch() -> bool;
+
+  /**
+   * The current batch of outer tuples, inner_rids_[i] holds the RIDs the index returned for outer_tuples_[i].
+   * An index that is not unique returns many.
+   */
+  std::vector<Tuple> outer_tuples_;
+  std::vector<std::vector<RID>> inner_rids_;
+  /** The inner tuple of outer_tuples_[i] when the inner table is index-organized, its index stores the tuples */
+  std::vector<std::optional<Tuple>> inner_tuples_;
+  size_t outer_idx_{0};
+  size_t inner_rid_idx_{0};
+  bool joined_{false};
 };
 }  // namespace bustub
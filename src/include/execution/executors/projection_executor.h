@@ -47,6 +47,13 @@ class ProjectionExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the projection.
+   * @param[out] batch The next batch produced by the projection
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the projection plan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
@@ -56,5 +63,8 @@ class ProjectionExecutor : public AbstractExecutor {
 
   /** The child executor from which tuples are obtained */
   std::unique_ptr<AbstractExecutor> child_executor_;
+
+  /** The batch the child fills for NextBatch() */
+  TupleBatch child_batch_;
 };
 }  // namespace bustub
@@ -12,11 +12,14 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/index/index.h"
+#include "storage/table/morsel_dispenser.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
@@ -33,6 +36,15 @@ class SeqScanExecutor : public AbstractExecutor {
    * @param plan The sequential scan plan to be executed
    */
   SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan);
+
+  /**
+   * Construct a new SeqScanExecutor instance that only scans the morsels it claims from a dispenser shared with other
+   * scans of the same table. The owner of the dispenser resets it, Init() does not.
+   * @param exec_ctx The executor context
+   * @param plan The sequential scan plan to be executed
+   * @param dispenser The dispenser handing out the pages of the table
+   */
+  SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan, std::shared_ptr<MorselDispenser> dispenser);
   ~SeqScanExecutor() override;
   /** Initialize the sequential scan */
   void Init() override;
@@ -45,6 +57,13 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the sequential scan.
+   * @param[out] batch The next batch produced by the scan
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the sequential scan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
@@ -52,5 +71,14 @@ class SeqScanExecutor : public AbstractExecutor {
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   TableIterator* iter_; // my
+  /** Cursor over the clustered index of an index-organized table, which has no table heap */
+  std::unique_ptr<TupleCursor> tuple_cursor_;
+  /** Hands out the pages NextBatch scans, either private to this scan or shared with the other workers of a scan */
+  std::shared_ptr<MorselDispenser> dispenser_;
+  bool shared_dispenser_{false};
+  /** The morsel being scanned and the position in it */
+  std::vector<page_id_t> morsel_;
+  size_t morsel_idx_{0};
+  uint32_t slot_{0};
 };
 }  // namespace bustub
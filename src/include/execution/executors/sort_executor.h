@@ -12,20 +12,36 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/loser_tree.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/sort_plan.h"
+#include "storage/table/tmp_tuple_file.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_batch.h"
 
 namespace bustub {
 
 /**
  * The SortExecutor executor executes a sort.
+ *
+ * Tuples are sorted on their normalized SortKey, which is encoded once per tuple, so a comparison is a memcmp. With a
+ * parallelism above one, the batches read from the child are split among the workers, every worker encodes and sorts
+ * its share into a run, and the runs are merged in parallel: keys sampled from the runs split the key space into one
+ * range per worker, and every worker merges its range of all runs into its own slice of the output.
+ *
+ * When the child produces more bytes than the memory budget, the sort turns external: every budget's worth of tuples
+ * is sorted as above and written to a temporary file as a run, and the runs are merged with a loser tree. While there
+ * are more runs than the budget has pages for, the first runs are merged into a longer one. The last merge streams its
+ * output out of Next(), the RIDs of a spilled sort are not kept.
  */
 class SortExecutor : public AbstractExecutor {
  public:
@@ -33,8 +49,10 @@ class SortExecutor : public AbstractExecutor {
    * Construct a new SortExecutor instance.
    * @param exec_ctx The executor context
    * @param plan The sort plan to be executed
+   * @param parallelism The number of workers that may sort and merge the runs
    */
-  SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child_executor);
+  SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child_executor,
+               size_t parallelism);
 
   /** Initialize the sort */
   void Init() override;
@@ -51,10 +69,62 @@ class SortExecutor : public AbstractExecutor {
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
  private:
+  /** A tuple to sort with its normalized key */
+  struct SortEntry {
+    std::string key_;
+    Tuple tuple_;
+    RID rid_;
+  };
+
+  /** A sorted run being merged, read back one page at a time */
+  struct SortedRun {
+    std::unique_ptr<TmpTupleFile> file_;
+    TupleBatch page_{1};
+    /** The keys of the tuples in page_, runs only store the tuples */
+    std::vector<std::string> page_keys_;
+    size_t next_row_{0};
+    /** The smallest tuple of the run not merged yet and its key */
+    Tuple head_;
+    std::string head_key_;
+  };
+
+  /** @return true if the head of the merged run `a` comes before the head of `b` */
+  auto HeadLess(size_t a, size_t b) const -> bool { return merge_runs_[a].head_key_ < merge_runs_[b].head_key_; }
+
+  /** Sort the batches read so far into entries_, with up to one worker per batch */
+  void SortInMemory();
+
+  /** Merge sorted runs into entries_, each worker merging one range of keys */
+  void MergeInParallel(std::vector<std::vector<SortEntry>> &&runs);
+
+  /** Sort the batches read so far and write them to a new run */
+  void SpillRun();
+
+  /** Start merging the runs in `files` */
+  void StartMerge(std::vector<std::unique_ptr<TmpTupleFile>> &&files);
+
+  /** Move the head of a run to its next tuple. @return false if the run is exhausted */
+  auto Advance(SortedRun *run) -> bool;
+
+  /** @return the next tuple of the merge, false once every run is exhausted */
+  auto NextMerged(Tuple *tuple) -> bool;
+
   /** The sort plan node to be executed */
   const SortPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_executor_;
-  std::vector<std::pair<Tuple, RID>> ordered_pairs_;
-  std::vector<std::pair<Tuple, RID>>::iterator cur_iterator_;
+  /** The number of workers that may sort and merge the runs */
+  size_t parallelism_;
+  /** The batches read from the child and not sorted yet */
+  std::vector<TupleBatch> batches_;
+  /** The bytes of the tuples in batches_ */
+  size_t run_size_{0};
+  std::vector<SortEntry> entries_;
+  std::vector<SortEntry>::iterator cur_iterator_;
+
+  /** External sort: the runs written so far, and the runs of the merge in progress */
+  std::deque<std::unique_ptr<TmpTupleFile>> runs_;
+  bool merging_{false};
+  std::vector<SortedRun> merge_runs_;
+  LoserTree loser_tree_;
 };
 }  // namespace bustub
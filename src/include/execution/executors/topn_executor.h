@@ -15,6 +15,7 @@
 #include <cstddef>
 #include <memory>
 #include <queue>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -29,6 +30,8 @@ namespace bustub {
 
 /**
  * The TopNExecutor executor executes a topn.
+ *
+ * A max-heap of the N smallest tuples so far is ordered on their normalized SortKey, encoded once per child tuple.
  */
 class TopNExecutor : public AbstractExecutor {
  public:
@@ -62,6 +65,13 @@ class TopNExecutor : public AbstractExecutor {
   auto GetNumInHeap() -> size_t;
 
  private:
+  /** A tuple in the heap with its normalized key */
+  struct HeapEntry {
+    std::string key_;
+    Tuple tuple_;
+    RID rid_;
+  };
+
   /** The topn plan node to be executed */
   const TopNPlanNode *plan_;
   /** The child executor from which tuples are obtained */
@@ -58,6 +58,9 @@ class UpdateExecutor : public AbstractExecutor {
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
  private:
+  /** Replace the tuples of an index-organized table, @return false if a new primary key already exists */
+  auto UpdateClusteredTable(const std::vector<Tuple> &old_tuples) -> bool;
+
   /** The update plan node to be executed */
   const UpdatePlanNode *plan_;
   /** Metadata identifying the table that should be updated */
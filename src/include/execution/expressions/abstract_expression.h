@@ -20,6 +20,7 @@
 #include "catalog/schema.h"
 #include "fmt/format.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_batch.h"
 
 #define BUSTUB_EXPR_CLONE_WITH_CHILDREN(cname)                                                                   \
   auto CloneWithChildren(std::vector<AbstractExpressionRef> children) const->std::unique_ptr<AbstractExpression> \
@@ -65,6 +66,21 @@ class AbstractExpression {
   virtual auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
                             const Schema &right_schema) const -> Value = 0;
 
+  /**
+   * Evaluate the expression on every row of a batch. The default rebuilds each row as a tuple and calls Evaluate(),
+   * expressions override it to work on whole columns of the batch.
+   * @param batch The rows to evaluate the expression on
+   * @param[out] result One value per row of the batch
+   */
+  virtual void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const {
+    result->clear();
+    result->reserve(batch.NumRows());
+    for (size_t row = 0; row < batch.NumRows(); row++) {
+      auto tuple = batch.GetTuple(row);
+      result->push_back(Evaluate(&tuple, *batch.GetSchema()));
+    }
+  }
+
   /** @return the child_idx'th child of this expression */
   auto GetChildAt(uint32_t child_idx) const -> const AbstractExpressionRef & { return children_[child_idx]; }
 
@@ -49,6 +49,25 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    std::vector<Value> lhs;
+    std::vector<Value> rhs;
+    GetChildAt(0)->EvaluateBatch(batch, &lhs);
+    GetChildAt(1)->EvaluateBatch(batch, &rhs);
+    result->clear();
+    result->reserve(batch.NumRows());
+    for (size_t i = 0; i < lhs.size(); i++) {
+      // two integers are compared directly, without dispatching on the type of the values
+      if (lhs[i].GetTypeId() == TypeId::INTEGER && rhs[i].GetTypeId() == TypeId::INTEGER && !lhs[i].IsNull() &&
+          !rhs[i].IsNull()) {
+        result->push_back(
+            ValueFactory::GetBooleanValue(PerformComparison(lhs[i].GetAs<int32_t>(), rhs[i].GetAs<int32_t>())));
+      } else {
+        result->push_back(ValueFactory::GetBooleanValue(PerformComparison(lhs[i], rhs[i])));
+      }
+    }
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), comp_type_, *GetChildAt(1));
@@ -77,6 +96,25 @@ class ComparisonExpression : public AbstractExpression {
         BUSTUB_ASSERT(false, "Unsupported comparison type.");
     }
   }
+
+  auto PerformComparison(int32_t lhs, int32_t rhs) const -> bool {
+    switch (comp_type_) {
+      case ComparisonType::Equal:
+        return lhs == rhs;
+      case ComparisonType::NotEqual:
+        return lhs != rhs;
+      case ComparisonType::LessThan:
+        return lhs < rhs;
+      case ComparisonType::LessThanOrEqual:
+        return lhs <= rhs;
+      case ComparisonType::GreaterThan:
+        return lhs > rhs;
+      case ComparisonType::GreaterThanOrEqual:
+        return lhs >= rhs;
+      default:
+        UNREACHABLE("Unsupported comparison type.");
+    }
+  }
 };
 }  // namespace bustub
 
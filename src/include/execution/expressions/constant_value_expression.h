@@ -34,6 +34,10 @@ class ConstantValueExpression : public AbstractExpression {
     return val_;
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    result->assign(batch.NumRows(), val_);
+  }
+
   /** @return the string representation of the plan node and its children */
   auto ToString() const -> std::string override { return val_.ToString(); }
 
@@ -57,6 +57,18 @@ class LogicExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComputation(lhs, rhs));
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    std::vector<Value> lhs;
+    std::vector<Value> rhs;
+    GetChildAt(0)->EvaluateBatch(batch, &lhs);
+    GetChildAt(1)->EvaluateBatch(batch, &rhs);
+    result->clear();
+    result->reserve(batch.NumRows());
+    for (size_t i = 0; i < lhs.size(); i++) {
+      result->push_back(ValueFactory::GetBooleanValue(PerformComputation(lhs[i], rhs[i])));
+    }
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), logic_type_, *GetChildAt(1));
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_hash_table.h
+//
+// Identification: src/include/execution/join_hash_table.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/util/hash_util.h"
+#include "storage/table/tuple_batch.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * JoinHashTable is the hash table a hash join builds on its right side.
+ *
+ * The build rows are serialized one after another into an arena: the offset of the next row with the same key, the
+ * size of the join key, the join key and the row in the layout of a Tuple, which starts 8-byte aligned. The table
+ * itself is a flat array of (hash, row offset) entries with linear probing, one entry per distinct key, and the rows of
+ * a key are chained through the arena. Keys are compared on their serialized bytes, so a probe costs one hash of the
+ * key bytes and no allocation.
+ */
+class JoinHashTable {
+ public:
+  /** The row offset of an empty entry and of the end of a chain */
+  static constexpr uint64_t NO_ROW = std::numeric_limits<uint64_t>::max();
+
+  /** @param schema The schema of the build rows, which must outlive the table */
+  explicit JoinHashTable(const Schema *schema) : schema_(schema) {}
+
+  /**
+   * Serialize the join key of a row, given the values of the key expressions for a whole batch. Numbers are widened
+   * to 64-bit integers, or to doubles for decimals that are not integral, so keys of different numeric types compare
+   * equal when their values do.
+   * @param[out] key the bytes of the key
+   * @return false if a value of the key is null, the row matches no other row
+   */
+  static auto SerializeKey(const std::vector<std::vector<Value>> &key_columns, size_t row, std::vector<char> *key)
+      -> bool;
+
+  /** @return the hash of a serialized key */
+  static auto HashKey(const std::vector<char> &key) -> hash_t;
+
+  /** Size the table for `num_rows` build rows, so inserting them does not grow it */
+  void Reserve(size_t num_rows);
+
+  /** Insert the row `row` of `batch` with the serialized key `key` and its hash */
+  void Insert(const std::vector<char> &key, hash_t hash, const TupleBatch &batch, size_t row);
+
+  /** @return the first row with the key, NO_ROW if there is none */
+  auto Find(const std::vector<char> &key, hash_t hash) const -> uint64_t;
+
+  /** @return the next row with the same key as `row`, NO_ROW after the last one */
+  auto NextRow(uint64_t row) const -> uint64_t;
+
+  /** Append the values of the row `row` to `values` */
+  void AppendRowValues(uint64_t row, std::vector<Value> *values) const;
+
+  /** @return the number of build rows */
+  auto Size() const -> size_t { return num_rows_; }
+
+ private:
+  struct Entry {
+    hash_t hash_;
+    uint64_t row_;
+  };
+
+  /** Offsets of the fields of a serialized row, the key follows the header */
+  static constexpr size_t OFFSET_NEXT = 0;
+  static constexpr size_t OFFSET_KEY_SIZE = OFFSET_NEXT + sizeof(uint64_t);
+  static constexpr size_t SIZE_ROW_HEADER = OFFSET_KEY_SIZE + sizeof(uint32_t);
+
+  /** @return true if the row `row` has the key `key` */
+  auto KeyEquals(uint64_t row, const std::vector<char> &key) const -> bool;
+
+  /** Double the number of entries and insert the entries again */
+  void Grow();
+
+  const Schema *schema_;
+  std::vector<Entry> entries_;
+  size_t num_keys_{0};
+  size_t num_rows_{0};
+  std::vector<char> arena_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// loser_tree.h
+//
+// Identification: src/include/execution/loser_tree.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * LoserTree picks the smallest head of k sorted sources for a k-way merge. Every inner node keeps the loser of the
+ * match played there and the overall winner sits above the root, so replacing the winner replays only the log2(k)
+ * matches on its path, one comparison each.
+ *
+ * The tree only holds source indices. The caller compares the current heads of two sources with `less(a, b)` and
+ * tells the tree when the winner has advanced or run out. Equal heads are won by the lower source index, which keeps
+ * the merge stable.
+ */
+class LoserTree {
+ public:
+  /** Start a merge of `num_sources` sources, Build() it once every source holds its first head */
+  void Reset(size_t num_sources) {
+    num_sources_ = num_sources;
+    tree_.assign(num_sources, 0);
+    exhausted_.assign(num_sources, false);
+  }
+
+  /** Mark a source as having no head, e.g. an empty source before Build() */
+  void SetExhausted(size_t source) { exhausted_[source] = true; }
+
+  /** Play every match of the tree */
+  template <typename Less>
+  void Build(const Less &less) {
+    if (num_sources_ > 0) {
+      tree_[0] = Play(1, less);
+    }
+  }
+
+  /** @return the source holding the smallest head, or the number of sources once every source has run out */
+  auto Top() const -> size_t {
+    return num_sources_ == 0 || exhausted_[tree_[0]] ? num_sources_ : tree_[0];
+  }
+
+  /** Replay the matches of the winner Top() after it advanced to its next head, or ran out if `exhausted` */
+  template <typename Less>
+  void Update(bool exhausted, const Less &less) {
+    auto winner = tree_[0];
+    exhausted_[winner] = exhausted;
+    for (auto node = (winner + num_sources_) / 2; node > 0; node /= 2) {
+      if (Beats(tree_[node], winner, less)) {
+        std::swap(tree_[node], winner);
+      }
+    }
+    tree_[0] = winner;
+  }
+
+ private:
+  template <typename Less>
+  auto Beats(size_t a, size_t b, const Less &less) const -> bool {
+    if (exhausted_[a] || exhausted_[b]) {
+      return !exhausted_[a] || (exhausted_[b] && a < b);
+    }
+    return less(a, b) || (!less(b, a) && a < b);
+  }
+
+  /** Nodes [1, k) are inner nodes and node k + i is the leaf of source i. @return the winner below `node` */
+  template <typename Less>
+  auto Play(size_t node, const Less &less) -> size_t {
+    if (node >= num_sources_) {
+      return node - num_sources_;
+    }
+    auto left = Play(2 * node, less);
+    auto right = Play(2 * node + 1, less);
+    if (Beats(left, right, less)) {
+      tree_[node] = right;
+      return left;
+    }
+    tree_[node] = left;
+    return right;
+  }
+
+  size_t num_sources_{0};
+  /** tree_[0] is the winner, tree_[node] the loser of the match at inner node `node` */
+  std::vector<size_t> tree_;
+  std::vector<bool> exhausted_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel.h
+//
+// Identification: src/include/execution/parallel.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * Run `work(worker)` for every worker in [0, num_workers) on its own thread and wait for all of them. The first
+ * exception thrown by a worker is rethrown once every worker is done.
+ */
+void RunWorkers(size_t num_workers, const std::function<void(size_t)> &work);
+
+/**
+ * BatchExchange hands the batches produced on worker threads to the thread running the parent executor. The queue is
+ * bounded, so the workers wait while the parent falls behind. The first exception thrown by a worker is rethrown by
+ * Pop().
+ */
+class BatchExchange {
+ public:
+  ~BatchExchange() { Stop(); }
+
+  /**
+   * Start `num_workers` threads running `work(worker)`. A worker pushes its batches and returns when it is done, or as
+   * soon as Push() returns false.
+   */
+  void Start(size_t num_workers, std::function<void(size_t)> work);
+
+  /** @return true once Start() has been called, until Stop() */
+  auto IsStarted() const -> bool { return !workers_.empty(); }
+
+  /**
+   * Queue a batch, waiting while the queue is full. Called by the workers.
+   * @return false if the exchange is being stopped, the worker should return
+   */
+  auto Push(TupleBatch *batch) -> bool;
+
+  /**
+   * Take the next batch any worker has queued, waiting for one if needed.
+   * @param[out] batch the batch, reset to `schema` if there are no more batches
+   * @return false once every worker is done and the queue is empty
+   */
+  auto Pop(TupleBatch *batch, const Schema *schema) -> bool;
+
+  /** Stop the workers, drop the queued batches and wait for the workers to return */
+  void Stop();
+
+ private:
+  std::vector<std::thread> workers_;
+  size_t max_queued_{0};
+
+  std::mutex latch_;
+  /** Signaled when a batch is queued or a worker returns */
+  std::condition_variable not_empty_;
+  /** Signaled when a batch is taken off the queue or the exchange is stopped */
+  std::condition_variable not_full_;
+  std::deque<TupleBatch> batches_; /* protected by latch_ */
+  size_t num_running_{0};          /* protected by latch_ */
+  bool stopped_{false};            /* protected by latch_ */
+  std::exception_ptr error_;       /* protected by latch_ */
+};
+
+}  // namespace bustub
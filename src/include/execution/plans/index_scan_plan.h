@@ -14,10 +14,12 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "fmt/ranges.h"
 
 namespace bustub {
 /**
@@ -29,9 +31,27 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_oid the identifier of table to be scanned
+   * @param lower_bound the lower bound on the leading key column, nullptr if unbounded
+   * @param lower_inclusive whether the lower bound itself is part of the range
+   * @param upper_bound the upper bound on the leading key column, nullptr if unbounded
+   * @param upper_inclusive whether the upper bound itself is part of the range
+   * @param reverse whether the scan emits tuples in descending key order
+   * @param index_only whether the scan reads the columns from a covering index instead of the table
+   * @param point_key the value of every key column for an equality lookup, empty for a scan
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, AbstractExpressionRef lower_bound = nullptr,
+                    bool lower_inclusive = true, AbstractExpressionRef upper_bound = nullptr,
+                    bool upper_inclusive = true, bool reverse = false, bool index_only = false,
+                    std::vector<AbstractExpressionRef> point_key = {})
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        lower_bound_(std::move(lower_bound)),
+        lower_inclusive_(lower_inclusive),
+        upper_bound_(std::move(upper_bound)),
+        upper_inclusive_(upper_inclusive),
+        reverse_(reverse),
+        index_only_(index_only),
+        point_key_(std::move(point_key)) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
@@ -40,14 +60,46 @@ class IndexScanPlanNode : public AbstractPlanNode {
 
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexScanPlanNode);
 
+  /** @return true if the scan only covers a range of the index instead of the whole index */
+  auto IsRangeScan() const -> bool { return lower_bound_ != nullptr || upper_bound_ != nullptr; }
+
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
-  // Add anything you want here for index lookup
+  /** The bounds of a range scan on the leading key column. Both are constant expressions. */
+  AbstractExpressionRef lower_bound_;
+  bool lower_inclusive_;
+  AbstractExpressionRef upper_bound_;
+  bool upper_inclusive_;
+
+  /** Scan from the largest key to the smallest one, used for descending ORDER BY. */
+  bool reverse_;
+
+  /**
+   * Index-only scan of a covering index, see Index::ScanEntries. Set by the optimizer when the plan above never reads
+   * a column the index does not store, the other columns of the output tuples are null.
+   */
+  bool index_only_;
+
+  /**
+   * Equality lookup of one key, see Index::ScanKey. Used for hash indexes, which cannot scan a range. Holds one
+   * constant expression per key column, the scan bounds are unused.
+   */
+  std::vector<AbstractExpressionRef> point_key_;
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    std::string range;
+    if (IsRangeScan()) {
+      range = fmt::format(", range={}{}, {}{}", lower_inclusive_ ? "[" : "(",
+                          lower_bound_ != nullptr ? lower_bound_->ToString() : "-inf",
+                          upper_bound_ != nullptr ? upper_bound_->ToString() : "+inf", upper_inclusive_ ? "]" : ")");
+    }
+    if (!point_key_.empty()) {
+      range = fmt::format(", key={}", point_key_);
+    }
+    return fmt::format("IndexScan {{ index_oid={}{}{}{} }}", index_oid_, range, reverse_ ? ", reverse" : "",
+                       index_only_ ? ", index_only" : "");
   }
 };
 
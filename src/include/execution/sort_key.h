@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key.h
+//
+// Identification: src/include/execution/sort_key.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binder/bound_order_by.h"
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/table/tuple.h"
+#include "storage/table/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * SortKey encodes the ORDER BY values of a tuple into a normalized key: a byte string whose unsigned byte order, as
+ * compared by memcmp or std::string, is the order of the plan. The ORDER BY expressions are evaluated once per tuple
+ * instead of once per comparison.
+ *
+ * Every value starts with a byte that sorts NULL before any other value. Numbers follow big-endian with the sign bit
+ * flipped, strings follow with their 0x00 bytes escaped and end with 0x00 0x00, so a prefix sorts first and a string
+ * cannot run into the next value. The bytes of a descending value are inverted, NULL included, so NULL comes first
+ * in ascending order and last in descending order.
+ */
+class SortKey {
+ public:
+  /**
+   * Encode the ORDER BY values of `tuple`.
+   * @param[out] key the normalized key, replaced
+   */
+  static void Encode(const std::vector<std::pair<OrderByType, AbstractExpressionRef>> &order_bys, const Tuple &tuple,
+                     const Schema &schema, std::string *key);
+
+  /**
+   * Encode the ORDER BY values of every row of `batch`, evaluating each expression on the whole batch.
+   * @param[out] keys the normalized key of every row, replaced
+   */
+  static void EncodeBatch(const std::vector<std::pair<OrderByType, AbstractExpressionRef>> &order_bys,
+                          const TupleBatch &batch, std::vector<std::string> *keys);
+
+  /** Append the normalized bytes of a single value */
+  static void AppendValue(const Value &value, bool descending, std::string *key);
+};
+
+}  // namespace bustub
@@ -85,6 +85,12 @@ class Optimizer {
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief optimize filter over seq scan as a range index scan if the filter bounds the leading column of an index.
+   * The filter is kept above the index scan to evaluate the rest of the predicate.
+   */
+  auto OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
   /** @brief check if the index can be matched */
   auto MatchIndex(const std::string &table_name, uint32_t index_key_idx)
       -> std::optional<std::tuple<index_oid_t, std::string>>;
@@ -94,6 +100,12 @@ class Optimizer {
    */
   auto OptimizeSortLimitAsTopN(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief turn an index scan below a projection or an aggregation into an index-only scan if the index is covering
+   * and stores every column the plan reads
+   */
+  auto OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
   /**
    * @brief get the estimated cardinality for a table based on the table name. Useful when join reordering. BusTub
    * doesn't support statistics for now, so it's the only way for you to get the table size :(
@@ -4,7 +4,8 @@
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys in the tree are unique, a non-unique index appends the RID to every
+ *     key so that equal keys of different tuples stay apart
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
@@ -12,13 +13,18 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
 #include <deque>
 #include <iostream>
+#include <mutex>  // NOLINT
 #include <optional>
 #include <queue>
 #include <shared_mutex>
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "common/config.h"
@@ -69,7 +75,9 @@ class BPlusTree {
  public:
   explicit BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
                      const KeyComparator &comparator, int leaf_max_size = LEAF_PAGE_SIZE,
-                     int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int internal_max_size = INTERNAL_PAGE_SIZE, bool lazy_delete = false);
+
+  ~BPlusTree();
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -80,6 +88,9 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *txn);
 
+  // Merge the underfull leaf pages that lazy deletion left behind, the compaction thread calls this as well
+  void Compact();
+
   // Return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn = nullptr) -> bool;
 
@@ -93,6 +104,28 @@ class BPlusTree {
 
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  // Index iterator over the keys between lo and hi, a nullptr bound leaves that side open
+  auto ScanRange(const KeyType *lo, bool lo_inclusive, const KeyType *hi, bool hi_inclusive) -> INDEXITERATOR_TYPE;
+
+  // Reverse index iterator, starts from the largest key and walks toward smaller ones
+  auto RBegin() -> INDEXITERATOR_TYPE;
+
+  // Reverse index iterator over the keys between lo and hi, starting from hi
+  auto ReverseScanRange(const KeyType *lo, bool lo_inclusive, const KeyType *hi, bool hi_inclusive)
+      -> INDEXITERATOR_TYPE;
+
+  // Insert a batch of key-value pairs in key order, keys that land in the same leaf page share one descent.
+  // Return the number of pairs that were inserted
+  auto InsertBatch(std::vector<std::pair<KeyType, ValueType>> entries, Transaction *txn = nullptr) -> int;
+
+  // Return the values associated with a batch of keys, results[i] holds the values of keys[i]
+  void GetValueBatch(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                     Transaction *txn = nullptr);
+
+  // Return the values between each pair of inclusive bounds, results[i] holds the values within ranges[i]
+  void ScanRangeBatch(const std::vector<std::pair<KeyType, KeyType>> &ranges,
+                      std::vector<std::vector<ValueType>> *results, Transaction *txn = nullptr);
+
   // Print the B+ tree
   void Print(BufferPoolManager *bpm);
 
@@ -133,22 +166,31 @@ class BPlusTree {
   auto ToPrintableBPlusTree(page_id_t root_id) -> PrintableBPlusTree;
 
   /* helper function */
-  void InsertInParent(const KeyType &key, WritePageGuard &&new_page_guard, Context &ctx);
+  void InsertInParent(const KeyType &key, WritePageGuard &&new_page_guard, Context &ctx, bool append = false);
   void RemoveLeafEntry(Context &ctx, KeyType key, std::unordered_map<page_id_t, int> *page_id_to_index,
                        Transaction *txn);
+  void RebalanceLeafPage(Context &ctx, std::unordered_map<page_id_t, int> *page_id_to_index);
+  void EnqueueCompaction(const KeyType &key);
+  void CompactionLoop();
   void RemoveInternalEntry(Context &ctx, KeyType key, page_id_t val,
                            std::unordered_map<page_id_t, int> *page_id_to_index);
+  template <typename LeafGuard>
+  auto FindLeafPageWithFence(const KeyType &key, LeafGuard *leaf_guard, std::optional<KeyType> *upper_fence) -> bool;
   auto FindLeafPage(Context &ctx, const KeyType &key, OperationType op_type, bool optimistic, Transaction *txn,
                     std::unordered_map<page_id_t, int> *page_id_to_index = nullptr) -> bool;
   void UpdateParentPage(Context &ctx, const KeyType &key, InternalPage *new_root_page, WritePageGuard &&new_page_guard,
                         page_id_t cur_page_id, page_id_t root_page_id);
-  void NewLeafRootPage(Context &ctx, page_id_t *root_page_id);
+  void NewLeafRootPage(Context &ctx, WritePageGuard &header_page_guard);
+  void SetRootPageId(Context &ctx, WritePageGuard &header_page_guard, page_id_t root_page_id);
+  auto FetchRootPageRead(ReadPageGuard *guard, uint64_t *epoch = nullptr) -> page_id_t;
   void PrintPage(WritePageGuard &guard, bool is_leaf_page);
   void PrintPage(ReadPageGuard &guard, bool is_leaf_page);
   auto NewLeafPage(Context &ctx, page_id_t *new_page_id, page_id_t parent_page_id) -> LeafPage *;
   auto Split(LeafPage *leaf_page, LeafPage *new_page) -> KeyType;
   auto SplitLeafPage(LeafPage *leaf_page, LeafPage *new_page, const KeyType &key, const ValueType &value,
-                     page_id_t new_page_id) -> bool;
+                     page_id_t leaf_page_id, page_id_t new_page_id, bool append) -> bool;
+  auto IsAppend(const LeafPage *leaf_page, const KeyType &key) const -> bool;
+  auto AppendToRightmostLeaf(const KeyType &key, const ValueType &value) -> bool;
   auto GetTxnId(Transaction *txn) -> size_t;
 
   // member variable
@@ -159,6 +201,24 @@ class BPlusTree {
   int leaf_max_size_;
   int internal_max_size_;
   page_id_t header_page_id_;
+  // copy of the root page id in the header page, so that readers do not have to latch the header page
+  std::atomic<page_id_t> cached_root_page_id_{INVALID_PAGE_ID};
+  // bumped on every root change, while the old root page is still write latched
+  std::atomic<uint64_t> root_epoch_{0};
+
+  // lazy deletion never rebalances in Remove, it queues a key of every underfull leaf page for compaction
+  bool lazy_delete_;
+  std::mutex compaction_latch_;
+  std::condition_variable compaction_cv_;
+  std::deque<KeyType> compaction_queue_;
+  bool stop_compaction_{false};
+  // held while a leaf page is compacted, so that Compact() returns only once nothing is in flight
+  std::mutex compaction_run_latch_;
+  std::thread compaction_thread_;
+  // the rightmost leaf page, it only changes while that leaf page is write latched
+  std::atomic<page_id_t> rightmost_leaf_hint_{INVALID_PAGE_ID};
+  // whether the recent insertions kept appending keys larger than every key in the tree
+  std::atomic<bool> appending_{false};
 };
 
 /**
@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_clustered_index.h
+//
+// Identification: src/include/storage/index/b_plus_tree_clustered_index.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "storage/index/b_plus_tree_index.h"
+
+namespace bustub {
+
+#define BPLUSTREE_CLUSTERED_INDEX_TYPE BPlusTreeClusteredIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * A clustered index backed by a B+ tree. The leaf pages hold the tuples themselves keyed by the normalized primary
+ * key, so a range scan over the primary key reads the leaf chain and nothing else. ValueType is a TuplePayload large
+ * enough for the largest tuple of the table, see MaxSerializedTupleSize.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeClusteredIndex : public ClusteredIndex {
+ public:
+  BPlusTreeClusteredIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+
+  auto InsertTuple(const Tuple &key, const Tuple &tuple, Transaction *transaction) -> bool override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  auto GetTuple(const Tuple &key, Tuple *tuple, Transaction *transaction) -> bool override;
+
+  auto ScanTuples(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive, bool reverse)
+      -> std::unique_ptr<TupleCursor> override;
+
+ protected:
+  void MakeKey(const Tuple &key, KeyType *index_key) const;
+  auto MakeBoundKey(const Tuple &key, bool lowest, KeyType *index_key) const -> bool;
+
+  // comparator for key
+  KeyComparator comparator_;
+  // container
+  std::shared_ptr<BPlusTree<KeyType, ValueType, KeyComparator>> container_;
+};
+
+}  // namespace bustub
@@ -14,16 +14,65 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "container/hash/hash_function.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/bloom_filter.h"
 #include "storage/index/index.h"
+#include "storage/index/tuple_payload.h"
 
 namespace bustub {
 
 #define BPLUSTREE_INDEX_TYPE BPlusTreeIndex<KeyType, ValueType, KeyComparator>
 
+/** Cursor over a B+ tree index iterator, it keeps the read latch of the current leaf page */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeIndexCursor : public IndexCursor {
+ public:
+  explicit BPlusTreeIndexCursor(INDEXITERATOR_TYPE &&iter) : iter_(std::move(iter)) {}
+
+  auto Next(RID *rid) -> bool override {
+    if (iter_.IsEnd()) {
+      return false;
+    }
+    *rid = IndexEntryRid((*iter_).second);
+    ++iter_;
+    return true;
+  }
+
+ private:
+  INDEXITERATOR_TYPE iter_;
+};
+
+/**
+ * Cursor over a B+ tree whose values are TuplePayloads or CoveringPayloads, it keeps the read latch of the current
+ * leaf page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeTupleCursor : public TupleCursor {
+ public:
+  explicit BPlusTreeTupleCursor(INDEXITERATOR_TYPE &&iter) : iter_(std::move(iter)) {}
+
+  auto Next(Tuple *tuple) -> bool override {
+    if (iter_.IsEnd()) {
+      return false;
+    }
+    *tuple = (*iter_).second.ToTuple();
+    ++iter_;
+    return true;
+  }
+
+ private:
+  INDEXITERATOR_TYPE iter_;
+};
+
+/**
+ * A secondary index backed by a B+ tree. ValueType is either the RID of the row, or a CoveringPayload for a covering
+ * index that also stores its INCLUDE columns, see IndexMetadata::GetKeyColumnCount.
+ */
+
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
@@ -35,25 +84,67 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  auto InsertEntries(const std::vector<Tuple> &keys, const std::vector<RID> &rids, Transaction *transaction)
+      -> bool override;
+
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+  /**
+   * Scan the index keys that fall between two bounds. Only the leading key column of a bound is compared.
+   * @param lo The lower bound key, nullptr if the range has no lower bound
+   * @param lo_inclusive Whether a key equal to `lo` is part of the range
+   * @param hi The upper bound key, nullptr if the range has no upper bound
+   * @param hi_inclusive Whether a key equal to `hi` is part of the range
+   * @return An iterator positioned at the first key in range, equal to GetEndIterator() once the range is exhausted
+   */
+  auto ScanRange(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive) -> INDEXITERATOR_TYPE;
+
+  /**
+   * Same as ScanRange, but the iterator starts from the largest key in range and moves toward smaller keys.
+   */
+  auto ReverseScanRange(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive) -> INDEXITERATOR_TYPE;
+
+  auto Scan(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive, bool reverse)
+      -> std::unique_ptr<IndexCursor> override;
+
+  auto ScanEntries(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive, bool reverse)
+      -> std::unique_ptr<TupleCursor> override;
+
  protected:
+  void MakeKey(const Tuple &key, RID rid, KeyType *index_key) const;
+  void MakeValue(const Tuple &key, RID rid, ValueType *value) const;
+  void MakeFilterKey(const Tuple &key, KeyType *filter_key) const;
+  void ProbeKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results, Transaction *transaction);
+  auto MakeBoundKey(const Tuple &key, uint32_t column_count, bool lowest, KeyType *index_key) const -> bool;
+  void MakeRangeBounds(const Tuple *lo, bool *lo_inclusive, const Tuple *hi, bool *hi_inclusive, KeyType *lo_key,
+                       KeyType *hi_key) const;
+
   // comparator for key
   KeyComparator comparator_;
   // container
   std::shared_ptr<BPlusTree<KeyType, ValueType, KeyComparator>> container_;
+  // optional filter over the keys, lets a point lookup of a missing key skip the tree
+  std::unique_ptr<BloomFilter<KeyType>> bloom_filter_;
 };
 
-/** We only support index table with one integer key for now in BusTub. Hardcode everything here. */
+/**
+ * Key types of an index on at most two integer columns. Indexes created from SQL pick the smallest GenericKey that
+ * holds the normalized key, see NormalizedKeySize.
+ */
 
 constexpr static const auto TWO_INTEGER_SIZE = 8;
-using IntegerKeyType = GenericKey<TWO_INTEGER_SIZE>;
+/** Two integer columns plus the RID suffix of a non-unique index */
+constexpr static const auto TWO_INTEGER_WITH_RID_SIZE = TWO_INTEGER_SIZE + sizeof(int64_t);
+using IntegerKeyType = GenericKey<TWO_INTEGER_WITH_RID_SIZE>;
 using IntegerValueType = RID;
-using IntegerComparatorType = GenericComparator<TWO_INTEGER_SIZE>;
+using IntegerComparatorType = GenericComparator<TWO_INTEGER_WITH_RID_SIZE>;
 using BPlusTreeIndexForTwoIntegerColumn = BPlusTreeIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
 using BPlusTreeIndexIteratorForTwoIntegerColumn =
     IndexIterator<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.h
+//
+// Identification: src/include/storage/index/bloom_filter.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "murmur3/MurmurHash3.h"
+
+namespace bustub {
+
+/**
+ * An in-memory Bloom filter over the keys of an index. A key that was never inserted is rejected with high
+ * probability, so a point lookup that would miss skips the descent into the tree. Keys are hashed as raw bytes, so
+ * two keys must compare equal exactly when their bytes are equal, which holds for normalized keys.
+ *
+ * Removing a key leaves its bits set, so deletes only raise the false positive rate. The filter never grows either:
+ * it is sized once, and the false positive rate climbs as the number of keys outgrows `num_bits`. Bits are set with
+ * atomic OR, the filter is safe to use from concurrent inserts and lookups without a latch.
+ */
+template <typename KeyType>
+class BloomFilter {
+ public:
+  /**
+   * @param num_bits The size of the bit array, rounded up to a multiple of 64
+   * @param num_hashes The number of bits each key sets
+   */
+  explicit BloomFilter(size_t num_bits, uint32_t num_hashes = 4)
+      : num_words_(std::max<size_t>(1, (num_bits + 63) / 64)),
+        num_hashes_(num_hashes),
+        words_(new std::atomic<uint64_t>[num_words_]) {
+    for (size_t i = 0; i < num_words_; i++) {
+      words_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void Insert(const KeyType &key) {
+    auto [h1, h2] = Hash(key);
+    for (uint32_t i = 0; i < num_hashes_; i++) {
+      auto bit = (h1 + i * h2) % (num_words_ * 64);
+      words_[bit / 64].fetch_or(1ULL << (bit % 64));
+    }
+  }
+
+  /** @return false if `key` was certainly never inserted */
+  auto MayContain(const KeyType &key) const -> bool {
+    auto [h1, h2] = Hash(key);
+    for (uint32_t i = 0; i < num_hashes_; i++) {
+      auto bit = (h1 + i * h2) % (num_words_ * 64);
+      if ((words_[bit / 64].load() & (1ULL << (bit % 64))) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /** @return the memory taken by the bit array */
+  auto SizeInBytes() const -> size_t { return num_words_ * sizeof(uint64_t); }
+
+ private:
+  /** Double hashing, every probe is derived from the two halves of one 128-bit murmur3 hash */
+  static auto Hash(const KeyType &key) -> std::pair<uint64_t, uint64_t> {
+    uint64_t hash[2];
+    murmur3::MurmurHash3_x64_128(reinterpret_cast<const void *>(&key), static_cast<int>(sizeof(KeyType)), 0,
+                                 reinterpret_cast<void *>(&hash));
+    // a zero step would put every probe on the same bit
+    return {hash[0], hash[1] | 1};
+  }
+
+  size_t num_words_;
+  uint32_t num_hashes_;
+  std::unique_ptr<std::atomic<uint64_t>[]> words_;
+};
+
+}  // namespace bustub
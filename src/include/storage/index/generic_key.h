@@ -12,13 +12,93 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
 
+#include "catalog/schema.h"
+#include "common/macros.h"
+#include "common/rid.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
 namespace bustub {
 
+/**
+ * Write `value` into `dst` as `size` big-endian bytes, so that memcmp orders the bytes like unsigned integers.
+ */
+inline void EncodeBigEndian(uint64_t value, size_t size, char *dst) {
+  for (size_t i = 0; i < size; i++) {
+    dst[i] = static_cast<char>(value >> (8 * (size - 1 - i)));
+  }
+}
+
+/** @return the number of bytes a key column takes in the normalized (memcomparable) key format */
+inline auto NormalizedColumnSize(const Column &column) -> size_t {
+  // a varchar is a null flag followed by its bytes padded with zeros to the declared length
+  return column.GetType() == TypeId::VARCHAR ? column.GetLength() + 1 : column.GetFixedLength();
+}
+
+/** @return the number of bytes all the columns of a key schema take in the normalized key format */
+inline auto NormalizedKeySize(const Schema &key_schema) -> size_t {
+  size_t size = 0;
+  for (const auto &column : key_schema.GetColumns()) {
+    size += NormalizedColumnSize(column);
+  }
+  return size;
+}
+
+/** @return whether NormalizeValue keeps all of `value`, only a varchar longer than its column is cut off */
+inline auto FitsNormalizedColumn(const Value &value, const Column &column) -> bool {
+  return column.GetType() != TypeId::VARCHAR || value.IsNull() ||
+         strnlen(value.GetData(), value.GetLength()) <= column.GetLength();
+}
+
+/**
+ * Encode one key column so that memcmp orders the encoded bytes like the values. Integers are written big-endian
+ * with the sign bit flipped, which keeps the null sentinel (the smallest value of the type) in front. A decimal
+ * flips the sign bit of a positive value and every bit of a negative one. A varchar longer than the declared length
+ * of its column is cut off, see FitsNormalizedColumn.
+ * @return the number of bytes written, see NormalizedColumnSize
+ */
+inline auto NormalizeValue(const Value &value, const Column &column, char *dst) -> size_t {
+  switch (column.GetType()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      EncodeBigEndian(static_cast<uint8_t>(value.GetAs<int8_t>()) ^ 0x80U, 1, dst);
+      return 1;
+    case TypeId::SMALLINT:
+      EncodeBigEndian(static_cast<uint16_t>(value.GetAs<int16_t>()) ^ 0x8000U, 2, dst);
+      return 2;
+    case TypeId::INTEGER:
+      EncodeBigEndian(static_cast<uint32_t>(value.GetAs<int32_t>()) ^ 0x80000000U, 4, dst);
+      return 4;
+    case TypeId::BIGINT:
+      EncodeBigEndian(static_cast<uint64_t>(value.GetAs<int64_t>()) ^ (1ULL << 63), 8, dst);
+      return 8;
+    case TypeId::TIMESTAMP:
+      EncodeBigEndian(value.GetAs<uint64_t>(), 8, dst);
+      return 8;
+    case TypeId::DECIMAL: {
+      double decimal = value.GetAs<double>();
+      uint64_t bits;
+      memcpy(&bits, &decimal, sizeof(bits));
+      EncodeBigEndian((bits >> 63) != 0 ? ~bits : bits ^ (1ULL << 63), 8, dst);
+      return 8;
+    }
+    case TypeId::VARCHAR: {
+      size_t length = column.GetLength();
+      memset(dst, 0, length + 1);
+      if (!value.IsNull()) {
+        dst[0] = 1;
+        memcpy(dst + 1, value.GetData(), strnlen(value.GetData(), std::min<size_t>(value.GetLength(), length)));
+      }
+      return length + 1;
+    }
+    default:
+      UNREACHABLE("cannot normalize a key column of this type");
+  }
+}
+
 /**
  * Generic key is used for indexing with opaque data.
  *
@@ -35,6 +115,48 @@ class GenericKey {
     memcpy(data_, tuple.GetData(), tuple.GetLength());
   }
 
+  /**
+   * Key of a non-unique index: the key columns followed by the RID of the tuple in the last 8 bytes, which makes
+   * every entry distinct. RID(INT64_MIN) and RID(INT64_MAX) sort before and after all the real RIDs of a key.
+   */
+  inline void SetFromKey(const Tuple &tuple, RID rid) {
+    BUSTUB_ASSERT(tuple.GetLength() + RID_SUFFIX_SIZE <= KeySize, "key is too large to carry a RID suffix");
+    SetFromKey(tuple);
+    int64_t rid_suffix = rid.Get();
+    memcpy(data_ + KeySize - RID_SUFFIX_SIZE, &rid_suffix, RID_SUFFIX_SIZE);
+  }
+
+  /**
+   * Normalized (memcomparable) key, compared with memcmp by a normalized GenericComparator. The first `column_count`
+   * key columns are encoded with NormalizeValue and the rest of the key is filled with `fill`. A fill of 0x00 or 0xff
+   * gives the smallest or the largest key that starts with those columns.
+   * @return false if a varchar was cut off, the key then only holds a prefix of the value, see FitsNormalizedColumn
+   */
+  inline auto SetFromNormalizedKey(const Tuple &tuple, const Schema &key_schema, uint32_t column_count, uint8_t fill)
+      -> bool {
+    memset(data_, fill, KeySize);
+    size_t offset = 0;
+    bool fits = true;
+    for (uint32_t i = 0; i < column_count; i++) {
+      Value value = tuple.GetValue(&key_schema, i);
+      fits = fits && FitsNormalizedColumn(value, key_schema.GetColumn(i));
+      offset += NormalizeValue(value, key_schema.GetColumn(i), data_ + offset);
+    }
+    return fits;
+  }
+
+  /** RID suffix of a normalized key, encoded like a BIGINT so that memcmp orders the entries of a duplicate key */
+  inline void SetNormalizedRidSuffix(RID rid) {
+    EncodeBigEndian(static_cast<uint64_t>(rid.Get()) ^ (1ULL << 63), RID_SUFFIX_SIZE,
+                    data_ + KeySize - RID_SUFFIX_SIZE);
+  }
+
+  inline auto GetRidSuffix() const -> int64_t {
+    int64_t rid_suffix;
+    memcpy(&rid_suffix, data_ + KeySize - RID_SUFFIX_SIZE, RID_SUFFIX_SIZE);
+    return rid_suffix;
+  }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
@@ -66,6 +188,8 @@ class GenericKey {
     return os;
   }
 
+  static constexpr size_t RID_SUFFIX_SIZE = sizeof(int64_t);
+
   // actual location of data, extends past the end.
   char data_[KeySize];
 };
@@ -77,6 +201,11 @@ template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
+    if (normalized_) {
+      int cmp = memcmp(lhs.data_, rhs.data_, KeySize);
+      return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+    }
+
     uint32_t column_count = key_schema_->GetColumnCount();
 
     for (uint32_t i = 0; i < column_count; i++) {
@@ -90,17 +219,29 @@ class GenericComparator {
         return 1;
       }
     }
+    // equal key columns, entries of a non-unique index are told apart by their RID suffix
+    if (rid_suffix_) {
+      int64_t lhs_rid = lhs.GetRidSuffix();
+      int64_t rhs_rid = rhs.GetRidSuffix();
+      return lhs_rid < rhs_rid ? -1 : (lhs_rid > rhs_rid ? 1 : 0);
+    }
     // equals
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other)
+      : key_schema_{other.key_schema_}, rid_suffix_{other.rid_suffix_}, normalized_{other.normalized_} {}
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema, bool rid_suffix = false, bool normalized = false)
+      : key_schema_(key_schema), rid_suffix_(rid_suffix), normalized_(normalized) {}
 
  private:
   Schema *key_schema_;
+  /** Whether the keys carry a RID suffix, see GenericKey::SetFromKey */
+  bool rid_suffix_;
+  /** Whether the keys are normalized, see GenericKey::SetFromNormalizedKey */
+  bool normalized_;
 };
 
 }  // namespace bustub
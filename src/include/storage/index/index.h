@@ -18,6 +18,8 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
+#include "storage/index/generic_key.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -43,10 +45,21 @@ class IndexMetadata {
    * @param table_name The name of the table on which the index is created
    * @param tuple_schema The schema of the indexed key
    * @param key_attrs The mapping from indexed columns to base table columns
+   * @param is_unique Whether the index rejects a second entry with an equal key
+   * @param include_column_count The number of trailing indexed columns that a covering index only stores
+   * @param bloom_filter_bits The size of the Bloom filter over the index keys, 0 for none
+   * @param lazy_delete Whether deletes leave underfull pages to a background compaction instead of rebalancing
    */
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool is_unique = true, uint32_t include_column_count = 0,
+                size_t bloom_filter_bits = 0, bool lazy_delete = false)
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        is_unique_(is_unique),
+        include_column_count_(include_column_count),
+        bloom_filter_bits_(bloom_filter_bits),
+        lazy_delete_(lazy_delete) {
     key_schema_ = std::make_shared<Schema>(Schema::CopySchema(tuple_schema, key_attrs_));
   }
 
@@ -72,6 +85,26 @@ class IndexMetadata {
   /** @return The mapping relation between indexed columns and base table columns */
   inline auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return key_attrs_; }
 
+  /** @return Whether the index rejects duplicate keys */
+  inline auto IsUnique() const -> bool { return is_unique_; }
+
+  /**
+   * @return The number of leading indexed columns that make up the search key. The columns after them are the
+   * INCLUDE columns of a covering index, which are stored with each entry but neither ordered nor searched on.
+   */
+  inline auto GetKeyColumnCount() const -> uint32_t {
+    return static_cast<uint32_t>(key_attrs_.size()) - include_column_count_;
+  }
+
+  /** @return Whether the index stores the values of all its columns with each entry, see Index::ScanEntries */
+  inline auto IsCovering() const -> bool { return include_column_count_ > 0; }
+
+  /** @return The size in bits of the Bloom filter that lets point lookups skip missing keys, 0 if there is none */
+  inline auto GetBloomFilterBits() const -> size_t { return bloom_filter_bits_; }
+
+  /** @return Whether deletes leave underfull pages to a background compaction, see BPlusTree::Remove */
+  inline auto IsLazyDelete() const -> bool { return lazy_delete_; }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -94,6 +127,44 @@ class IndexMetadata {
   const std::vector<uint32_t> key_attrs_;
   /** The schema of the indexed key */
   std::shared_ptr<Schema> key_schema_;
+  /** Whether duplicate keys are rejected */
+  bool is_unique_;
+  /** The number of INCLUDE columns at the end of key_attrs_ */
+  uint32_t include_column_count_;
+  /** The size of the Bloom filter over the keys, 0 if the index has none */
+  size_t bloom_filter_bits_;
+  /** Whether deletes are lazy, the default rebalances the tree in every delete */
+  bool lazy_delete_;
+};
+
+/**
+ * class IndexCursor - Walks the RIDs of an ordered index scan, see Index::Scan
+ */
+class IndexCursor {
+ public:
+  virtual ~IndexCursor() = default;
+
+  /**
+   * Move to the next entry of the scan.
+   * @param[out] rid The RID of the entry
+   * @return false once the scan is exhausted
+   */
+  virtual auto Next(RID *rid) -> bool = 0;
+};
+
+/**
+ * class TupleCursor - Walks the tuples of an ordered clustered index scan, see ClusteredIndex::ScanTuples
+ */
+class TupleCursor {
+ public:
+  virtual ~TupleCursor() = default;
+
+  /**
+   * Move to the next tuple of the scan.
+   * @param[out] tuple The tuple
+   * @return false once the scan is exhausted
+   */
+  virtual auto Next(Tuple *tuple) -> bool = 0;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -139,6 +210,21 @@ class Index {
   /** @return The index key attributes */
   auto GetKeyAttrs() const -> const std::vector<uint32_t> & { return metadata_->GetKeyAttrs(); }
 
+  /**
+   * Index keys keep a varchar padded to the declared length of its column, see NormalizeValue. A longer one cannot
+   * be stored, and as a lookup key it matches no entry.
+   * @return Whether no varchar of `key` is longer than its column
+   */
+  auto KeyFits(const Tuple &key) const -> bool {
+    const auto *key_schema = GetKeySchema();
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      if (!FitsNormalizedColumn(key.GetValue(key_schema, i), key_schema->GetColumn(i))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   /** @return A string representation for debugging */
   auto ToString() const -> std::string {
     std::stringstream os;
@@ -176,9 +262,118 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  ///////////////////////////////////////////////////////////////////
+  // Batch Operations
+  ///////////////////////////////////////////////////////////////////
+
+  /**
+   * Insert a batch of entries into the index, keys[i] maps to rids[i].
+   * The default implementation inserts the entries one at a time.
+   * @param keys The index keys
+   * @param rids The RIDs associated with the keys
+   * @param transaction The transaction context
+   * @returns whether every insertion is successful
+   */
+  virtual auto InsertEntries(const std::vector<Tuple> &keys, const std::vector<RID> &rids, Transaction *transaction)
+      -> bool {
+    bool inserted = true;
+    for (size_t i = 0; i < keys.size(); i++) {
+      inserted = InsertEntry(keys[i], rids[i], transaction) && inserted;
+    }
+    return inserted;
+  }
+
+  /**
+   * Search the index for a batch of keys.
+   * The default implementation searches the keys one at a time.
+   * @param keys The index keys
+   * @param results results[i] is populated with the RIDs that match keys[i]
+   * @param transaction The transaction context
+   */
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                        Transaction *transaction) {
+    results->assign(keys.size(), std::vector<RID>{});
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*results)[i], transaction);
+    }
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Ordered Scan
+  ///////////////////////////////////////////////////////////////////
+
+  /**
+   * Scan the index in key order. The bounds are index keys, but only their leading column takes part in the
+   * comparison, the other key columns of a bound are ignored.
+   * @param lo The lower bound key, nullptr if the range has no lower bound
+   * @param lo_inclusive Whether a key equal to `lo` is part of the range
+   * @param hi The upper bound key, nullptr if the range has no upper bound
+   * @param hi_inclusive Whether a key equal to `hi` is part of the range
+   * @param reverse Whether to walk the range from the largest key to the smallest one
+   * @return A cursor over the RIDs in range
+   */
+  virtual auto Scan(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive, bool reverse)
+      -> std::unique_ptr<IndexCursor> {
+    throw NotImplementedException("index does not support ordered scans");
+  }
+
+  /**
+   * Index-only scan of a covering index. Works like Scan, but returns the stored entries instead of RIDs.
+   * @return A cursor over the entries in range, each one a tuple in the key schema of the index
+   */
+  virtual auto ScanEntries(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive, bool reverse)
+      -> std::unique_ptr<TupleCursor> {
+    throw NotImplementedException("index does not support index-only scans");
+  }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
 };
 
+/**
+ * class ClusteredIndex - The primary key index of an index-organized table
+ *
+ * A clustered index stores whole tuples keyed by their primary key instead of RIDs, and the table has no table heap.
+ * Keys passed to it are key tuples built with Tuple::KeyFromTuple, like for any other index. There are no RIDs to
+ * hand out, so the RID-based entry points only support deleting by key.
+ */
+class ClusteredIndex : public Index {
+ public:
+  explicit ClusteredIndex(std::unique_ptr<IndexMetadata> &&metadata) : Index(std::move(metadata)) {}
+
+  /**
+   * Insert a tuple of the table.
+   * @param key The primary key of the tuple
+   * @param tuple The tuple, in the table schema
+   * @param transaction The transaction context
+   * @return false if a tuple with the same primary key exists
+   */
+  virtual auto InsertTuple(const Tuple &key, const Tuple &tuple, Transaction *transaction) -> bool = 0;
+
+  /**
+   * Look up the tuple with a primary key.
+   * @param key The primary key
+   * @param[out] tuple The tuple, in the table schema
+   * @param transaction The transaction context
+   * @return false if there is no such tuple
+   */
+  virtual auto GetTuple(const Tuple &key, Tuple *tuple, Transaction *transaction) -> bool = 0;
+
+  /**
+   * Scan the tuples in primary key order, the bounds work like the ones of Index::Scan.
+   * @return A cursor over the tuples in range
+   */
+  virtual auto ScanTuples(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive, bool reverse)
+      -> std::unique_ptr<TupleCursor> = 0;
+
+  auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool override {
+    throw NotImplementedException("a clustered index stores tuples, not RIDs");
+  }
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override {
+    throw NotImplementedException("a clustered index stores tuples, not RIDs");
+  }
+};
+
 }  // namespace bustub
@@ -13,12 +13,24 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <utility>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * The iterator keeps the leaf page it points into pinned and read latched, so stepping
+ * within a leaf never goes through the buffer pool. The latch moves to the next leaf
+ * page only when the current one is exhausted, and is released once the iterator
+ * reaches the end or is destroyed. The iterator is move-only for that reason.
+ *
+ * A reverse iterator walks the leaf chain backward through the prev page links, and
+ * operator++ then moves to the next smaller key.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
@@ -27,8 +39,20 @@ class IndexIterator {
   IndexIterator();
   ~IndexIterator();  // NOLINT
 
-  IndexIterator(BufferPoolManager *buffer_pool_manager, page_id_t page_id, int index, MappingType &entry);
-  IndexIterator(BufferPoolManager *buffer_pool_manager, page_id_t page_id, int index);
+  IndexIterator(BufferPoolManager *buffer_pool_manager, ReadPageGuard guard, int index, bool reverse = false);
+
+  /**
+   * Construct an iterator that stops once it moves past `end_key`.
+   * @param end_key the upper bound of the scan, or the lower bound of a reverse scan
+   * @param end_inclusive whether an entry equal to `end_key` is still returned
+   * @param comparator the comparator of the tree, must outlive the iterator
+   * @param reverse whether the iterator moves toward smaller keys
+   */
+  IndexIterator(BufferPoolManager *buffer_pool_manager, ReadPageGuard guard, int index, const KeyType &end_key,
+                bool end_inclusive, const KeyComparator *comparator, bool reverse = false);
+
+  IndexIterator(IndexIterator &&that) noexcept = default;
+  auto operator=(IndexIterator &&that) noexcept -> IndexIterator & = default;
 
   auto IsEnd() -> bool;
 
@@ -42,11 +66,22 @@ class IndexIterator {
 
  private:
   // add your own private member variables here
-  BufferPoolManager *bpm_;
-  page_id_t cur_page_id_;
-  int index_;
-  MappingType entry_;
-  // KeyComparator comparator_;
+  BufferPoolManager *bpm_{nullptr};
+  /** Latch on the current leaf page, empty once the iterator reaches the end */
+  ReadPageGuard guard_;
+  const LeafPage *leaf_{nullptr};
+  page_id_t cur_page_id_{INVALID_PAGE_ID};
+  int index_{-1};
+  bool reverse_{false};
+
+  // upper bound of a range scan
+  bool has_end_key_{false};
+  KeyType end_key_;
+  bool end_inclusive_{true};
+  const KeyComparator *comparator_{nullptr};
+
+  auto PastEndKey() const -> bool;
+  void MoveToEnd();
 };
 
 }  // namespace bustub
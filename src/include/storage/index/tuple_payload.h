@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_payload.h
+//
+// Identification: src/include/storage/index/tuple_payload.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * @return the number of bytes the largest tuple of `schema` takes once serialized, see Tuple::SerializeTo. Every
+ * varchar is assumed to be as long as its declared length.
+ */
+inline auto MaxSerializedTupleSize(const Schema &schema) -> size_t {
+  size_t size = sizeof(uint32_t) + schema.GetLength();
+  for (auto col_idx : schema.GetUnlinedColumns()) {
+    // the length prefix, the bytes and the terminating zero of the string
+    size += sizeof(uint32_t) + schema.GetColumn(col_idx).GetLength() + 1;
+  }
+  return size;
+}
+
+/**
+ * A whole tuple stored as the value of a B+ tree entry, which is how a clustered index keeps the rows of an
+ * index-organized table in its leaf pages. The tuple is kept in its serialized form, so a short row leaves the tail
+ * of the payload unused.
+ */
+template <size_t PayloadSize>
+class TuplePayload {
+ public:
+  inline void SetFromTuple(const Tuple &tuple) {
+    if (sizeof(uint32_t) + tuple.GetLength() > PayloadSize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "tuple is too large for the clustered index");
+    }
+    tuple.SerializeTo(data_);
+  }
+
+  inline auto ToTuple() const -> Tuple {
+    Tuple tuple;
+    tuple.DeserializeFrom(data_);
+    return tuple;
+  }
+
+  char data_[PayloadSize];
+};
+
+/**
+ * The value of a covering index entry. Next to the RID of the row it keeps the values of all indexed columns,
+ * serialized as a tuple of the key schema, so an index-only scan never has to visit the table heap.
+ */
+template <size_t PayloadSize>
+class CoveringPayload {
+ public:
+  inline auto ToTuple() const -> Tuple { return columns_.ToTuple(); }
+
+  RID rid_;
+  TuplePayload<PayloadSize> columns_;
+};
+
+/** @return the RID an index entry points to */
+inline auto IndexEntryRid(const RID &value) -> RID { return value; }
+
+template <size_t PayloadSize>
+inline auto IndexEntryRid(const CoveringPayload<PayloadSize> &value) -> RID {
+  return value.rid_;
+}
+
+}  // namespace bustub
@@ -19,7 +19,7 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 16
+#define LEAF_PAGE_HEADER_SIZE 24
 #define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
 
 /**
@@ -32,13 +32,13 @@ namespace bustub {
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 16 bytes in total):
+ *  Header format (size in byte, 24 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * |  NextPageId (4)
- *  -----------------------------------------------
+ *  -----------------------------------------------------------
+ * |  NextPageId (4) | ParentPageId (4) | PrevPageId (4)
+ *  -----------------------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -57,12 +57,16 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
+  auto GetPrevPageId() const -> page_id_t;
+  void SetPrevPageId(page_id_t prev_page_id);
   auto KeyAt(int index) const -> KeyType;
   auto ValueAt(int index) const -> ValueType;
+  auto EntryAt(int index) const -> const MappingType &;
   void SetKeyValueAt(int index, const KeyType &key, const ValueType &value);
 
   auto FindValue(const KeyType &key, ValueType &value, const KeyComparator &comparator, int *index = nullptr) const
       -> bool;
+  auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
   auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> bool;
   auto Delete(const KeyType &key, const KeyComparator &comparator) -> bool;
   void CopyHalfFrom(MappingType *array, int min_size, int size);
@@ -102,6 +106,7 @@ class BPlusTreeLeafPage : public BPlusTreePage {
  private:
   page_id_t next_page_id_;
   page_id_t parent_page_id_;
+  page_id_t prev_page_id_;
   // Flexible array member for page data.
   MappingType array_[0];
 };
@@ -12,7 +12,7 @@
 
 #pragma once
 
-#include <atomic>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -32,6 +32,9 @@ namespace bustub {
  *
  *  Here '+' means concatenation.
  *
+ * The occupied and readable flags are bitmaps in front of the pairs. A slot is occupied once a pair was written to it,
+ * and stays occupied as a tombstone after the pair is removed, so that probe sequences running through it are not
+ * cut short. Callers latch the block page: the read latch to look at slots, the write latch to change them.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBlockPage {
@@ -57,16 +60,13 @@ class HashTableBlockPage {
 
   /**
    * Attempts to insert a key and value into an index in the block.
-   * The insert is thread safe. It uses compare and swap to claim the index,
-   * and then writes the key and value into the index, and then marks the
-   * index as readable.
+   * Writes the key and value into the index and marks the index as occupied and readable.
    *
    * @param bucket_ind index to write the key and value to
    * @param key key to insert
    * @param value value to insert
    * @return If the value is inserted successfully, it returns true. If the
-   * index is marked as occupied before the key and value can be inserted,
-   * Insert returns false.
+   * index is already occupied, Insert returns false.
    */
   auto Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) -> bool;
 
@@ -94,29 +94,21 @@ class HashTableBlockPage {
   auto IsReadable(slot_offset_t bucket_ind) const -> bool;
 
   /**
-   * Scan the bucket and collect values that have the matching key
+   * Finds the first index at or after bucket_ind that is not occupied. The bitmap is scanned a word at a time.
    *
-   * @return true if at least one key matched
+   * @param bucket_ind index to start from
+   * @return the first free index, or BLOCK_ARRAY_SIZE if every index from bucket_ind on is occupied
    */
-  auto GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool;
+  auto NextUnoccupied(slot_offset_t bucket_ind) const -> slot_offset_t;
 
   /**
-   * Attempts to insert a key and value in the bucket.
-   * The insert is thread safe. It uses compare and swap to claim the index,
-   * and then writes the key and value into the index, and then marks the
-   * index as readable.
+   * Finds the first index at or after bucket_ind that holds a readable key/value pair. The bitmap is scanned a word
+   * at a time.
    *
-   * @param key key to insert
-   * @param value value to insert
-   * @return true if inserted, false if duplicate KV pair or bucket is full
-   */
-  auto Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool;
-
-  /**
-   * Removes a key and value.
-   * @return true if removed, false if not found
+   * @param bucket_ind index to start from
+   * @return the first readable index, or BLOCK_ARRAY_SIZE if there is none from bucket_ind on
    */
-  auto Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool;
+  auto NextReadable(slot_offset_t bucket_ind) const -> slot_offset_t;
 
   /**
    * @return the number of readable elements, i.e. current size
@@ -139,10 +131,13 @@ class HashTableBlockPage {
   void PrintBucket();
 
  private:
-  std::atomic_char occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
+  /** First index at or after bucket_ind whose bit in `bitmap` equals `bit` */
+  static auto NextBit(const uint8_t *bitmap, slot_offset_t bucket_ind, bool bit) -> slot_offset_t;
+
+  uint8_t occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
 
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
-  std::atomic_char readable_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
+  uint8_t readable_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
   // Flexible array member for page data.
   MappingType array_[1];
 };
@@ -33,6 +33,8 @@ namespace bustub {
  *  The above format omits the space required for the occupied_ and
  *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
  *
+ *  A bucket that cannot be split any further continues in a chain of
+ *  overflow pages, which are bucket pages as well.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBucketPage {
@@ -40,12 +42,29 @@ class HashTableBucketPage {
   // Delete all constructor / destructor to ensure memory safety
   HashTableBucketPage() = delete;
 
+  /**
+   * Reset the page to an empty bucket without an overflow page.
+   */
+  void Init();
+
+  /**
+   * @return the page id of the next page in the overflow chain of the bucket, INVALID_PAGE_ID at the end of it
+   */
+  auto GetOverflowPageId() const -> page_id_t;
+
+  /**
+   * Link the next page of the overflow chain.
+   *
+   * @param overflow_page_id the page id of an empty bucket page
+   */
+  void SetOverflowPageId(page_id_t overflow_page_id);
+
   /**
    * Scan the bucket and collect values that have the matching key
    *
    * @return true if at least one key matched
    */
-  auto GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool;
+  auto GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) const -> bool;
 
   /**
    * Attempts to insert a key and value in the bucket.  Uses the occupied_
@@ -138,6 +157,8 @@ class HashTableBucketPage {
   void PrintBucket();
 
  private:
+  // The next page of the overflow chain, INVALID_PAGE_ID if there is none.
+  page_id_t overflow_page_id_;
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
@@ -6,10 +6,6 @@
 
 namespace bustub {
 
-// To pass the test cases for this class, you must follow the existing TmpTuplePage format and implement the
-// existing functions exactly as they are! It may be helpful to look at TablePage.
-// Remember that this task is optional, you get full credit if you finish the next task.
-
 /**
  * TmpTuplePage format:
  *
@@ -17,20 +13,58 @@ namespace bustub {
  * | PageId (4) | LSN (4) | FreeSpace (4) | (free space) | TupleSize2 | TupleData2 | TupleSize1 | TupleData1 |
  *
  * We choose this format because DeserializeExpression expects to read Size followed by Data.
+ * FreeSpace is the offset of the last tuple inserted, tuples are filled in from the end of the page.
  */
 class TmpTuplePage : public Page {
  public:
   void Init(page_id_t page_id, uint32_t page_size) {
     memcpy(GetData(), &page_id, sizeof(page_id_t));
-    memcpy(GetData() + sizeof(page_id_t), &page_size, sizeof(uint32_t));
+    SetFreeSpacePointer(page_size);
   }
 
-  auto GetTablePageId() -> page_id_t { return INVALID_PAGE_ID; }
+  auto GetTablePageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /**
+   * Insert a tuple at the end of the free space.
+   * @param tuple the tuple to insert
+   * @param[out] out where the tuple was stored
+   * @return false if the tuple does not fit in the free space
+   */
+  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool {
+    auto size = sizeof(uint32_t) + tuple.GetLength();
+    auto free_space_pointer = GetFreeSpacePointer();
+    if (free_space_pointer < SIZE_TMP_PAGE_HEADER + size) {
+      return false;
+    }
+    free_space_pointer -= size;
+    tuple.SerializeTo(GetData() + free_space_pointer);
+    SetFreeSpacePointer(free_space_pointer);
+    *out = TmpTuple(GetTablePageId(), free_space_pointer);
+    return true;
+  }
 
-  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool { return false; }
+  /** @return the offset of the last tuple inserted, reading on from there visits every tuple up to the page end */
+  auto GetFreeSpacePointer() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+
+  /**
+   * Read the tuple stored at `offset`.
+   * @param offset the offset of the tuple, e.g. from TmpTuple::GetOffset()
+   * @param[out] tuple the tuple
+   * @return the offset of the tuple stored next to it, the page size after the first tuple inserted
+   */
+  auto Get(size_t offset, Tuple *tuple) -> size_t {
+    tuple->DeserializeFrom(GetData() + offset);
+    return offset + sizeof(uint32_t) + tuple->GetLength();
+  }
 
  private:
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
+
   static_assert(sizeof(page_id_t) == 4);
+  static constexpr size_t OFFSET_FREE_SPACE = SIZE_PAGE_HEADER;
+  static constexpr size_t SIZE_TMP_PAGE_HEADER = SIZE_PAGE_HEADER + sizeof(uint32_t);
 };
 
 }  // namespace bustub
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_dispenser.h
+//
+// Identification: src/include/storage/table/morsel_dispenser.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/**
+ * MorselDispenser hands out the pages of a table heap in morsels, runs of consecutive pages of the page chain. Every
+ * scan sharing a dispenser claims a morsel, scans it and comes back for the next one, so each page is scanned exactly
+ * once and faster scans simply claim more morsels.
+ */
+class MorselDispenser {
+ public:
+  /**
+   * @param bpm the buffer pool manager of the table
+   * @param table_heap the table to hand out
+   * @param morsel_size the number of pages in a morsel
+   */
+  MorselDispenser(BufferPoolManager *bpm, TableHeap *table_heap, size_t morsel_size = MORSEL_SIZE);
+
+  /**
+   * Start over from the first page. As with TableHeap::MakeIterator, the end of the table is fixed here: tuples
+   * appended afterwards are not handed out.
+   */
+  void Reset();
+
+  /**
+   * Claim the next morsel.
+   * @param[out] page_ids the pages of the morsel, in the order of the page chain
+   * @return false once the whole table has been handed out
+   */
+  auto Next(std::vector<page_id_t> *page_ids) -> bool;
+
+  /** @return the number of slots of `page_id` to scan, given the number of tuples it holds now */
+  auto GetNumSlots(page_id_t page_id, uint32_t num_tuples) const -> uint32_t {
+    return page_id == stop_at_rid_.GetPageId() ? std::min(num_tuples, stop_at_rid_.GetSlotNum()) : num_tuples;
+  }
+
+  /** @return true if the table has a single page, which is not worth scanning in parallel */
+  auto IsSinglePage() const -> bool { return table_heap_->GetFirstPageId() == stop_at_rid_.GetPageId(); }
+
+ private:
+  BufferPoolManager *bpm_;
+  TableHeap *table_heap_;
+  size_t morsel_size_;
+
+  std::mutex latch_;
+  /** The first page of the next morsel, INVALID_PAGE_ID once the table has been handed out */
+  page_id_t next_page_id_{INVALID_PAGE_ID}; /* protected by latch_ */
+  /** The last page of the table and its number of tuples, as of the last Reset() */
+  RID stop_at_rid_;
+};
+
+}  // namespace bustub
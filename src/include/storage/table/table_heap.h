@@ -84,6 +84,9 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /** @return the id of the last page of this table, pages appended later are linked after it */
+  auto GetLastPageId() -> page_id_t;
+
   /**
    * Update a tuple in place. SHOULD NOT BE USED UNLESS YOU WANT TO OPTIMIZE FOR PROJECT 4.
    * @param meta new tuple meta
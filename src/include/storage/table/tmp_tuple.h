@@ -4,8 +4,9 @@
 
 namespace bustub {
 
-// Document this class! What does it represent?
-
+/**
+ * TmpTuple is the location of a tuple stored in a TmpTuplePage: the id of the page and the offset of the tuple in it.
+ */
 class TmpTuple {
  public:
   TmpTuple(page_id_t page_id, size_t offset) : page_id_(page_id), offset_(offset) {}
@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_file.h
+//
+// Identification: src/include/storage/table/tmp_tuple_file.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tuple.h"
+#include "storage/table/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * TmpTupleFile is a temporary file of tuples kept in TmpTuplePages of the buffer pool, e.g. a partition an operator
+ * spills when its input does not fit in memory. Tuples are appended first and read back afterwards, in the order they
+ * were appended. Only the page being filled stays pinned, and the pages are deleted with the file.
+ */
+class TmpTupleFile {
+ public:
+  explicit TmpTupleFile(BufferPoolManager *bpm) : bpm_(bpm) {}
+  ~TmpTupleFile();
+
+  DISALLOW_COPY_AND_MOVE(TmpTupleFile);
+
+  /** Append a tuple to the file */
+  void Append(const Tuple &tuple);
+
+  /** Stop appending, which unpins the page being filled */
+  void Finish();
+
+  /**
+   * Read the tuples of the next pages into `batch` until it is full, a batch of capacity 1 reads a single page.
+   * Reading starts over after Rewind().
+   * @param[out] batch the batch, reset to `schema` first
+   * @return false if every page has been read
+   */
+  auto ReadBatch(TupleBatch *batch, const Schema *schema) -> bool;
+
+  /** Read the file again from the first page */
+  void Rewind() { read_page_idx_ = 0; }
+
+  /** @return the number of tuples in the file */
+  auto NumTuples() const -> size_t { return num_tuples_; }
+
+  /** @return the number of bytes the tuples take in the pages, size fields included */
+  auto GetSize() const -> size_t { return size_; }
+
+ private:
+  BufferPoolManager *bpm_;
+  std::vector<page_id_t> page_ids_;
+  /** The page being filled, pinned until Finish() */
+  TmpTuplePage *write_page_{nullptr};
+  size_t read_page_idx_{0};
+  /** ReadBatch(): the offsets of the tuples of the page being read */
+  std::vector<size_t> offsets_;
+  size_t num_tuples_{0};
+  size_t size_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/storage/table/tuple_batch.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * A batch of tuples stored column by column: one vector of values per column of the schema, plus the RID of every
+ * row. Executors pass batches up the plan through AbstractExecutor::NextBatch, and expressions evaluate a whole
+ * column of a batch at once, so the virtual calls of the tuple-at-a-time interface are paid once per batch.
+ */
+class TupleBatch {
+ public:
+  /** @param capacity The number of rows after which the batch counts as full */
+  explicit TupleBatch(size_t capacity = TUPLE_BATCH_SIZE) : capacity_(capacity) {}
+
+  /** Drop every row and take the columns of `schema`, which must outlive the rows of the batch */
+  void Reset(const Schema *schema);
+
+  /** Append a row, splitting the tuple into the columns of the schema */
+  void AppendTuple(const Tuple &tuple, RID rid);
+
+  /** Append a row given as one value per column */
+  void AppendRow(const std::vector<Value> &values, RID rid = RID{});
+
+  /** Replace every column at once, e.g. by the values of projected expressions, one vector per column */
+  void SetColumns(std::vector<std::vector<Value>> columns, size_t num_rows);
+
+  /** Keep only the rows listed in `sel`, which must be in ascending order */
+  void Select(const std::vector<uint32_t> &sel);
+
+  /** @return the row at `row` serialized as a tuple of the schema */
+  auto GetTuple(size_t row) const -> Tuple;
+
+  /** @return the length of the tuple GetTuple(row) would return, without serializing it */
+  auto GetTupleSize(size_t row) const -> uint32_t;
+
+  /** Write the data of the tuple GetTuple(row) would return to `storage`, which holds GetTupleSize(row) bytes */
+  void SerializeTuple(size_t row, char *storage) const;
+
+  auto GetValue(size_t row, uint32_t col_idx) const -> const Value & { return columns_[col_idx][row]; }
+  auto GetColumn(uint32_t col_idx) const -> const std::vector<Value> & { return columns_[col_idx]; }
+  auto GetRID(size_t row) const -> RID { return rids_[row]; }
+  auto GetSchema() const -> const Schema * { return schema_; }
+
+  auto NumRows() const -> size_t { return num_rows_; }
+  auto IsEmpty() const -> bool { return num_rows_ == 0; }
+  auto IsFull() const -> bool { return num_rows_ >= capacity_; }
+
+ private:
+  const Schema *schema_{nullptr};
+  size_t capacity_;
+  size_t num_rows_{0};
+  std::vector<std::vector<Value>> columns_;
+  std::vector<RID> rids_;
+};
+
+}  // namespace bustub
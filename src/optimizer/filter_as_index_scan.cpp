@@ -0,0 +1,248 @@
+#include <memory>
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** The tightest range on one column implied by the conjuncts of a filter predicate. */
+struct ColumnRange {
+  AbstractExpressionRef lower_;
+  bool lower_inclusive_{true};
+  AbstractExpressionRef upper_;
+  bool upper_inclusive_{true};
+};
+
+void CollectConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts) {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get());
+      logic_expr != nullptr && logic_expr->logic_type_ == LogicType::And) {
+    CollectConjuncts(logic_expr->GetChildAt(0), conjuncts);
+    CollectConjuncts(logic_expr->GetChildAt(1), conjuncts);
+    return;
+  }
+  conjuncts->push_back(expr);
+}
+
+/** `col < c` is the same as `c > col`, flip the comparison so that the column is always on the left side */
+auto FlipComparison(ComparisonType comp_type) -> ComparisonType {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+void TightenLower(ColumnRange *range, const AbstractExpressionRef &bound, bool inclusive) {
+  if (range->lower_ != nullptr) {
+    const auto &cur = dynamic_cast<const ConstantValueExpression &>(*range->lower_).val_;
+    const auto &val = dynamic_cast<const ConstantValueExpression &>(*bound).val_;
+    if (val.CompareLessThan(cur) == CmpBool::CmpTrue ||
+        (val.CompareEquals(cur) == CmpBool::CmpTrue && (inclusive || !range->lower_inclusive_))) {
+      return;
+    }
+  }
+  range->lower_ = bound;
+  range->lower_inclusive_ = inclusive;
+}
+
+void TightenUpper(ColumnRange *range, const AbstractExpressionRef &bound, bool inclusive) {
+  if (range->upper_ != nullptr) {
+    const auto &cur = dynamic_cast<const ConstantValueExpression &>(*range->upper_).val_;
+    const auto &val = dynamic_cast<const ConstantValueExpression &>(*bound).val_;
+    if (val.CompareGreaterThan(cur) == CmpBool::CmpTrue ||
+        (val.CompareEquals(cur) == CmpBool::CmpTrue && (inclusive || !range->upper_inclusive_))) {
+      return;
+    }
+  }
+  range->upper_ = bound;
+  range->upper_inclusive_ = inclusive;
+}
+
+/**
+ * Match a `<column> <op> <constant>` conjunct on column `col_idx`, in either order.
+ * @param[out] comp_type the comparison, flipped if needed so that the column is on the left side
+ * @return the constant, or nullptr if the conjunct is not such a comparison
+ */
+auto MatchColumnComparison(const AbstractExpressionRef &conjunct, uint32_t col_idx, TypeId col_type,
+                           ComparisonType *comp_type) -> AbstractExpressionRef {
+  const auto *comp_expr = dynamic_cast<const ComparisonExpression *>(conjunct.get());
+  if (comp_expr == nullptr) {
+    return nullptr;
+  }
+
+  *comp_type = comp_expr->comp_type_;
+  const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(comp_expr->GetChildAt(0).get());
+  AbstractExpressionRef bound = comp_expr->GetChildAt(1);
+  if (column_expr == nullptr) {
+    column_expr = dynamic_cast<const ColumnValueExpression *>(comp_expr->GetChildAt(1).get());
+    bound = comp_expr->GetChildAt(0);
+    *comp_type = FlipComparison(*comp_type);
+  }
+  if (column_expr == nullptr || column_expr->GetTupleIdx() != 0 || column_expr->GetColIdx() != col_idx) {
+    return nullptr;
+  }
+
+  // the bound is written into the index key directly, so it must have exactly the type of the key column
+  const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(bound.get());
+  if (constant_expr == nullptr || constant_expr->val_.IsNull() || constant_expr->GetReturnType() != col_type) {
+    return nullptr;
+  }
+  return bound;
+}
+
+/**
+ * Narrow `range` with a `<column> <op> <constant>` conjunct on column `col_idx`.
+ * @return false if the conjunct says nothing about the range of the column
+ */
+auto ApplyConjunct(const AbstractExpressionRef &conjunct, uint32_t col_idx, TypeId col_type, ColumnRange *range)
+    -> bool {
+  ComparisonType comp_type;
+  auto bound = MatchColumnComparison(conjunct, col_idx, col_type, &comp_type);
+  if (bound == nullptr) {
+    return false;
+  }
+
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      TightenLower(range, bound, true);
+      TightenUpper(range, bound, true);
+      return true;
+    case ComparisonType::GreaterThan:
+      TightenLower(range, bound, false);
+      return true;
+    case ComparisonType::GreaterThanOrEqual:
+      TightenLower(range, bound, true);
+      return true;
+    case ComparisonType::LessThan:
+      TightenUpper(range, bound, false);
+      return true;
+    case ComparisonType::LessThanOrEqual:
+      TightenUpper(range, bound, true);
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Find a `<column> = <constant>` conjunct for every key column of a hash index.
+ * @return the constants in key column order, empty if some key column is not bound to a single value
+ */
+auto MatchPointKey(const std::vector<AbstractExpressionRef> &conjuncts, const IndexInfo &index_info,
+                   const Schema &table_schema) -> std::vector<AbstractExpressionRef> {
+  std::vector<AbstractExpressionRef> point_key;
+  for (auto col_idx : index_info.index_->GetKeyAttrs()) {
+    AbstractExpressionRef value;
+    for (const auto &conjunct : conjuncts) {
+      ComparisonType comp_type;
+      auto bound = MatchColumnComparison(conjunct, col_idx, table_schema.GetColumn(col_idx).GetType(), &comp_type);
+      if (bound != nullptr && comp_type == ComparisonType::Equal) {
+        value = std::move(bound);
+        break;
+      }
+    }
+    if (value == nullptr) {
+      return {};
+    }
+    point_key.push_back(std::move(value));
+  }
+  return point_key;
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  // DML executors modify the indexes of the table they read from, never scan those indexes underneath them.
+  if (plan->GetType() == PlanType::Insert || plan->GetType() == PlanType::Update ||
+      plan->GetType() == PlanType::Delete) {
+    return plan;
+  }
+
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeFilterAsIndexScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Filter) {
+    return optimized_plan;
+  }
+  const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*optimized_plan);
+  BUSTUB_ENSURE(filter_plan.children_.size() == 1, "Filter with multiple children?? Impossible!");
+  if (filter_plan.GetChildPlan()->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*filter_plan.GetChildPlan());
+  const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
+
+  std::vector<AbstractExpressionRef> conjuncts;
+  CollectConjuncts(filter_plan.GetPredicate(), &conjuncts);
+
+  // An equality lookup in a hash index beats any range, it goes straight to the matching entries.
+  for (const auto *index_info : catalog_.GetTableIndexes(table_info->name_)) {
+    if (index_info->index_type_ != IndexType::HashTableIndex) {
+      continue;
+    }
+    auto point_key = MatchPointKey(conjuncts, *index_info, table_info->schema_);
+    if (!point_key.empty()) {
+      auto index_scan =
+          std::make_shared<IndexScanPlanNode>(seq_scan.output_schema_, index_info->index_oid_, nullptr, true, nullptr,
+                                              true, false, false, std::move(point_key));
+      return std::make_shared<FilterPlanNode>(filter_plan.output_schema_, filter_plan.GetPredicate(),
+                                              std::move(index_scan));
+    }
+  }
+
+  // Pick the index whose leading column is bounded on most sides. A closed range beats a half-open one.
+  const IndexInfo *best_index = nullptr;
+  ColumnRange best_range;
+  int best_sides = 0;
+  for (const auto *index_info : catalog_.GetTableIndexes(table_info->name_)) {
+    // a hash index keeps no key order, it cannot scan a range
+    if (index_info->index_type_ == IndexType::HashTableIndex) {
+      continue;
+    }
+    uint32_t leading_col_idx = index_info->index_->GetKeyAttrs()[0];
+    TypeId leading_col_type = table_info->schema_.GetColumn(leading_col_idx).GetType();
+
+    ColumnRange range;
+    for (const auto &conjunct : conjuncts) {
+      ApplyConjunct(conjunct, leading_col_idx, leading_col_type, &range);
+    }
+    int sides = static_cast<int>(range.lower_ != nullptr) + static_cast<int>(range.upper_ != nullptr);
+    if (sides > best_sides) {
+      best_index = index_info;
+      best_range = range;
+      best_sides = sides;
+    }
+  }
+  if (best_index == nullptr) {
+    return optimized_plan;
+  }
+
+  // The filter stays on top of the index scan to check the conjuncts that the range does not cover.
+  auto index_scan = std::make_shared<IndexScanPlanNode>(seq_scan.output_schema_, best_index->index_oid_,
+                                                        best_range.lower_, best_range.lower_inclusive_,
+                                                        best_range.upper_, best_range.upper_inclusive_);
+  return std::make_shared<FilterPlanNode>(filter_plan.output_schema_, filter_plan.GetPredicate(),
+                                          std::move(index_scan));
+}
+
+}  // namespace bustub
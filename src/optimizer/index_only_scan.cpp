@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/topn_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** Collect the columns `expr` reads from its input tuple */
+void CollectColumns(const AbstractExpressionRef &expr, std::vector<uint32_t> *col_ids) {
+  if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+      column_value_expr != nullptr) {
+    col_ids->push_back(column_value_expr->GetColIdx());
+  }
+  for (const auto &child : expr->GetChildren()) {
+    CollectColumns(child, col_ids);
+  }
+}
+
+/** Collect the columns a plan node reads from its child, only for the nodes that keep the schema of their child */
+auto CollectPassThroughColumns(const AbstractPlanNode &plan, std::vector<uint32_t> *col_ids) -> bool {
+  switch (plan.GetType()) {
+    case PlanType::Filter:
+      CollectColumns(dynamic_cast<const FilterPlanNode &>(plan).GetPredicate(), col_ids);
+      return true;
+    case PlanType::Sort:
+      for (const auto &[order_type, expr] : dynamic_cast<const SortPlanNode &>(plan).GetOrderBy()) {
+        CollectColumns(expr, col_ids);
+      }
+      return true;
+    case PlanType::TopN:
+      for (const auto &[order_type, expr] : dynamic_cast<const TopNPlanNode &>(plan).GetOrderBy()) {
+        CollectColumns(expr, col_ids);
+      }
+      return true;
+    case PlanType::Limit:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/** Rebuild the chain of pass-through nodes above `plan` with an index-only scan at its bottom */
+auto RewriteAsIndexOnly(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  if (plan->GetType() == PlanType::IndexScan) {
+    auto index_scan = std::make_shared<IndexScanPlanNode>(dynamic_cast<const IndexScanPlanNode &>(*plan));
+    index_scan->index_only_ = true;
+    return index_scan;
+  }
+  return plan->CloneWithChildren({RewriteAsIndexOnly(plan->GetChildAt(0))});
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  // A DML executor needs the RIDs of the tuples it modifies, an index-only scan has none.
+  if (plan->GetType() == PlanType::Insert || plan->GetType() == PlanType::Update ||
+      plan->GetType() == PlanType::Delete) {
+    return plan;
+  }
+
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeIndexOnlyScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  // Only a projection or an aggregation narrows the columns of its input, below them every column may be read.
+  std::vector<uint32_t> col_ids;
+  if (optimized_plan->GetType() == PlanType::Projection) {
+    for (const auto &expr : dynamic_cast<const ProjectionPlanNode &>(*optimized_plan).GetExpressions()) {
+      CollectColumns(expr, &col_ids);
+    }
+  } else if (optimized_plan->GetType() == PlanType::Aggregation) {
+    const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*optimized_plan);
+    for (const auto &expr : agg_plan.GetGroupBys()) {
+      CollectColumns(expr, &col_ids);
+    }
+    for (const auto &expr : agg_plan.GetAggregates()) {
+      CollectColumns(expr, &col_ids);
+    }
+  } else {
+    return optimized_plan;
+  }
+
+  // Walk down the filters, sorts and limits in between, they all read the columns of the scan too
+  auto child_plan = optimized_plan->GetChildAt(0);
+  while (CollectPassThroughColumns(*child_plan, &col_ids)) {
+    child_plan = child_plan->GetChildAt(0);
+  }
+  if (child_plan->GetType() != PlanType::IndexScan) {
+    return optimized_plan;
+  }
+
+  // The index must store every column read above the scan
+  const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*child_plan);
+  const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+  if (index_scan.index_only_ || !index_info->index_->GetMetadata()->IsCovering()) {
+    return optimized_plan;
+  }
+  const auto &key_attrs = index_info->index_->GetKeyAttrs();
+  for (auto col_idx : col_ids) {
+    if (std::find(key_attrs.begin(), key_attrs.end(), col_idx) == key_attrs.end()) {
+      return optimized_plan;
+    }
+  }
+
+  return RewriteAsIndexOnly(std::move(optimized_plan));
+}
+
+}  // namespace bustub
@@ -23,13 +23,19 @@ namespace bustub {
 
 auto Optimizer::MatchIndex(const std::string &table_name, uint32_t index_key_idx)
     -> std::optional<std::tuple<index_oid_t, std::string>> {
+  // Every probe of an index join is an equality lookup, a hash index answers it without descending a tree
   const auto key_attrs = std::vector{index_key_idx};
+  const IndexInfo *matched = nullptr;
   for (const auto *index_info : catalog_.GetTableIndexes(table_name)) {
-    if (key_attrs == index_info->index_->GetKeyAttrs()) {
-      return std::make_optional(std::make_tuple(index_info->index_oid_, index_info->name_));
+    if (key_attrs == index_info->index_->GetKeyAttrs() &&
+        (matched == nullptr || index_info->index_type_ == IndexType::HashTableIndex)) {
+      matched = index_info;
     }
   }
-  return std::nullopt;
+  if (matched == nullptr) {
+    return std::nullopt;
+  }
+  return std::make_optional(std::make_tuple(matched->index_oid_, matched->name_));
 }
 
 auto Optimizer::OptimizeNLJAsIndexJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
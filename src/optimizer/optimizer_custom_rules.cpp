@@ -11,9 +11,12 @@ auto Optimizer::OptimizeCustom(const AbstractPlanNodeRef &plan) -> AbstractPlanN
   auto p = plan;
   p = OptimizeMergeProjection(p);
   p = OptimizeMergeFilterNLJ(p);
+  p = OptimizeNLJAsIndexJoin(p);
   p = OptimizeNLJAsHashJoin(p);
+  p = OptimizeFilterAsIndexScan(p);
   p = OptimizeOrderByAsIndexScan(p);
   p = OptimizeSortLimitAsTopN(p);
+  p = OptimizeIndexOnlyScan(p);
   return p;
 }
 
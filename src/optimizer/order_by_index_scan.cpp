@@ -1,5 +1,8 @@
 #include <algorithm>
 #include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
 
 #include "binder/bound_order_by.h"
 #include "catalog/catalog.h"
@@ -12,71 +15,128 @@
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/index_scan_plan.h"
+#include "execution/plans/limit_plan.h"
 #include "execution/plans/nested_loop_join_plan.h"
 #include "execution/plans/projection_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/sort_plan.h"
+#include "execution/plans/topn_plan.h"
 #include "optimizer/optimizer.h"
 #include "type/type_id.h"
 
 namespace bustub {
 
+namespace {
+
+/**
+ * Find an index whose key columns are exactly the order-by columns.
+ * @return the index, or nullptr if the table has none
+ */
+auto MatchOrderByIndex(const Catalog &catalog, const TableInfo *table_info,
+                       const std::vector<uint32_t> &order_by_column_ids) -> const IndexInfo * {
+  for (const auto *index : catalog.GetTableIndexes(table_info->name_)) {
+    // a hash index returns its entries in no particular order
+    if (index->index_type_ == IndexType::HashTableIndex) {
+      continue;
+    }
+    const auto &columns = index->key_schema_.GetColumns();
+    // check index key schema == order by columns, the INCLUDE columns of a covering index are not ordered
+    if (index->index_->GetMetadata()->GetKeyColumnCount() != order_by_column_ids.size()) {
+      continue;
+    }
+    bool valid = true;
+    for (size_t i = 0; i < order_by_column_ids.size(); i++) {
+      if (columns[i].GetName() != table_info->schema_.GetColumn(order_by_column_ids[i]).GetName()) {
+        valid = false;
+        break;
+      }
+    }
+    if (valid) {
+      return index;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
 auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  // An index scan keeps its current leaf latched, so never place one below a DML executor writing that index.
+  if (plan->GetType() == PlanType::Insert || plan->GetType() == PlanType::Update ||
+      plan->GetType() == PlanType::Delete) {
+    return plan;
+  }
+
   std::vector<AbstractPlanNodeRef> children;
   for (const auto &child : plan->GetChildren()) {
     children.emplace_back(OptimizeOrderByAsIndexScan(child));
   }
   auto optimized_plan = plan->CloneWithChildren(std::move(children));
 
+  // A TopN streams its first n tuples out of the index scan, a Sort streams all of them.
+  const std::vector<std::pair<OrderByType, AbstractExpressionRef>> *order_bys = nullptr;
+  std::optional<size_t> limit;
   if (optimized_plan->GetType() == PlanType::Sort) {
-    const auto &sort_plan = dynamic_cast<const SortPlanNode &>(*optimized_plan);
-    const auto &order_bys = sort_plan.GetOrderBy();
-
-    std::vector<uint32_t> order_by_column_ids;
-    for (const auto &[order_type, expr] : order_bys) {
-      // Order type is asc or default
-      if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
-        return optimized_plan;
-      }
+    order_bys = &dynamic_cast<const SortPlanNode &>(*optimized_plan).GetOrderBy();
+  } else if (optimized_plan->GetType() == PlanType::TopN) {
+    const auto &topn_plan = dynamic_cast<const TopNPlanNode &>(*optimized_plan);
+    order_bys = &topn_plan.GetOrderBy();
+    limit = topn_plan.GetN();
+  } else {
+    return optimized_plan;
+  }
 
-      // Order expression is a column value expression
-      const auto *column_value_expr = dynamic_cast<ColumnValueExpression *>(expr.get());
-      if (column_value_expr == nullptr) {
-        return optimized_plan;
-      }
+  // All order-by keys must go the same direction, a descending order is a reverse scan of the index
+  std::vector<uint32_t> order_by_column_ids;
+  bool reverse = !order_bys->empty() && order_bys->front().first == OrderByType::DESC;
+  for (const auto &[order_type, expr] : *order_bys) {
+    if ((order_type == OrderByType::DESC) != reverse || order_type == OrderByType::INVALID) {
+      return optimized_plan;
+    }
 
-      order_by_column_ids.push_back(column_value_expr->GetColIdx());
+    // Order expression is a column value expression
+    const auto *column_value_expr = dynamic_cast<ColumnValueExpression *>(expr.get());
+    if (column_value_expr == nullptr) {
+      return optimized_plan;
     }
 
-    // Has exactly one child
-    BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Sort with multiple children?? Impossible!");
-    const auto &child_plan = optimized_plan->children_[0];
+    order_by_column_ids.push_back(column_value_expr->GetColIdx());
+  }
 
-    if (child_plan->GetType() == PlanType::SeqScan) {
-      const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
-      const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
-      const auto indices = catalog_.GetTableIndexes(table_info->name_);
+  // Has exactly one child
+  BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Sort with multiple children?? Impossible!");
+  const auto &child_plan = optimized_plan->children_[0];
 
-      for (const auto *index : indices) {
-        const auto &columns = index->key_schema_.GetColumns();
-        // check index key schema == order by columns
-        bool valid = true;
-        if (columns.size() == order_by_column_ids.size()) {
-          for (size_t i = 0; i < columns.size(); i++) {
-            if (columns[i].GetName() != table_info->schema_.GetColumn(order_by_column_ids[i]).GetName()) {
-              valid = false;
-              break;
-            }
-          }
-          if (valid) {
-            return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
-          }
-        }
-      }
+  AbstractPlanNodeRef scan_plan;
+  if (child_plan->GetType() == PlanType::SeqScan) {
+    const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
+    const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
+    const auto *index = MatchOrderByIndex(catalog_, table_info, order_by_column_ids);
+    if (index != nullptr) {
+      scan_plan = std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_, nullptr,
+                                                      true, nullptr, true, reverse);
+    }
+  } else if (child_plan->GetType() == PlanType::Filter &&
+             child_plan->GetChildAt(0)->GetType() == PlanType::IndexScan) {
+    // A range scan planned from the filter already walks the index in key order, only the direction may change
+    const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*child_plan->GetChildAt(0));
+    const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+    const auto *index =
+        MatchOrderByIndex(catalog_, catalog_.GetTable(index_info->table_name_), order_by_column_ids);
+    if (index != nullptr && index->index_oid_ == index_info->index_oid_) {
+      auto reversed_scan = std::make_shared<IndexScanPlanNode>(index_scan);
+      reversed_scan->reverse_ = reverse;
+      scan_plan = child_plan->CloneWithChildren({std::move(reversed_scan)});
     }
   }
+  if (scan_plan == nullptr) {
+    return optimized_plan;
+  }
 
-  return optimized_plan;
+  if (limit.has_value()) {
+    return std::make_shared<LimitPlanNode>(optimized_plan->output_schema_, std::move(scan_plan), limit.value());
+  }
+  return scan_plan;
 }
 
 }  // namespace bustub
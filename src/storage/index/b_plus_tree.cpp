@@ -1,23 +1,28 @@
+#include <numeric>
 #include <sstream>
 #include <string>
+#include <type_traits>
 
 #include <cmath>
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/rid.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/tuple_payload.h"
 
 namespace bustub {
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
-                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size)
+                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size,
+                          bool lazy_delete)
     : index_name_(std::move(name)),
       bpm_(buffer_pool_manager),
       comparator_(std::move(comparator)),
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size),
-      header_page_id_(header_page_id) {
+      header_page_id_(header_page_id),
+      lazy_delete_(lazy_delete) {
   // LOG_DEBUG("BPlusTree() | internal_max_size: %d; leaf_max_size: %d", internal_max_size_, leaf_max_size_);
 
   WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
@@ -25,63 +30,117 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPool
   root_page->root_page_id_ = INVALID_PAGE_ID;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() {
+  {
+    std::scoped_lock lock(compaction_latch_);
+    stop_compaction_ = true;
+  }
+  compaction_cv_.notify_all();
+  if (compaction_thread_.joinable()) {
+    compaction_thread_.join();
+  }
+}
+
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
-  ReadPageGuard header_page_gaurd = bpm_->FetchPageRead(header_page_id_);
-  auto header_page = header_page_gaurd.As<BPlusTreeHeaderPage>();
-  return header_page->root_page_id_ == INVALID_PAGE_ID;
+auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return cached_root_page_id_.load() == INVALID_PAGE_ID; }
+
+/*
+ * Read latch the root page through cached_root_page_id_ instead of the header page.
+ * Every root change bumps root_epoch_ while the old root page is still write
+ * latched, so a page that is read latched under an unchanged epoch is still the
+ * root. Otherwise try again with the new root.
+ * @return : page id of the root, INVALID_PAGE_ID means the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchRootPageRead(ReadPageGuard *guard, uint64_t *epoch) -> page_id_t {
+  while (true) {
+    uint64_t root_epoch = root_epoch_.load();
+    page_id_t root_page_id = cached_root_page_id_.load();
+    if (root_page_id == INVALID_PAGE_ID) {
+      return INVALID_PAGE_ID;
+    }
+
+    ReadPageGuard root_guard = bpm_->FetchPageRead(root_page_id);
+    if (root_epoch_.load() == root_epoch) {
+      *guard = std::move(root_guard);
+      if (epoch != nullptr) {
+        *epoch = root_epoch;
+      }
+      return root_page_id;
+    }
+  }
+}
+
+/*
+ * The header page is only written here, when the root actually changes. The caller
+ * holds the write latch of the header page and of the old root page, if any.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetRootPageId(Context &ctx, WritePageGuard &header_page_guard, page_id_t root_page_id) {
+  header_page_guard.AsMut<BPlusTreeHeaderPage>()->root_page_id_ = root_page_id;
+  ctx.root_page_id_ = root_page_id;
+  cached_root_page_id_.store(root_page_id);
+  root_epoch_.fetch_add(1);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::FindLeafPage(Context &ctx, const KeyType &key, OperationType op_type, bool optimistic,
                                   Transaction *txn, std::unordered_map<page_id_t, int> *page_id_to_index) -> bool {
   if (optimistic) {
-    ReadPageGuard header_guard = bpm_->FetchPageRead(header_page_id_);
-    auto header_page = header_guard.As<BPlusTreeHeaderPage>();
-    ctx.root_page_id_ = header_page->root_page_id_;
-
-    // b+ tree is empty
-    if (header_page->root_page_id_ == INVALID_PAGE_ID) {
-      return false;
-    }
+    while (true) {
+      ReadPageGuard guard;
+      uint64_t root_epoch;
+      ctx.root_page_id_ = FetchRootPageRead(&guard, &root_epoch);
+
+      // b+ tree is empty
+      if (ctx.root_page_id_ == INVALID_PAGE_ID) {
+        return false;
+      }
 
-    ReadPageGuard guard = bpm_->FetchPageRead(ctx.root_page_id_);
-    auto page = guard.As<BPlusTreePage>();
-    const InternalPage *internal_page = nullptr;
-    page_id_t tmp_page_id = ctx.root_page_id_;
+      auto page = guard.As<BPlusTreePage>();
+      const InternalPage *internal_page = nullptr;
+      page_id_t tmp_page_id = ctx.root_page_id_;
+      ReadPageGuard parent_guard;
+
+      while (!page->IsLeafPage()) {
+        internal_page = guard.As<InternalPage>();
+        tmp_page_id = internal_page->FindValue(key, comparator_);
+        parent_guard = std::move(guard);
+        guard = bpm_->FetchPageRead(tmp_page_id);
+        page = guard.As<BPlusTreePage>();
+      }
 
-    while (!page->IsLeafPage()) {
-      internal_page = guard.As<InternalPage>();
-      tmp_page_id = internal_page->FindValue(key, comparator_);
-      guard = bpm_->FetchPageRead(tmp_page_id);
-      page = guard.As<BPlusTreePage>();
-    }
+      if (op_type == OperationType::FIND) {
+        ctx.read_set_.emplace_back(std::move(guard));
+        return true;
+      }
 
-    if (op_type == OperationType::FIND) {
-      ctx.read_set_.emplace_back(std::move(guard));
-    } else {
+      // the parent stays latched, so the leaf cannot be split or merged away before it is latched for writing
       guard.Drop();
-      ctx.write_set_.emplace_back(bpm_->FetchPageWrite(tmp_page_id));
+      WritePageGuard leaf_guard = bpm_->FetchPageWrite(tmp_page_id);
+      // a root leaf has no parent, the epoch tells whether it is still the root
+      if (tmp_page_id != ctx.root_page_id_ || root_epoch_.load() == root_epoch) {
+        ctx.write_set_.emplace_back(std::move(leaf_guard));
+        return true;
+      }
     }
-
-    return true;
   }
 
   // pessimistic: latch crabbing
   ctx.header_page_ = bpm_->FetchPageWrite(header_page_id_);
-  auto header_page = ctx.header_page_.value().AsMut<BPlusTreeHeaderPage>();
-  ctx.root_page_id_ = header_page->root_page_id_;
+  ctx.root_page_id_ = ctx.header_page_.value().As<BPlusTreeHeaderPage>()->root_page_id_;
 
   // b+ tree is empty
-  if (header_page->root_page_id_ == INVALID_PAGE_ID) {
+  if (ctx.root_page_id_ == INVALID_PAGE_ID) {
     if (op_type == OperationType::DELETE) {
       ctx.header_page_ = std::nullopt;
       return false;
     }
-    NewLeafRootPage(ctx, &header_page->root_page_id_);
+    NewLeafRootPage(ctx, ctx.header_page_.value());
   }
 
   ctx.write_set_.emplace_back(std::move(ctx.header_page_.value()));
@@ -117,6 +176,57 @@ auto BPLUSTREE_TYPE::FindLeafPage(Context &ctx, const KeyType &key, OperationTyp
   return true;
 }
 
+/*
+ * Descend to the leaf page that holds key with read latch crabbing, and remember the
+ * smallest separator key on the way that is larger than key. Every key below that
+ * upper fence belongs to the same leaf page, an empty fence means the leaf is the
+ * rightmost one. A WritePageGuard is taken on the leaf while its parent is still
+ * latched, so the leaf cannot be split or merged away in between.
+ * @return : false means the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename LeafGuard>
+auto BPLUSTREE_TYPE::FindLeafPageWithFence(const KeyType &key, LeafGuard *leaf_guard,
+                                           std::optional<KeyType> *upper_fence) -> bool {
+  while (true) {
+    upper_fence->reset();
+    ReadPageGuard guard;
+    uint64_t root_epoch;
+    page_id_t root_page_id = FetchRootPageRead(&guard, &root_epoch);
+
+    // b+ tree is empty
+    if (root_page_id == INVALID_PAGE_ID) {
+      return false;
+    }
+
+    page_id_t page_id = root_page_id;
+    ReadPageGuard parent_guard;
+    while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+      const auto *internal_page = guard.As<InternalPage>();
+      int child_page_index = -1;
+      page_id = internal_page->FindValue(key, comparator_, &child_page_index);
+      if (child_page_index + 1 < internal_page->GetSize()) {
+        *upper_fence = internal_page->KeyAt(child_page_index + 1);
+      }
+      parent_guard = std::move(guard);
+      guard = bpm_->FetchPageRead(page_id);
+    }
+
+    if constexpr (std::is_same_v<LeafGuard, ReadPageGuard>) {
+      *leaf_guard = std::move(guard);
+      return true;
+    } else {
+      guard.Drop();
+      *leaf_guard = bpm_->FetchPageWrite(page_id);
+      // a root leaf has no parent, the epoch tells whether it is still the root
+      if (page_id != root_page_id || root_epoch_.load() == root_epoch) {
+        return true;
+      }
+      leaf_guard->Drop();
+    }
+  }
+}
+
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -153,6 +263,76 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   return false;
 }
 
+/*
+ * Point query for a batch of keys, see ScanRangeBatch
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValueBatch(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                                   Transaction *txn) {
+  std::vector<std::pair<KeyType, KeyType>> ranges;
+  ranges.reserve(keys.size());
+  for (const auto &key : keys) {
+    ranges.emplace_back(key, key);
+  }
+  ScanRangeBatch(ranges, results, txn);
+}
+
+/*
+ * Visit the ranges in the order of their lower bounds. As long as the next lower
+ * bound is still below the upper fence of the current leaf page, the search goes on
+ * from that leaf instead of descending from the root again. Only one leaf page is
+ * latched at any time.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ScanRangeBatch(const std::vector<std::pair<KeyType, KeyType>> &ranges,
+                                    std::vector<std::vector<ValueType>> *results, Transaction *txn) {
+  results->assign(ranges.size(), std::vector<ValueType>{});
+
+  std::vector<size_t> order(ranges.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this, &ranges](size_t lhs, size_t rhs) {
+    return comparator_(ranges[lhs].first, ranges[rhs].first) < 0;
+  });
+
+  ReadPageGuard guard;
+  const LeafPage *leaf_page = nullptr;
+  std::optional<KeyType> upper_fence;
+  bool fence_known = false;
+  for (size_t i : order) {
+    const auto &[lo, hi] = ranges[i];
+    if (!fence_known || (upper_fence.has_value() && comparator_(lo, *upper_fence) >= 0)) {
+      guard.Drop();
+      if (!FindLeafPageWithFence(lo, &guard, &upper_fence)) {
+        return;
+      }
+      leaf_page = guard.As<LeafPage>();
+      fence_known = true;
+    }
+
+    int index = leaf_page->KeyIndex(lo, comparator_);
+    while (true) {
+      if (index >= leaf_page->GetSize()) {
+        page_id_t next_page_id = leaf_page->GetNextPageId();
+        if (next_page_id == INVALID_PAGE_ID) {
+          break;
+        }
+        // the range runs into the next leaf page, whose fence is unknown, so the next range descends again
+        guard.Drop();
+        guard = bpm_->FetchPageRead(next_page_id);
+        leaf_page = guard.As<LeafPage>();
+        fence_known = false;
+        index = 0;
+        continue;
+      }
+      if (comparator_(leaf_page->KeyAt(index), hi) > 0) {
+        break;
+      }
+      (*results)[i].push_back(leaf_page->ValueAt(index));
+      ++index;
+    }
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetTxnId(Transaction *txn) -> size_t {
   auto thread_id = txn->GetThreadId();
@@ -177,11 +357,17 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
 
   // LOG_DEBUG("Txn %zu: Insert | key %s", GetTxnId(txn), std::to_string(key.ToString()).c_str());
 
+  // monotonically increasing keys go straight into the rightmost leaf page without descending
+  if (appending_.load() && AppendToRightmostLeaf(key, value)) {
+    return true;
+  }
+
   bool optimistic = true;
   if (FindLeafPage(ctx, key, OperationType::INSERT, optimistic, txn)) {
     WritePageGuard guard = std::move(ctx.write_set_.back());
     auto leaf_page = guard.AsMut<LeafPage>();
     if (leaf_page->IsSafe(OperationType::INSERT)) {
+      appending_.store(IsAppend(leaf_page, key));
       return leaf_page->Insert(key, value, comparator_);
     }
     ctx.write_set_.clear();
@@ -192,6 +378,8 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
 
   // leaf page is safe, just insert and return
   auto leaf_page = ctx.write_set_.back().AsMut<LeafPage>();
+  bool append = IsAppend(leaf_page, key);
+  appending_.store(append);
   if (leaf_page->IsSafe(OperationType::INSERT)) {
     bool res = leaf_page->Insert(key, value, comparator_);
     ctx.write_set_.clear();
@@ -206,13 +394,89 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   }
 
   // leaf page is one step toward full, split before insertion
+  page_id_t leaf_page_id = ctx.write_set_.back().PageId();
   page_id_t new_page_id;
   LeafPage *new_page = NewLeafPage(ctx, &new_page_id, leaf_page->GetParentPageId());
-  bool inserted = SplitLeafPage(leaf_page, new_page, key, value, new_page_id);
+  bool inserted = SplitLeafPage(leaf_page, new_page, key, value, leaf_page_id, new_page_id, append);
 
   WritePageGuard new_guard = std::move(ctx.write_set_.back());
   ctx.write_set_.pop_back();
-  InsertInParent(new_page->KeyAt(0), std::move(new_guard), ctx);
+  InsertInParent(new_page->KeyAt(0), std::move(new_guard), ctx, append);
+
+  return inserted;
+}
+
+/*
+ * An append is an insertion into the rightmost leaf page of a key larger than
+ * every key already in the tree, e.g. an auto-increment id or a timestamp
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsAppend(const LeafPage *leaf_page, const KeyType &key) const -> bool {
+  return leaf_page->GetNextPageId() == INVALID_PAGE_ID && leaf_page->GetSize() > 0 &&
+         comparator_(key, leaf_page->KeyAt(leaf_page->GetSize() - 1)) > 0;
+}
+
+/*
+ * Insert the key into the rightmost leaf page remembered in rightmost_leaf_hint_.
+ * The rightmost leaf has no upper fence, so the key belongs there as long as it is
+ * larger than the last key of the leaf. Only the leaf page is latched, so this
+ * gives up whenever the leaf would have to split.
+ * @return : false if the key is not an append or the leaf page is not safe
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::AppendToRightmostLeaf(const KeyType &key, const ValueType &value) -> bool {
+  page_id_t page_id = rightmost_leaf_hint_.load();
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+
+  WritePageGuard guard = bpm_->FetchPageWrite(page_id);
+  // the hint only moves while the rightmost leaf page is write latched, check it again under the latch
+  if (rightmost_leaf_hint_.load() != page_id) {
+    return false;
+  }
+  auto leaf_page = guard.AsMut<LeafPage>();
+  if (!IsAppend(leaf_page, key)) {
+    appending_.store(false);
+    return false;
+  }
+  if (!leaf_page->IsSafe(OperationType::INSERT)) {
+    return false;
+  }
+  return leaf_page->Insert(key, value, comparator_);
+}
+
+/*
+ * Insert the pairs in key order. The leaf page of the previous key stays write
+ * latched, and the next key goes straight into it while it is below the upper fence
+ * of that leaf and the leaf is safe. A key that needs a split, or an empty tree,
+ * falls back to the regular Insert.
+ * @return : the number of pairs that were inserted, duplicate keys are skipped
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertBatch(std::vector<std::pair<KeyType, ValueType>> entries, Transaction *txn) -> int {
+  std::stable_sort(entries.begin(), entries.end(),
+                   [this](const auto &lhs, const auto &rhs) { return comparator_(lhs.first, rhs.first) < 0; });
+
+  int inserted = 0;
+  WritePageGuard guard;
+  LeafPage *leaf_page = nullptr;
+  std::optional<KeyType> upper_fence;
+  for (const auto &[key, value] : entries) {
+    if (leaf_page == nullptr || (upper_fence.has_value() && comparator_(key, *upper_fence) >= 0)) {
+      guard.Drop();
+      leaf_page = FindLeafPageWithFence(key, &guard, &upper_fence) ? guard.AsMut<LeafPage>() : nullptr;
+    }
+
+    if (leaf_page != nullptr && leaf_page->IsSafe(OperationType::INSERT)) {
+      inserted += static_cast<int>(leaf_page->Insert(key, value, comparator_));
+      continue;
+    }
+
+    guard.Drop();
+    leaf_page = nullptr;
+    inserted += static_cast<int>(Insert(key, value, txn));
+  }
 
   return inserted;
 }
@@ -224,22 +488,20 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * ctx: keep track of the path
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::InsertInParent(const KeyType &key, WritePageGuard &&new_page_guard, Context &ctx) {
+void BPLUSTREE_TYPE::InsertInParent(const KeyType &key, WritePageGuard &&new_page_guard, Context &ctx, bool append) {
   // root_page is full, create a new root page
   page_id_t cur_page_id = ctx.write_set_.back().PageId();
   if (ctx.IsRootPage(cur_page_id)) {
-    WritePageGuard &header_page_guard = ctx.write_set_.front();
-    auto header_page = header_page_guard.AsMut<BPlusTreeHeaderPage>();
-
-    BasicPageGuard new_root_page_guard = bpm_->NewPageGuarded(&header_page->root_page_id_);
-    ctx.root_page_id_ = header_page->root_page_id_;
+    page_id_t root_page_id;
+    BasicPageGuard new_root_page_guard = bpm_->NewPageGuarded(&root_page_id);
     new_root_page_guard.Drop();
 
-    WritePageGuard new_root_guard = bpm_->FetchPageWrite(header_page->root_page_id_);
+    WritePageGuard new_root_guard = bpm_->FetchPageWrite(root_page_id);
     auto new_root_page = new_root_guard.AsMut<InternalPage>();
     new_root_page->Init(INVALID_PAGE_ID, internal_max_size_);
 
-    UpdateParentPage(ctx, key, new_root_page, std::move(new_page_guard), cur_page_id, header_page->root_page_id_);
+    UpdateParentPage(ctx, key, new_root_page, std::move(new_page_guard), cur_page_id, root_page_id);
+    SetRootPageId(ctx, ctx.write_set_.front(), root_page_id);
     ctx.write_set_.clear();
 
     return;
@@ -270,6 +532,17 @@ void BPLUSTREE_TYPE::InsertInParent(const KeyType &key, WritePageGuard &&new_pag
   int min_size = cur_page->GetMinSize();
   int cur_size = cur_page->GetSize();
 
+  // an append only ever adds children on the right, keep the current page full and move just its last child over
+  if (append) {
+    KeyType pushed_key = cur_page->KeyAt(cur_size - 1);
+    new_page->CopyHalfFrom(cur_page->GetData(), cur_size - 1, cur_size);
+    cur_page->SetSize(cur_size - 1);
+    new_page->SetSize(1);
+    new_page->Insert(key, new_page_guard.PageId(), comparator_);
+    InsertInParent(pushed_key, std::move(new_parent_page_guard), ctx, append);
+    return;
+  }
+
   KeyType pushed_key = cur_page->KeyAt(min_size);
 
   auto last_key = cur_page->KeyAt(min_size - 1);
@@ -321,12 +594,14 @@ void BPLUSTREE_TYPE::UpdateParentPage(Context &ctx, const KeyType &key, Internal
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::NewLeafRootPage(Context &ctx, page_id_t *root_page_id) {
-  BasicPageGuard root_page_guard = bpm_->NewPageGuarded(root_page_id);
-  ctx.root_page_id_ = *root_page_id;
+void BPLUSTREE_TYPE::NewLeafRootPage(Context &ctx, WritePageGuard &header_page_guard) {
+  page_id_t root_page_id;
+  BasicPageGuard root_page_guard = bpm_->NewPageGuarded(&root_page_id);
   auto page = root_page_guard.AsMut<LeafPage>();
   page->Init(INVALID_PAGE_ID, leaf_max_size_);
   root_page_guard.Drop();
+  SetRootPageId(ctx, header_page_guard, root_page_id);
+  rightmost_leaf_hint_.store(root_page_id);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -356,9 +631,19 @@ auto BPLUSTREE_TYPE::Split(LeafPage *leaf_page, LeafPage *new_page) -> KeyType {
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::SplitLeafPage(LeafPage *leaf_page, LeafPage *new_page, const KeyType &key, const ValueType &value,
-                                   page_id_t new_page_id) -> bool {
+                                   page_id_t leaf_page_id, page_id_t new_page_id, bool append) -> bool {
   int min_size = leaf_page->GetMinSize();
   int cur_size = leaf_page->GetSize();
+  bool is_rightmost = leaf_page->GetNextPageId() == INVALID_PAGE_ID;
+
+  // an append never comes back to the left page, keep it full and start the new page with the key alone
+  if (append) {
+    new_page->Insert(key, value, comparator_);
+    leaf_page->SetNextPageId(new_page_id);
+    new_page->SetPrevPageId(leaf_page_id);
+    rightmost_leaf_hint_.store(new_page_id);
+    return true;
+  }
 
   // take care of the corner case of max_size_ = 2
   KeyType min_index_key = (min_size == cur_size) ? leaf_page->KeyAt(0) : leaf_page->KeyAt(min_size);
@@ -384,6 +669,16 @@ auto BPLUSTREE_TYPE::SplitLeafPage(LeafPage *leaf_page, LeafPage *new_page, cons
 
   new_page->SetNextPageId(leaf_page->GetNextPageId());
   leaf_page->SetNextPageId(new_page_id);
+  new_page->SetPrevPageId(leaf_page_id);
+  if (new_page->GetNextPageId() != INVALID_PAGE_ID) {
+    // latching to the right while holding the split page never deadlocks: a writer only latches a left
+    // sibling while holding the parent of both pages, which this insertion still holds
+    WritePageGuard next_guard = bpm_->FetchPageWrite(new_page->GetNextPageId());
+    next_guard.AsMut<LeafPage>()->SetPrevPageId(new_page_id);
+  }
+  if (is_rightmost) {
+    rightmost_leaf_hint_.store(new_page_id);
+  }
 
   return inserted;
 }
@@ -413,6 +708,14 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
       leaf_page->Delete(key, comparator_);
       return;
     }
+    // lazy deletion: only remove the entry from the leaf page, the compaction thread rebalances it later
+    if (lazy_delete_) {
+      bool is_root = guard.PageId() == ctx.root_page_id_;
+      if (leaf_page->Delete(key, comparator_) && (!is_root || leaf_page->GetSize() == 0)) {
+        EnqueueCompaction(key);
+      }
+      return;
+    }
     ctx.write_set_.clear();
   }
 
@@ -429,23 +732,88 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::RemoveLeafEntry(Context &ctx, KeyType key, std::unordered_map<page_id_t, int> *page_id_to_index,
                                      Transaction *txn) {
+  // fail to delete (e.g. cannot find the corresponding entry)
+  if (!ctx.write_set_.back().AsMut<LeafPage>()->Delete(key, comparator_)) {
+    return;
+  }
+
+  RebalanceLeafPage(ctx, page_id_to_index);
+}
+
+/*
+ * Remember a key of an underfull leaf page. A key instead of the page id, because
+ * by the time the page is compacted it may have been merged away, while the key
+ * still leads to whichever leaf page covers it now.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::EnqueueCompaction(const KeyType &key) {
+  {
+    std::scoped_lock lock(compaction_latch_);
+    compaction_queue_.push_back(key);
+    if (!compaction_thread_.joinable()) {
+      compaction_thread_ = std::thread(&BPLUSTREE_TYPE::CompactionLoop, this);
+    }
+  }
+  compaction_cv_.notify_one();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CompactionLoop() {
+  while (true) {
+    {
+      std::unique_lock lock(compaction_latch_);
+      compaction_cv_.wait(lock, [this] { return stop_compaction_ || !compaction_queue_.empty(); });
+      if (stop_compaction_) {
+        return;
+      }
+    }
+    Compact();
+  }
+}
+
+/*
+ * Drain the compaction queue. Each queued leaf page is rebalanced with the regular
+ * pessimistic latch crabbing, off the path of the deletes that left it underfull.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Compact() {
+  std::scoped_lock run_lock(compaction_run_latch_);
+  while (true) {
+    KeyType key;
+    {
+      std::scoped_lock lock(compaction_latch_);
+      if (compaction_queue_.empty()) {
+        return;
+      }
+      key = compaction_queue_.front();
+      compaction_queue_.pop_front();
+    }
+
+    Context ctx;
+    std::unordered_map<page_id_t, int> page_id_to_index;
+    if (FindLeafPage(ctx, key, OperationType::DELETE, false, nullptr, &page_id_to_index)) {
+      RebalanceLeafPage(ctx, &page_id_to_index);
+    }
+  }
+}
+
+/*
+ * The leaf page at the back of ctx.write_set_ may have dropped below half full,
+ * merge it with a sibling or borrow an entry from it. The ancestors that could
+ * lose an entry are still write latched in ctx.write_set_.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RebalanceLeafPage(Context &ctx, std::unordered_map<page_id_t, int> *page_id_to_index) {
   WritePageGuard cur_guard = std::move(ctx.write_set_.back());
   ctx.write_set_.pop_back();
 
   page_id_t cur_leaf_page_id = cur_guard.PageId();
   auto cur_leaf_page = cur_guard.AsMut<LeafPage>();
 
-  // fail to delete (e.g. cannot find the corresponding entry)
-  if (!cur_leaf_page->Delete(key, comparator_)) {
-    return;
-  }
-
   // leaf page is the root page and it's empty, update the root_page_id_
   if (cur_leaf_page_id == ctx.root_page_id_ && cur_leaf_page->GetSize() == 0) {
-    WritePageGuard &header_page_guard = ctx.write_set_.front();
-    auto header_page = header_page_guard.AsMut<BPlusTreeHeaderPage>();
-    header_page->root_page_id_ = INVALID_PAGE_ID;
-    ctx.root_page_id_ = INVALID_PAGE_ID;
+    SetRootPageId(ctx, ctx.write_set_.front(), INVALID_PAGE_ID);
+    rightmost_leaf_hint_.store(INVALID_PAGE_ID);
     ctx.write_set_.clear();
     return;
   }
@@ -502,6 +870,17 @@ void BPLUSTREE_TYPE::RemoveLeafEntry(Context &ctx, KeyType key, std::unordered_m
   if (left_page_cur_size + right_page_cur_size < left_page->GetMaxSize()) {
     left_page->Merge(right_page->GetData(), right_page->GetSize());
     left_page->SetNextPageId(right_page->GetNextPageId());
+    if (right_page->GetNextPageId() != INVALID_PAGE_ID) {
+      WritePageGuard next_guard = bpm_->FetchPageWrite(right_page->GetNextPageId());
+      next_guard.AsMut<LeafPage>()->SetPrevPageId(is_last_entry ? sibling_page_id : cur_leaf_page_id);
+    } else {
+      // the rightmost leaf page is merged away, the left page takes over
+      rightmost_leaf_hint_.store(is_last_entry ? sibling_page_id : cur_leaf_page_id);
+    }
+    // lazy deletion can merge two empty leaf pages, which may leave an empty root behind once the parent collapses
+    if (lazy_delete_ && left_page->GetSize() == 0) {
+      EnqueueCompaction(up_key);
+    }
     RemoveInternalEntry(ctx, up_key, up_value, page_id_to_index);
     return;
   }
@@ -535,10 +914,7 @@ void BPLUSTREE_TYPE::RemoveInternalEntry(Context &ctx, KeyType key, page_id_t va
 
   // make the only child in the current root node as the new root node
   if (cur_internal_page_id == ctx.root_page_id_ && cur_internal_page->GetSize() == 1) {
-    WritePageGuard &header_page_guard = ctx.write_set_.front();
-    auto header_page = header_page_guard.AsMut<BPlusTreeHeaderPage>();
-    header_page->root_page_id_ = cur_internal_page->ValueAt(0);
-    ctx.root_page_id_ = header_page->root_page_id_;
+    SetRootPageId(ctx, ctx.write_set_.front(), cur_internal_page->ValueAt(0));
     ctx.write_set_.clear();
     return;
   }
@@ -623,62 +999,132 @@ void BPLUSTREE_TYPE::RemoveInternalEntry(Context &ctx, KeyType key, page_id_t va
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
   // LOG_DEBUG("Begin | calling iter.begin()");
+  return ScanRange(nullptr, true, nullptr, true);
+}
 
-  ReadPageGuard header_guard = bpm_->FetchPageRead(header_page_id_);
-  auto header_page = header_guard.As<BPlusTreeHeaderPage>();
-  if (header_page->root_page_id_ == INVALID_PAGE_ID) {
+/*
+ * Input parameter is low key, find the leaf page that contains the input key
+ * first, then construct index iterator positioned at the first key that is not
+ * less than the input key
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  // LOG_DEBUG("Begin | calling iter.begin(%s)", std::to_string(key.ToString()).c_str());
+  return ScanRange(&key, true, nullptr, true);
+}
+
+/*
+ * Input parameters are the bounds of a range scan. Descend once to the leaf page
+ * that holds the lower bound, then construct an index iterator that stops right
+ * after the upper bound. A nullptr bound means that side of the range is open.
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::ScanRange(const KeyType *lo, bool lo_inclusive, const KeyType *hi, bool hi_inclusive)
+    -> INDEXITERATOR_TYPE {
+  ReadPageGuard guard;
+  if (FetchRootPageRead(&guard) == INVALID_PAGE_ID) {
     return End();
   }
 
-  ReadPageGuard guard = bpm_->FetchPageRead(header_page->root_page_id_);
   auto page = guard.As<BPlusTreePage>();
   const InternalPage *internal_page = nullptr;
   while (!page->IsLeafPage()) {
     internal_page = guard.As<InternalPage>();
-    guard = bpm_->FetchPageRead(internal_page->ValueAt(0));
+    page_id_t child_page_id = lo != nullptr ? internal_page->FindValue(*lo, comparator_) : internal_page->ValueAt(0);
+    guard = bpm_->FetchPageRead(child_page_id);
     page = guard.As<BPlusTreePage>();
   }
 
   const auto *leaf_page = guard.As<LeafPage>();
-  MappingType entry = MappingType(leaf_page->KeyAt(0), leaf_page->ValueAt(0));
+  int index = 0;
+  if (lo != nullptr) {
+    index = leaf_page->KeyIndex(*lo, comparator_);
+    if (!lo_inclusive && index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), *lo) == 0) {
+      ++index;
+    }
+  }
+
+  // the lower bound is larger than every key in this leaf page, start from the next one
+  while (index >= leaf_page->GetSize()) {
+    page_id_t next_page_id = leaf_page->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      return End();
+    }
+    guard.Drop();
+    guard = bpm_->FetchPageRead(next_page_id);
+    leaf_page = guard.As<LeafPage>();
+    index = 0;
+  }
 
-  return INDEXITERATOR_TYPE(bpm_, guard.PageId(), 0, entry);
+  // the iterator takes over the latch on the leaf page
+  if (hi == nullptr) {
+    return INDEXITERATOR_TYPE(bpm_, std::move(guard), index);
+  }
+  return INDEXITERATOR_TYPE(bpm_, std::move(guard), index, *hi, hi_inclusive, &comparator_);
 }
 
 /*
- * Input parameter is low key, find the leaf page that contains the input key
- * first, then construct index iterator
+ * Input parameter is void, find the rightmost leaf page first, then construct
+ * a reverse index iterator that walks toward smaller keys
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
-  // LOG_DEBUG("Begin | calling iter.begin(%s)", std::to_string(key.ToString()).c_str());
+auto BPLUSTREE_TYPE::RBegin() -> INDEXITERATOR_TYPE { return ReverseScanRange(nullptr, true, nullptr, true); }
 
-  ReadPageGuard header_guard = bpm_->FetchPageRead(header_page_id_);
-  auto header_page = header_guard.As<BPlusTreeHeaderPage>();
-  if (header_page->root_page_id_ == INVALID_PAGE_ID) {
-    throw std::runtime_error("B+ tree is empty");
+/*
+ * Input parameters are the bounds of a range scan. Descend once to the leaf page
+ * that holds the upper bound, then construct a reverse index iterator that walks
+ * the prev page links and stops right after the lower bound. A nullptr bound
+ * means that side of the range is open.
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::ReverseScanRange(const KeyType *lo, bool lo_inclusive, const KeyType *hi, bool hi_inclusive)
+    -> INDEXITERATOR_TYPE {
+  ReadPageGuard guard;
+  if (FetchRootPageRead(&guard) == INVALID_PAGE_ID) {
+    return End();
   }
 
-  ReadPageGuard guard = bpm_->FetchPageRead(header_page->root_page_id_);
   auto page = guard.As<BPlusTreePage>();
   const InternalPage *internal_page = nullptr;
   while (!page->IsLeafPage()) {
     internal_page = guard.As<InternalPage>();
-    guard = bpm_->FetchPageRead(internal_page->FindValue(key, comparator_));
+    page_id_t child_page_id =
+        hi != nullptr ? internal_page->FindValue(*hi, comparator_) : internal_page->ValueAt(internal_page->GetSize() - 1);
+    guard = bpm_->FetchPageRead(child_page_id);
     page = guard.As<BPlusTreePage>();
   }
 
+  // position at the last key that is not beyond the upper bound
   const auto *leaf_page = guard.As<LeafPage>();
-  ValueType res;
-  int index = -1;
-  if (leaf_page->FindValue(key, res, comparator_, &index)) {
-    MappingType entry = MappingType(key, res);
-    return INDEXITERATOR_TYPE(bpm_, guard.PageId(), index, entry);
+  int index = leaf_page->GetSize() - 1;
+  if (hi != nullptr) {
+    index = leaf_page->KeyIndex(*hi, comparator_);
+    if (!(hi_inclusive && index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), *hi) == 0)) {
+      --index;
+    }
   }
 
-  // fail to find the key in the leaf page
-  return INDEXITERATOR_TYPE();
+  // the upper bound is smaller than every key in this leaf page, start from the previous one
+  while (index < 0) {
+    page_id_t prev_page_id = leaf_page->GetPrevPageId();
+    if (prev_page_id == INVALID_PAGE_ID) {
+      return End();
+    }
+    guard.Drop();
+    guard = bpm_->FetchPageRead(prev_page_id);
+    leaf_page = guard.As<LeafPage>();
+    index = leaf_page->GetSize() - 1;
+  }
+
+  // the iterator takes over the latch on the leaf page
+  if (lo == nullptr) {
+    return INDEXITERATOR_TYPE(bpm_, std::move(guard), index, true);
+  }
+  return INDEXITERATOR_TYPE(bpm_, std::move(guard), index, *lo, lo_inclusive, &comparator_, true);
 }
 
 /*
@@ -689,18 +1135,14 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
   // LOG_DEBUG("End | calling iter.end()");
-  return INDEXITERATOR_TYPE(bpm_, INVALID_PAGE_ID, -1);
+  return INDEXITERATOR_TYPE();
 }
 
 /**
  * @return Page id of the root of this tree
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
-  ReadPageGuard header_page_guard = bpm_->FetchPageRead(header_page_id_);
-  auto header_page = header_page_guard.As<BPlusTreeHeaderPage>();
-  return header_page->root_page_id_;
-}
+auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return cached_root_page_id_.load(); }
 
 /*****************************************************************************
  * UTILITIES AND DEBUG
@@ -708,19 +1150,21 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
 
 /*
  * This method is used for test only
- * Read data from file and insert one by one
+ * Read data from file and insert one by one, only trees that map keys to RIDs support it
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertFromFile(const std::string &file_name, Transaction *txn) {
-  int64_t key;
-  std::ifstream input(file_name);
-  while (input) {
-    input >> key;
-
-    KeyType index_key;
-    index_key.SetFromInteger(key);
-    RID rid(key);
-    Insert(index_key, rid, txn);
+  if constexpr (std::is_same_v<ValueType, RID>) {
+    int64_t key;
+    std::ifstream input(file_name);
+    while (input) {
+      input >> key;
+
+      KeyType index_key;
+      index_key.SetFromInteger(key);
+      RID rid(key);
+      Insert(index_key, rid, txn);
+    }
   }
 }
 /*
@@ -985,4 +1429,24 @@ template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTree<GenericKey<128>, RID, GenericComparator<128>>;
+
+template class BPlusTree<GenericKey<256>, RID, GenericComparator<256>>;
+
+template class BPlusTree<GenericKey<16>, TuplePayload<128>, GenericComparator<16>>;
+
+template class BPlusTree<GenericKey<16>, TuplePayload<512>, GenericComparator<16>>;
+
+template class BPlusTree<GenericKey<64>, TuplePayload<128>, GenericComparator<64>>;
+
+template class BPlusTree<GenericKey<64>, TuplePayload<512>, GenericComparator<64>>;
+
+template class BPlusTree<GenericKey<16>, CoveringPayload<64>, GenericComparator<16>>;
+
+template class BPlusTree<GenericKey<16>, CoveringPayload<256>, GenericComparator<16>>;
+
+template class BPlusTree<GenericKey<64>, CoveringPayload<64>, GenericComparator<64>>;
+
+template class BPlusTree<GenericKey<64>, CoveringPayload<256>, GenericComparator<64>>;
+
 }  // namespace bustub
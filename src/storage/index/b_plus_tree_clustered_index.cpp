@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_clustered_index.cpp
+//
+// Identification: src/storage/index/b_plus_tree_clustered_index.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "storage/index/b_plus_tree_clustered_index.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_CLUSTERED_INDEX_TYPE::BPlusTreeClusteredIndex(std::unique_ptr<IndexMetadata> &&metadata,
+                                                        BufferPoolManager *buffer_pool_manager)
+    : ClusteredIndex(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema(), false, true) {
+  page_id_t header_page_id;
+  buffer_pool_manager->NewPage(&header_page_id);
+  // a lazy-delete index leaves underfull pages to the compaction thread, see BPlusTree::Remove
+  container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(
+      GetMetadata()->GetName(), header_page_id, buffer_pool_manager, comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE,
+      GetMetadata()->IsLazyDelete());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_CLUSTERED_INDEX_TYPE::InsertTuple(const Tuple &key, const Tuple &tuple, Transaction *transaction)
+    -> bool {
+  if (!KeyFits(key)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "varchar is too long for the primary key");
+  }
+  KeyType index_key;
+  MakeKey(key, &index_key);
+  ValueType payload;
+  payload.SetFromTuple(tuple);
+
+  return container_->Insert(index_key, payload, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_CLUSTERED_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // a key that does not fit was never inserted
+  if (!KeyFits(key)) {
+    return;
+  }
+  KeyType index_key;
+  MakeKey(key, &index_key);
+
+  container_->Remove(index_key, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_CLUSTERED_INDEX_TYPE::GetTuple(const Tuple &key, Tuple *tuple, Transaction *transaction) -> bool {
+  if (!KeyFits(key)) {
+    return false;
+  }
+  KeyType index_key;
+  MakeKey(key, &index_key);
+
+  std::vector<ValueType> result;
+  if (!container_->GetValue(index_key, &result, transaction)) {
+    return false;
+  }
+  *tuple = result[0].ToTuple();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_CLUSTERED_INDEX_TYPE::ScanTuples(const Tuple *lo, bool lo_inclusive, const Tuple *hi,
+                                                bool hi_inclusive, bool reverse) -> std::unique_ptr<TupleCursor> {
+  // construct the bound keys
+  KeyType lo_key;
+  KeyType hi_key;
+  // a bound cut off to the key width is longer than the keys that start with its prefix, see
+  // BPlusTreeIndex::MakeRangeBounds
+  if (lo != nullptr && !MakeBoundKey(*lo, lo_inclusive, &lo_key)) {
+    lo_inclusive = false;
+    MakeBoundKey(*lo, false, &lo_key);
+  }
+  if (hi != nullptr && !MakeBoundKey(*hi, !hi_inclusive, &hi_key)) {
+    hi_inclusive = true;
+    MakeBoundKey(*hi, false, &hi_key);
+  }
+
+  const KeyType *lo_ptr = lo != nullptr ? &lo_key : nullptr;
+  const KeyType *hi_ptr = hi != nullptr ? &hi_key : nullptr;
+  return std::make_unique<BPlusTreeTupleCursor<KeyType, ValueType, KeyComparator>>(
+      reverse ? container_->ReverseScanRange(lo_ptr, lo_inclusive, hi_ptr, hi_inclusive)
+              : container_->ScanRange(lo_ptr, lo_inclusive, hi_ptr, hi_inclusive));
+}
+
+/*
+ * The primary key is unique, so the normalized key needs no RID suffix, see GenericKey::SetFromNormalizedKey
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_CLUSTERED_INDEX_TYPE::MakeKey(const Tuple &key, KeyType *index_key) const {
+  index_key->SetFromNormalizedKey(key, *GetKeySchema(), GetKeySchema()->GetColumnCount(), 0);
+}
+
+/*
+ * Bound of a range scan on the leading key column. Below every key that starts with it when `lowest` is set, above
+ * all of them otherwise. Returns false if a varchar of the bound was cut off
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_CLUSTERED_INDEX_TYPE::MakeBoundKey(const Tuple &key, bool lowest, KeyType *index_key) const -> bool {
+  return index_key->SetFromNormalizedKey(key, *GetKeySchema(), 1, lowest ? 0x00 : 0xff);
+}
+
+template class BPlusTreeClusteredIndex<GenericKey<16>, TuplePayload<128>, GenericComparator<16>>;
+template class BPlusTreeClusteredIndex<GenericKey<16>, TuplePayload<512>, GenericComparator<16>>;
+template class BPlusTreeClusteredIndex<GenericKey<64>, TuplePayload<128>, GenericComparator<64>>;
+template class BPlusTreeClusteredIndex<GenericKey<64>, TuplePayload<512>, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -9,6 +9,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <type_traits>
+#include <utility>
+
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
@@ -17,38 +20,246 @@ namespace bustub {
  */
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
-    : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema()) {
+    : Index(std::move(metadata)), comparator_(GetMetadata()->GetKeySchema(), !GetMetadata()->IsUnique(), true) {
   page_id_t header_page_id;
   buffer_pool_manager->NewPage(&header_page_id);
-  container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(GetMetadata()->GetName(), header_page_id,
-                                                                              buffer_pool_manager, comparator_);
+  // a lazy-delete index leaves underfull pages to the compaction thread, see BPlusTree::Remove
+  container_ = std::make_shared<BPlusTree<KeyType, ValueType, KeyComparator>>(
+      GetMetadata()->GetName(), header_page_id, buffer_pool_manager, comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE,
+      GetMetadata()->IsLazyDelete());
+  if (GetMetadata()->GetBloomFilterBits() > 0) {
+    bloom_filter_ = std::make_unique<BloomFilter<KeyType>>(GetMetadata()->GetBloomFilterBits());
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool {
+  if (!KeyFits(key)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "varchar is too long for the index key");
+  }
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  MakeKey(key, rid, &index_key);
+  ValueType value;
+  MakeValue(key, rid, &value);
+  // the key goes into the filter first, a lookup that finds the entry in the tree always passes the filter
+  if (bloom_filter_ != nullptr) {
+    KeyType filter_key;
+    MakeFilterKey(key, &filter_key);
+    bloom_filter_->Insert(filter_key);
+  }
 
-  return container_->Insert(index_key, rid, transaction);
+  return container_->Insert(index_key, value, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // a key that does not fit was never inserted
+  if (!KeyFits(key)) {
+    return;
+  }
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  MakeKey(key, rid, &index_key);
 
   container_->Remove(index_key, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  // a key that does not fit would be cut off to a prefix that matches the wrong entries
+  if (!KeyFits(key)) {
+    return;
+  }
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  if (bloom_filter_ != nullptr) {
+    MakeFilterKey(key, &index_key);
+    if (!bloom_filter_->MayContain(index_key)) {
+      return;
+    }
+  }
+  if (GetMetadata()->IsUnique()) {
+    MakeKey(key, RID(), &index_key);
+    if constexpr (std::is_same_v<ValueType, RID>) {
+      container_->GetValue(index_key, result, transaction);
+    } else {
+      std::vector<ValueType> values;
+      container_->GetValue(index_key, &values, transaction);
+      for (const auto &value : values) {
+        result->push_back(IndexEntryRid(value));
+      }
+    }
+    return;
+  }
+
+  // every entry of a duplicate key lies between the smallest and the largest RID suffix
+  KeyType hi_key;
+  uint32_t column_count = GetMetadata()->GetKeyColumnCount();
+  MakeBoundKey(key, column_count, true, &index_key);
+  MakeBoundKey(key, column_count, false, &hi_key);
+  for (auto iter = container_->ScanRange(&index_key, true, &hi_key, true); !iter.IsEnd(); ++iter) {
+    result->push_back(IndexEntryRid((*iter).second));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::InsertEntries(const std::vector<Tuple> &keys, const std::vector<RID> &rids,
+                                         Transaction *transaction) -> bool {
+  std::vector<std::pair<KeyType, ValueType>> entries(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (!KeyFits(keys[i])) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "varchar is too long for the index key");
+    }
+    MakeKey(keys[i], rids[i], &entries[i].first);
+    MakeValue(keys[i], rids[i], &entries[i].second);
+  }
+  if (bloom_filter_ != nullptr) {
+    KeyType filter_key;
+    for (const auto &key : keys) {
+      MakeFilterKey(key, &filter_key);
+      bloom_filter_->Insert(filter_key);
+    }
+  }
+
+  return container_->InsertBatch(std::move(entries), transaction) == static_cast<int>(keys.size());
+}
 
-  container_->GetValue(index_key, result, transaction);
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                    Transaction *transaction) {
+  // only the keys that fit into the index and pass the filter go into the tree
+  std::vector<size_t> positions;
+  KeyType filter_key;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (!KeyFits(keys[i])) {
+      continue;
+    }
+    if (bloom_filter_ != nullptr) {
+      MakeFilterKey(keys[i], &filter_key);
+      if (!bloom_filter_->MayContain(filter_key)) {
+        continue;
+      }
+    }
+    positions.push_back(i);
+  }
+  if (positions.size() == keys.size()) {
+    ProbeKeys(keys, results, transaction);
+    return;
+  }
+
+  std::vector<Tuple> probe_keys;
+  probe_keys.reserve(positions.size());
+  for (auto position : positions) {
+    probe_keys.push_back(keys[position]);
+  }
+  std::vector<std::vector<RID>> probe_results;
+  if (!probe_keys.empty()) {
+    ProbeKeys(probe_keys, &probe_results, transaction);
+  }
+  results->assign(keys.size(), std::vector<RID>{});
+  for (size_t i = 0; i < positions.size(); i++) {
+    (*results)[positions[i]] = std::move(probe_results[i]);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ProbeKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                     Transaction *transaction) {
+  // a covering index probes into its own result vectors and keeps only the RIDs of the entries
+  std::vector<std::vector<ValueType>> values;
+  std::vector<std::vector<ValueType>> *probe_results;
+  if constexpr (std::is_same_v<ValueType, RID>) {
+    probe_results = results;
+  } else {
+    probe_results = &values;
+  }
+
+  if (GetMetadata()->IsUnique()) {
+    std::vector<KeyType> index_keys(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      MakeKey(keys[i], RID(), &index_keys[i]);
+    }
+    container_->GetValueBatch(index_keys, probe_results, transaction);
+  } else {
+    std::vector<std::pair<KeyType, KeyType>> ranges(keys.size());
+    uint32_t column_count = GetMetadata()->GetKeyColumnCount();
+    for (size_t i = 0; i < keys.size(); i++) {
+      MakeBoundKey(keys[i], column_count, true, &ranges[i].first);
+      MakeBoundKey(keys[i], column_count, false, &ranges[i].second);
+    }
+    container_->ScanRangeBatch(ranges, probe_results, transaction);
+  }
+
+  if constexpr (!std::is_same_v<ValueType, RID>) {
+    results->resize(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+      for (const auto &value : values[i]) {
+        (*results)[i].push_back(IndexEntryRid(value));
+      }
+    }
+  }
+}
+
+/*
+ * Index keys are normalized, see GenericKey::SetFromNormalizedKey. A non-unique index appends the RID to the key,
+ * so that the tree itself only ever holds distinct keys. The INCLUDE columns of a covering index are not part of it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::MakeKey(const Tuple &key, RID rid, KeyType *index_key) const {
+  index_key->SetFromNormalizedKey(key, *GetKeySchema(), GetMetadata()->GetKeyColumnCount(), 0);
+  if (!GetMetadata()->IsUnique()) {
+    index_key->SetNormalizedRidSuffix(rid);
+  }
+}
+
+/*
+ * The value of an entry, the RID itself or a covering payload with the RID and all the indexed columns
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::MakeValue(const Tuple &key, RID rid, ValueType *value) const {
+  if constexpr (std::is_same_v<ValueType, RID>) {
+    *value = rid;
+  } else {
+    value->rid_ = rid;
+    value->columns_.SetFromTuple(key);
+  }
+}
+
+/*
+ * The key a Bloom filter sees, only the key columns. A non-unique index leaves the RID suffix out, so that all the
+ * entries of a duplicate key share one filter key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::MakeFilterKey(const Tuple &key, KeyType *filter_key) const {
+  filter_key->SetFromNormalizedKey(key, *GetKeySchema(), GetMetadata()->GetKeyColumnCount(), 0);
+}
+
+/*
+ * Bound of a range scan on the first `column_count` key columns. Below every entry that starts with those columns
+ * when `lowest` is set, above all of them otherwise. Returns false if a varchar of the bound was cut off
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::MakeBoundKey(const Tuple &key, uint32_t column_count, bool lowest,
+                                        KeyType *index_key) const -> bool {
+  return index_key->SetFromNormalizedKey(key, *GetKeySchema(), column_count, lowest ? 0x00 : 0xff);
+}
+
+/*
+ * Bounds of a range scan on the leading key column. A bound cut off to the key width is longer than the entries
+ * that start with its prefix, they fall below a lower bound and within an upper bound
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::MakeRangeBounds(const Tuple *lo, bool *lo_inclusive, const Tuple *hi, bool *hi_inclusive,
+                                           KeyType *lo_key, KeyType *hi_key) const {
+  if (lo != nullptr && !MakeBoundKey(*lo, 1, *lo_inclusive, lo_key)) {
+    *lo_inclusive = false;
+    MakeBoundKey(*lo, 1, false, lo_key);
+  }
+  if (hi != nullptr && !MakeBoundKey(*hi, 1, !*hi_inclusive, hi_key)) {
+    *hi_inclusive = true;
+    MakeBoundKey(*hi, 1, false, hi_key);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -60,10 +271,58 @@ auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetEndIterator() -> INDEXITERATOR_TYPE { return container_->End(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive)
+    -> INDEXITERATOR_TYPE {
+  // construct the bound keys
+  KeyType lo_key;
+  KeyType hi_key;
+  MakeRangeBounds(lo, &lo_inclusive, hi, &hi_inclusive, &lo_key, &hi_key);
+
+  return container_->ScanRange(lo != nullptr ? &lo_key : nullptr, lo_inclusive, hi != nullptr ? &hi_key : nullptr,
+                               hi_inclusive);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::ReverseScanRange(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive)
+    -> INDEXITERATOR_TYPE {
+  KeyType lo_key;
+  KeyType hi_key;
+  MakeRangeBounds(lo, &lo_inclusive, hi, &hi_inclusive, &lo_key, &hi_key);
+
+  return container_->ReverseScanRange(lo != nullptr ? &lo_key : nullptr, lo_inclusive,
+                                      hi != nullptr ? &hi_key : nullptr, hi_inclusive);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::Scan(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive, bool reverse)
+    -> std::unique_ptr<IndexCursor> {
+  return std::make_unique<BPlusTreeIndexCursor<KeyType, ValueType, KeyComparator>>(
+      reverse ? ReverseScanRange(lo, lo_inclusive, hi, hi_inclusive) : ScanRange(lo, lo_inclusive, hi, hi_inclusive));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::ScanEntries(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive,
+                                       bool reverse) -> std::unique_ptr<TupleCursor> {
+  if constexpr (std::is_same_v<ValueType, RID>) {
+    return Index::ScanEntries(lo, lo_inclusive, hi, hi_inclusive, reverse);
+  } else {
+    return std::make_unique<BPlusTreeTupleCursor<KeyType, ValueType, KeyComparator>>(
+        reverse ? ReverseScanRange(lo, lo_inclusive, hi, hi_inclusive)
+                : ScanRange(lo, lo_inclusive, hi, hi_inclusive));
+  }
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<GenericKey<128>, RID, GenericComparator<128>>;
+template class BPlusTreeIndex<GenericKey<256>, RID, GenericComparator<256>>;
+template class BPlusTreeIndex<GenericKey<16>, CoveringPayload<64>, GenericComparator<16>>;
+template class BPlusTreeIndex<GenericKey<16>, CoveringPayload<256>, GenericComparator<16>>;
+template class BPlusTreeIndex<GenericKey<64>, CoveringPayload<64>, GenericComparator<64>>;
+template class BPlusTreeIndex<GenericKey<64>, CoveringPayload<256>, GenericComparator<64>>;
 
 }  // namespace bustub
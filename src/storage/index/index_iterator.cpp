@@ -5,6 +5,7 @@
 
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
+#include "storage/index/tuple_payload.h"
 
 namespace bustub {
 
@@ -16,65 +17,104 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, page_id_t page_id, int index,
-                                  MappingType &entry)
-    : bpm_(buffer_pool_manager), cur_page_id_(page_id), index_(index) {
-  entry_.first = entry.first;
-  entry_.second = entry.second;
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, ReadPageGuard guard, int index, bool reverse)
+    : bpm_(buffer_pool_manager), guard_(std::move(guard)), index_(index), reverse_(reverse) {
+  cur_page_id_ = guard_.PageId();
+  leaf_ = guard_.As<LeafPage>();
+  assert(index_ >= 0 && index_ < leaf_->GetSize());
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, page_id_t page_id, int index)
-    : bpm_(buffer_pool_manager), cur_page_id_(page_id), index_(index) {}
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, ReadPageGuard guard, int index,
+                                  const KeyType &end_key, bool end_inclusive, const KeyComparator *comparator,
+                                  bool reverse)
+    : IndexIterator(buffer_pool_manager, std::move(guard), index, reverse) {
+  has_end_key_ = true;
+  end_key_ = end_key;
+  end_inclusive_ = end_inclusive;
+  comparator_ = comparator;
+  if (PastEndKey()) {
+    MoveToEnd();
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
 
+/*
+ * Whether the current entry lies beyond the upper bound of the range scan,
+ * or below the lower bound for a reverse scan
+ */
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool {
-  ReadPageGuard cur_guard = bpm_->FetchPageRead(cur_page_id_);
-  auto cur_page = cur_guard.As<LeafPage>();
-  return cur_page->GetNextPageId() == INVALID_PAGE_ID && index_ == cur_page->GetSize() - 1;
+auto INDEXITERATOR_TYPE::PastEndKey() const -> bool {
+  if (!has_end_key_ || leaf_ == nullptr) {
+    return false;
+  }
+  int res = (*comparator_)(leaf_->KeyAt(index_), end_key_);
+  if (reverse_) {
+    res = -res;
+  }
+  return end_inclusive_ ? res > 0 : res >= 0;
 }
 
+/*
+ * Release the latch on the current leaf page and turn into the end iterator
+ */
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { return entry_; }
+void INDEXITERATOR_TYPE::MoveToEnd() {
+  guard_.Drop();
+  leaf_ = nullptr;
+  cur_page_id_ = INVALID_PAGE_ID;
+  index_ = -1;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
-  ReadPageGuard cur_guard = bpm_->FetchPageRead(cur_page_id_);
-  auto cur_page = cur_guard.As<LeafPage>();
+auto INDEXITERATOR_TYPE::IsEnd() -> bool { return leaf_ == nullptr; }
 
-  // 当前 iterator 已经是 end 了, 直接返回
-  if (cur_page_id_ == INVALID_PAGE_ID) {
-    return *this;
-  }
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { return leaf_->EntryAt(index_); }
 
-  // 判断下一个 iterator 是不是 end
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  // 当前 iterator 已经是 end 了, 直接返回
   if (IsEnd()) {
-    cur_page_id_ = INVALID_PAGE_ID;
-    index_ = -1;
     return *this;
   }
 
-  // 下一个 iterator 在当前页节点中
-  if (index_ < cur_page->GetSize() - 1) {
+  // 下一个 iterator 在当前页节点中, 不需要再经过 buffer pool
+  if (!reverse_ && index_ < leaf_->GetSize() - 1) {
     ++index_;
-    entry_.first = cur_page->KeyAt(index_);
-    entry_.second = cur_page->ValueAt(index_);
-    return *this;
+  } else if (reverse_ && index_ > 0) {
+    --index_;
+  } else {
+    // 下一个 iterator 在相邻的页节点中. 合并时是先锁右边再锁左边的兄弟节点,
+    // 所以这里不能加锁蟹行, 必须先放掉当前页再去拿相邻页
+    page_id_t next_page_id = reverse_ ? leaf_->GetPrevPageId() : leaf_->GetNextPageId();
+    guard_.Drop();
+    leaf_ = nullptr;
+    // 跳过空的叶子页
+    while (next_page_id != INVALID_PAGE_ID) {
+      guard_ = bpm_->FetchPageRead(next_page_id);
+      leaf_ = guard_.As<LeafPage>();
+      if (leaf_->GetSize() > 0) {
+        break;
+      }
+      next_page_id = reverse_ ? leaf_->GetPrevPageId() : leaf_->GetNextPageId();
+      guard_.Drop();
+      leaf_ = nullptr;
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      MoveToEnd();
+      return *this;
+    }
+    cur_page_id_ = next_page_id;
+    index_ = reverse_ ? leaf_->GetSize() - 1 : 0;
   }
 
-  // 下一个 iterator 在下一个页节点中
-  page_id_t next_page_id = cur_page->GetNextPageId();
-  ReadPageGuard next_guard = bpm_->FetchPageRead(next_page_id);
-  auto next_page = next_guard.As<LeafPage>();
-
-  index_ = 0;
-  entry_.first = next_page->KeyAt(index_);
-  entry_.second = next_page->ValueAt(index_);
-  cur_page_id_ = next_page_id;
-
+  // 越过了范围扫描的边界, 变为 end
+  if (PastEndKey()) {
+    MoveToEnd();
+  }
   return *this;
 }
 
@@ -96,4 +136,24 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<GenericKey<128>, RID, GenericComparator<128>>;
+
+template class IndexIterator<GenericKey<256>, RID, GenericComparator<256>>;
+
+template class IndexIterator<GenericKey<16>, TuplePayload<128>, GenericComparator<16>>;
+
+template class IndexIterator<GenericKey<16>, TuplePayload<512>, GenericComparator<16>>;
+
+template class IndexIterator<GenericKey<64>, TuplePayload<128>, GenericComparator<64>>;
+
+template class IndexIterator<GenericKey<64>, TuplePayload<512>, GenericComparator<64>>;
+
+template class IndexIterator<GenericKey<16>, CoveringPayload<64>, GenericComparator<16>>;
+
+template class IndexIterator<GenericKey<16>, CoveringPayload<256>, GenericComparator<16>>;
+
+template class IndexIterator<GenericKey<64>, CoveringPayload<64>, GenericComparator<64>>;
+
+template class IndexIterator<GenericKey<64>, CoveringPayload<256>, GenericComparator<64>>;
+
 }  // namespace bustub
@@ -5,38 +5,50 @@
 namespace bustub {
 /*
  * Constructor
+ * Keys are normalized, two keys that compare equal have the same bytes and therefore the same hash.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_INDEX_TYPE::LinearProbeHashTableIndex(std::unique_ptr<IndexMetadata> &&metadata,
                                                  BufferPoolManager *buffer_pool_manager, size_t num_buckets,
                                                  const HashFunction<KeyType> &hash_fn)
     : Index(std::move(metadata)),
-      comparator_(GetMetadata()->GetKeySchema()),
+      comparator_(GetMetadata()->GetKeySchema(), false, true),
       container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, num_buckets, hash_fn) {}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool {
+  if (!KeyFits(key)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "varchar is too long for the index key");
+  }
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromNormalizedKey(key, *GetKeySchema(), GetKeySchema()->GetColumnCount(), 0);
 
   return container_.Insert(transaction, index_key, rid);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // a key that does not fit was never inserted
+  if (!KeyFits(key)) {
+    return;
+  }
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromNormalizedKey(key, *GetKeySchema(), GetKeySchema()->GetColumnCount(), 0);
 
   container_.Remove(transaction, index_key, rid);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  // a key that does not fit would be cut off to a prefix that matches the wrong entries
+  if (!KeyFits(key)) {
+    return;
+  }
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromNormalizedKey(key, *GetKeySchema(), GetKeySchema()->GetColumnCount(), 0);
 
   container_.GetValue(transaction, index_key, result);
 }
@@ -80,7 +80,8 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::FindValue(KeyType key, const KeyComparator
     return comparator(lhs.first, rhs) <= 0;
   };
 
-  auto res = std::lower_bound(array_, array_ + GetSize(), key, compare_first);
+  // 第 0 个 key 是无效的, 从第 1 个开始找, 否则比 array_[0].first 还小的 key 会越界
+  auto res = std::lower_bound(array_ + 1, array_ + GetSize(), key, compare_first);
   res = std::prev(res);
 
   // 记录一下孩子节点的索引下标, 用于删除
@@ -173,4 +174,6 @@ template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+template class BPlusTreeInternalPage<GenericKey<128>, page_id_t, GenericComparator<128>>;
+template class BPlusTreeInternalPage<GenericKey<256>, page_id_t, GenericComparator<256>>;
 }  // namespace bustub
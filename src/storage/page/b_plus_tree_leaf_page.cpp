@@ -15,6 +15,7 @@
 #include "common/exception.h"
 #include "common/rid.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/index/tuple_payload.h"
 
 namespace bustub {
 
@@ -24,7 +25,7 @@ namespace bustub {
 
 /**
  * Init method after creating a new leaf page
- * Including set page type, set current size to zero, set next page id and set max size
+ * Including set page type, set current size to zero, set next/prev page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t parent_page_id, int max_size) {
@@ -32,6 +33,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t parent_page_id, int max_size) {
   SetSize(0);
   SetPageType(IndexPageType::LEAF_PAGE);
   next_page_id_ = INVALID_PAGE_ID;
+  prev_page_id_ = INVALID_PAGE_ID;
   SetParentPageId(parent_page_id);
 }
 
@@ -44,6 +46,15 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return nex
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+/**
+ * Helper methods to set/get prev page id, the backward link used by reverse scans
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t { return prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
@@ -60,6 +71,12 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType {
   return array_[index].second;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::EntryAt(int index) const -> const MappingType & {
+  assert(index < GetSize());
+  return array_[index];
+}
+
 /**
  * Find the corresponding value based on the target in the leaf node
  */
@@ -85,6 +102,20 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::FindValue(const KeyType &key, ValueType &value,
   return false;
 }
 
+/**
+ * Find the index of the first key that is not less than the target (a.k.a lower bound)
+ * @return GetSize() if every key in this page is less than the target
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
+  auto compare_first = [comparator](const MappingType &lhs, KeyType rhs) -> bool {
+    return comparator(lhs.first, rhs) < 0;
+  };
+
+  auto it = std::lower_bound(array_, array_ + GetSize(), key, compare_first);
+  return std::distance(array_, it);
+}
+
 /**
  * Insert the <key, value> pair into the leaf page
  * (if the duplicate key found, return false)
@@ -195,4 +226,14 @@ template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeLeafPage<GenericKey<128>, RID, GenericComparator<128>>;
+template class BPlusTreeLeafPage<GenericKey<256>, RID, GenericComparator<256>>;
+template class BPlusTreeLeafPage<GenericKey<16>, TuplePayload<128>, GenericComparator<16>>;
+template class BPlusTreeLeafPage<GenericKey<16>, TuplePayload<512>, GenericComparator<16>>;
+template class BPlusTreeLeafPage<GenericKey<64>, TuplePayload<128>, GenericComparator<64>>;
+template class BPlusTreeLeafPage<GenericKey<64>, TuplePayload<512>, GenericComparator<64>>;
+template class BPlusTreeLeafPage<GenericKey<16>, CoveringPayload<64>, GenericComparator<16>>;
+template class BPlusTreeLeafPage<GenericKey<16>, CoveringPayload<256>, GenericComparator<16>>;
+template class BPlusTreeLeafPage<GenericKey<64>, CoveringPayload<64>, GenericComparator<64>>;
+template class BPlusTreeLeafPage<GenericKey<64>, CoveringPayload<256>, GenericComparator<64>>;
 }  // namespace bustub
@@ -10,6 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
+
+#include "common/logger.h"
 #include "storage/page/hash_table_block_page.h"
 #include "storage/index/generic_key.h"
 
@@ -17,30 +21,110 @@ namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::KeyAt(slot_offset_t bucket_ind) const -> KeyType {
-  return {};
+  return array_[bucket_ind].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::ValueAt(slot_offset_t bucket_ind) const -> ValueType {
-  return {};
+  return array_[bucket_ind].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  if (IsOccupied(bucket_ind)) {
+    return false;
+  }
+  array_[bucket_ind] = MappingType(key, value);
+  occupied_[bucket_ind / 8] |= 1 << (bucket_ind % 8);
+  readable_[bucket_ind / 8] |= 1 << (bucket_ind % 8);
+  return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {}
+void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {
+  readable_[bucket_ind / 8] &= ~(1 << (bucket_ind % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::IsOccupied(slot_offset_t bucket_ind) const -> bool {
-  return false;
+  return (occupied_[bucket_ind / 8] & (1 << (bucket_ind % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const -> bool {
-  return false;
+  return (readable_[bucket_ind / 8] & (1 << (bucket_ind % 8))) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BLOCK_TYPE::NextUnoccupied(slot_offset_t bucket_ind) const -> slot_offset_t {
+  return NextBit(occupied_, bucket_ind, false);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BLOCK_TYPE::NextReadable(slot_offset_t bucket_ind) const -> slot_offset_t {
+  return NextBit(readable_, bucket_ind, true);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BLOCK_TYPE::NextBit(const uint8_t *bitmap, slot_offset_t bucket_ind, bool bit) -> slot_offset_t {
+  constexpr size_t bitmap_size = (BLOCK_ARRAY_SIZE - 1) / 8 + 1;
+  // Look at 64 slots at once: load 8 bitmap bytes as one little-endian word, so that bit i of the word is slot i, and
+  // count the trailing zeros. Bits past the end of the bitmap land on indexes >= BLOCK_ARRAY_SIZE.
+  while (bucket_ind < BLOCK_ARRAY_SIZE) {
+    size_t byte = bucket_ind / 8;
+    uint64_t word = 0;
+    memcpy(&word, bitmap + byte, std::min<size_t>(sizeof(word), bitmap_size - byte));
+    if (!bit) {
+      word = ~word;
+    }
+    word >>= bucket_ind % 8;
+    if (word != 0) {
+      return std::min<slot_offset_t>(bucket_ind + __builtin_ctzll(word), BLOCK_ARRAY_SIZE);
+    }
+    bucket_ind = (byte + sizeof(word)) * 8;
+  }
+  return BLOCK_ARRAY_SIZE;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BLOCK_TYPE::NumReadable() -> uint32_t {
+  uint32_t num_readable = 0;
+  for (auto byte : readable_) {
+    num_readable += __builtin_popcount(byte);
+  }
+  return num_readable;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BLOCK_TYPE::IsFull() -> bool {
+  return NextUnoccupied(0) == BLOCK_ARRAY_SIZE;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BLOCK_TYPE::IsEmpty() -> bool {
+  return NextReadable(0) == BLOCK_ARRAY_SIZE;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BLOCK_TYPE::PrintBucket() {
+  uint32_t size = 0;
+  uint32_t taken = 0;
+  uint32_t free = 0;
+  for (size_t bucket_idx = 0; bucket_idx < BLOCK_ARRAY_SIZE; bucket_idx++) {
+    if (!IsOccupied(bucket_idx)) {
+      continue;
+    }
+
+    size++;
+
+    if (IsReadable(bucket_idx)) {
+      taken++;
+    } else {
+      free++;
+    }
+  }
+
+  LOG_INFO("Block Capacity: %lu, Size: %u, Taken: %u, Free: %u", BLOCK_ARRAY_SIZE, size, taken, free);
 }
 
 // DO NOT REMOVE ANYTHING BELOW THIS LINE
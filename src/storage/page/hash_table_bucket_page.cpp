@@ -10,6 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <iterator>
+#include <optional>
+
 #include "storage/page/hash_table_bucket_page.h"
 #include "common/logger.h"
 #include "common/util/hash_util.h"
@@ -20,62 +24,130 @@
 namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool {
-  return false;
+void HASH_TABLE_BUCKET_TYPE::Init() {
+  overflow_page_id_ = INVALID_PAGE_ID;
+  std::fill(std::begin(occupied_), std::end(occupied_), 0);
+  std::fill(std::begin(readable_), std::end(readable_), 0);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::GetOverflowPageId() const -> page_id_t {
+  return overflow_page_id_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::SetOverflowPageId(page_id_t overflow_page_id) {
+  overflow_page_id_ = overflow_page_id;
+}
+
+/*
+ * Occupied slots always form a prefix of the bucket: an insert reuses the first slot that is not readable, which is
+ * either a tombstone inside the prefix or the first never-used slot. A scan stops at the first unoccupied slot.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) const -> bool {
+  bool found = false;
+  for (uint32_t bucket_idx = 0; bucket_idx < BUCKET_ARRAY_SIZE && IsOccupied(bucket_idx); bucket_idx++) {
+    if (IsReadable(bucket_idx) && cmp(array_[bucket_idx].first, key) == 0) {
+      result->push_back(array_[bucket_idx].second);
+      found = true;
+    }
+  }
+  return found;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  std::optional<uint32_t> free_idx;
+  uint32_t bucket_idx = 0;
+  for (; bucket_idx < BUCKET_ARRAY_SIZE && IsOccupied(bucket_idx); bucket_idx++) {
+    if (!IsReadable(bucket_idx)) {
+      if (!free_idx.has_value()) {
+        free_idx = bucket_idx;
+      }
+    } else if (cmp(array_[bucket_idx].first, key) == 0 && array_[bucket_idx].second == value) {
+      return false;
+    }
+  }
+  if (!free_idx.has_value()) {
+    if (bucket_idx == BUCKET_ARRAY_SIZE) {
+      return false;
+    }
+    free_idx = bucket_idx;
+  }
+
+  array_[free_idx.value()] = MappingType(key, value);
+  SetOccupied(free_idx.value());
+  SetReadable(free_idx.value());
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  for (uint32_t bucket_idx = 0; bucket_idx < BUCKET_ARRAY_SIZE && IsOccupied(bucket_idx); bucket_idx++) {
+    if (IsReadable(bucket_idx) && cmp(array_[bucket_idx].first, key) == 0 && array_[bucket_idx].second == value) {
+      RemoveAt(bucket_idx);
+      return true;
+    }
+  }
   return false;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const -> KeyType {
-  return {};
+  return array_[bucket_idx].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const -> ValueType {
-  return {};
+  return array_[bucket_idx].second;
 }
 
+/*
+ * The slot stays occupied as a tombstone, so that scans still go past it
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] &= static_cast<char>(~(1 << (bucket_idx % 8)));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (occupied_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {
+  occupied_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (readable_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsFull() -> bool {
-  return false;
+  return NumReadable() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::NumReadable() -> uint32_t {
-  return 0;
+  uint32_t num_readable = 0;
+  for (auto flags : readable_) {
+    num_readable += __builtin_popcount(static_cast<unsigned char>(flags));
+  }
+  return num_readable;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsEmpty() -> bool {
-  return false;
+  return std::all_of(std::begin(readable_), std::end(readable_), [](char flags) { return flags == 0; });
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
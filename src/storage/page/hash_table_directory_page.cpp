@@ -26,29 +26,60 @@ void HashTableDirectoryPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
 auto HashTableDirectoryPage::GetGlobalDepth() -> uint32_t { return global_depth_; }
 
-auto HashTableDirectoryPage::GetGlobalDepthMask() -> uint32_t { return 0; }
+auto HashTableDirectoryPage::GetGlobalDepthMask() -> uint32_t { return (1U << global_depth_) - 1; }
 
-void HashTableDirectoryPage::IncrGlobalDepth() {}
+/*
+ * Doubling the directory mirrors its lower half into the upper half, so that every bucket keeps all of its pointers
+ * and only the bucket being split has to change afterwards.
+ */
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  assert(Size() * 2 <= DIRECTORY_ARRAY_SIZE);
+  uint32_t size = Size();
+  std::copy(bucket_page_ids_, bucket_page_ids_ + size, bucket_page_ids_ + size);
+  std::copy(local_depths_, local_depths_ + size, local_depths_ + size);
+  global_depth_++;
+}
 
 void HashTableDirectoryPage::DecrGlobalDepth() { global_depth_--; }
 
-auto HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) -> page_id_t { return 0; }
+auto HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) -> page_id_t { return bucket_page_ids_[bucket_idx]; }
 
-void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) {}
+void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) {
+  bucket_page_ids_[bucket_idx] = bucket_page_id;
+}
 
-auto HashTableDirectoryPage::Size() -> uint32_t { return 0; }
+auto HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) -> uint32_t {
+  uint32_t local_depth = GetLocalDepth(bucket_idx);
+  return local_depth == 0 ? bucket_idx : bucket_idx ^ (1U << (local_depth - 1));
+}
 
-auto HashTableDirectoryPage::CanShrink() -> bool { return false; }
+auto HashTableDirectoryPage::Size() -> uint32_t { return 1U << global_depth_; }
 
-auto HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) -> uint32_t { return 0; }
+auto HashTableDirectoryPage::CanShrink() -> bool {
+  if (global_depth_ == 0) {
+    return false;
+  }
+  return std::all_of(local_depths_, local_depths_ + Size(),
+                     [this](uint8_t local_depth) { return local_depth < global_depth_; });
+}
 
-void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint8_t local_depth) {}
+auto HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) -> uint32_t { return local_depths_[bucket_idx]; }
 
-void HashTableDirectoryPage::IncrLocalDepth(uint32_t bucket_idx) {}
+void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint8_t local_depth) {
+  local_depths_[bucket_idx] = local_depth;
+}
+
+void HashTableDirectoryPage::IncrLocalDepth(uint32_t bucket_idx) { local_depths_[bucket_idx]++; }
 
-void HashTableDirectoryPage::DecrLocalDepth(uint32_t bucket_idx) {}
+void HashTableDirectoryPage::DecrLocalDepth(uint32_t bucket_idx) { local_depths_[bucket_idx]--; }
 
-auto HashTableDirectoryPage::GetLocalHighBit(uint32_t bucket_idx) -> uint32_t { return 0; }
+auto HashTableDirectoryPage::GetLocalDepthMask(uint32_t bucket_idx) -> uint32_t {
+  return (1U << local_depths_[bucket_idx]) - 1;
+}
+
+auto HashTableDirectoryPage::GetLocalHighBit(uint32_t bucket_idx) -> uint32_t {
+  return 1U << local_depths_[bucket_idx];
+}
 
 /**
  * VerifyIntegrity - Use this for debugging but **DO NOT CHANGE**
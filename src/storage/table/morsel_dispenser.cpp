@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_dispenser.cpp
+//
+// Identification: src/storage/table/morsel_dispenser.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "storage/page/table_page.h"
+#include "storage/table/morsel_dispenser.h"
+
+namespace bustub {
+
+MorselDispenser::MorselDispenser(BufferPoolManager *bpm, TableHeap *table_heap, size_t morsel_size)
+    : bpm_(bpm), table_heap_(table_heap), morsel_size_(morsel_size) {
+  Reset();
+}
+
+void MorselDispenser::Reset() {
+  auto last_page_id = table_heap_->GetLastPageId();
+  auto page_guard = bpm_->FetchPageRead(last_page_id);
+  stop_at_rid_ = RID{last_page_id, page_guard.As<TablePage>()->GetNumTuples()};
+  page_guard.Drop();
+
+  std::scoped_lock lock(latch_);
+  next_page_id_ = table_heap_->GetFirstPageId();
+}
+
+auto MorselDispenser::Next(std::vector<page_id_t> *page_ids) -> bool {
+  page_ids->clear();
+  std::scoped_lock lock(latch_);
+  // The pages of a table heap are only linked to each other, so the dispenser walks the chain to find where the next
+  // morsel starts. Reading a page header is cheap next to scanning the tuples of the page.
+  while (page_ids->size() < morsel_size_ && next_page_id_ != INVALID_PAGE_ID) {
+    page_ids->push_back(next_page_id_);
+    if (next_page_id_ == stop_at_rid_.GetPageId()) {
+      next_page_id_ = INVALID_PAGE_ID;
+      break;
+    }
+    auto page_guard = bpm_->FetchPageRead(next_page_id_);
+    next_page_id_ = page_guard.As<TablePage>()->GetNextPageId();
+  }
+  return !page_ids->empty();
+}
+
+}  // namespace bustub
@@ -117,6 +117,11 @@ auto TableHeap::MakeIterator() -> TableIterator {
 
 auto TableHeap::MakeEagerIterator() -> TableIterator { return {this, {first_page_id_, 0}, {INVALID_PAGE_ID, 0}}; }
 
+auto TableHeap::GetLastPageId() -> page_id_t {
+  std::unique_lock<std::mutex> guard(latch_);
+  return last_page_id_;
+}
+
 void TableHeap::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid) {
   auto page_guard = bpm_->FetchPageWrite(rid.GetPageId());
   auto page = page_guard.AsMut<TablePage>();
@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_file.cpp
+//
+// Identification: src/storage/table/tmp_tuple_file.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tmp_tuple_file.h"
+
+namespace bustub {
+
+TmpTupleFile::~TmpTupleFile() {
+  Finish();
+  for (auto page_id : page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+}
+
+void TmpTupleFile::Append(const Tuple &tuple) {
+  TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+  if (write_page_ == nullptr || !write_page_->Insert(tuple, &tmp_tuple)) {
+    Finish();
+    page_id_t page_id = INVALID_PAGE_ID;
+    auto page = bpm_->NewPage(&page_id);
+    BUSTUB_ENSURE(page != nullptr, "cannot allocate page");
+    write_page_ = reinterpret_cast<TmpTuplePage *>(page);
+    write_page_->Init(page_id, BUSTUB_PAGE_SIZE);
+    page_ids_.push_back(page_id);
+    BUSTUB_ENSURE(write_page_->Insert(tuple, &tmp_tuple), "tuple is too large, cannot insert");
+  }
+  num_tuples_++;
+  size_ += sizeof(uint32_t) + tuple.GetLength();
+}
+
+void TmpTupleFile::Finish() {
+  if (write_page_ != nullptr) {
+    bpm_->UnpinPage(write_page_->GetTablePageId(), true);
+    write_page_ = nullptr;
+  }
+}
+
+auto TmpTupleFile::ReadBatch(TupleBatch *batch, const Schema *schema) -> bool {
+  Finish();
+  batch->Reset(schema);
+  Tuple tuple;
+  // whole pages at a time, so a batch may end up a little over its capacity
+  while (!batch->IsFull() && read_page_idx_ < page_ids_.size()) {
+    auto page_id = page_ids_[read_page_idx_++];
+    auto page = reinterpret_cast<TmpTuplePage *>(bpm_->FetchPage(page_id));
+    BUSTUB_ENSURE(page != nullptr, "cannot fetch page");
+    // a page is filled from its end, walk it from the free space pointer and read the tuples back to front
+    offsets_.clear();
+    for (size_t offset = page->GetFreeSpacePointer(); offset < BUSTUB_PAGE_SIZE;) {
+      offsets_.push_back(offset);
+      offset = page->Get(offset, &tuple);
+    }
+    for (auto it = offsets_.rbegin(); it != offsets_.rend(); it++) {
+      page->Get(*it, &tuple);
+      batch->AppendTuple(tuple, RID{});
+    }
+    bpm_->UnpinPage(page_id, false);
+  }
+  return !batch->IsEmpty();
+}
+
+}  // namespace bustub
@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.cpp
+//
+// Identification: src/storage/table/tuple_batch.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/table/tuple_batch.h"
+
+namespace bustub {
+
+void TupleBatch::Reset(const Schema *schema) {
+  schema_ = schema;
+  num_rows_ = 0;
+  // keep the capacity of the column vectors, a batch is refilled over and over
+  columns_.resize(schema->GetColumnCount());
+  for (auto &column : columns_) {
+    column.clear();
+  }
+  rids_.clear();
+}
+
+void TupleBatch::AppendTuple(const Tuple &tuple, RID rid) {
+  for (uint32_t col_idx = 0; col_idx < columns_.size(); col_idx++) {
+    columns_[col_idx].push_back(tuple.GetValue(schema_, col_idx));
+  }
+  rids_.push_back(rid);
+  num_rows_++;
+}
+
+void TupleBatch::AppendRow(const std::vector<Value> &values, RID rid) {
+  BUSTUB_ASSERT(values.size() == columns_.size(), "row does not match the schema of the batch");
+  for (uint32_t col_idx = 0; col_idx < columns_.size(); col_idx++) {
+    columns_[col_idx].push_back(values[col_idx]);
+  }
+  rids_.push_back(rid);
+  num_rows_++;
+}
+
+void TupleBatch::SetColumns(std::vector<std::vector<Value>> columns, size_t num_rows) {
+  BUSTUB_ASSERT(columns.size() == columns_.size(), "columns do not match the schema of the batch");
+  columns_.swap(columns);
+  num_rows_ = num_rows;
+  rids_.resize(num_rows);
+}
+
+void TupleBatch::Select(const std::vector<uint32_t> &sel) {
+  // sel[i] >= i, so compacting in place never overwrites a row that is still to be kept. Swapping hands over the
+  // varchar buffers instead of copying them.
+  for (auto &column : columns_) {
+    for (size_t i = 0; i < sel.size(); i++) {
+      if (sel[i] != i) {
+        Swap(column[i], column[sel[i]]);
+      }
+    }
+    column.erase(column.begin() + sel.size(), column.end());
+  }
+  for (size_t i = 0; i < sel.size(); i++) {
+    rids_[i] = rids_[sel[i]];
+  }
+  rids_.erase(rids_.begin() + sel.size(), rids_.end());
+  num_rows_ = sel.size();
+}
+
+auto TupleBatch::GetTuple(size_t row) const -> Tuple {
+  std::vector<Value> values;
+  values.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    values.push_back(column[row]);
+  }
+  return {std::move(values), schema_};
+}
+
+auto TupleBatch::GetTupleSize(size_t row) const -> uint32_t {
+  // same layout as Tuple: the inlined columns, then size+data for every uninlined one
+  uint32_t size = schema_->GetLength();
+  for (auto col_idx : schema_->GetUnlinedColumns()) {
+    auto len = columns_[col_idx][row].GetLength();
+    if (len == BUSTUB_VALUE_NULL) {
+      len = 0;
+    }
+    size += len + sizeof(uint32_t);
+  }
+  return size;
+}
+
+void TupleBatch::SerializeTuple(size_t row, char *storage) const {
+  uint32_t offset = schema_->GetLength();
+  for (uint32_t col_idx = 0; col_idx < columns_.size(); col_idx++) {
+    const auto &col = schema_->GetColumn(col_idx);
+    const auto &value = columns_[col_idx][row];
+    if (col.IsInlined()) {
+      value.SerializeTo(storage + col.GetOffset());
+      continue;
+    }
+    // the relative offset of the size+data of the value, stored after the inlined columns
+    memcpy(storage + col.GetOffset(), &offset, sizeof(uint32_t));
+    value.SerializeTo(storage + offset);
+    auto len = value.GetLength();
+    if (len == BUSTUB_VALUE_NULL) {
+      len = 0;
+    }
+    offset += len + sizeof(uint32_t);
+  }
+}
+
+}  // namespace bustub
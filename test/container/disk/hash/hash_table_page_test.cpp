@@ -17,13 +17,14 @@
 #include "common/logger.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/page/hash_table_block_page.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
+TEST(HashTablePageTest, DirectoryPageSampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -56,7 +57,7 @@ TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
+TEST(HashTablePageTest, BucketPageSampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -113,4 +114,48 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BlockPageTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+
+  // get a block page from the BufferPoolManager
+  page_id_t block_page_id = INVALID_PAGE_ID;
+  auto block_page =
+      reinterpret_cast<HashTableBlockPage<int, int, IntComparator> *>(bpm->NewPage(&block_page_id)->GetData());
+  size_t capacity = (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(std::pair<int, int>) + 1));
+
+  EXPECT_TRUE(block_page->IsEmpty());
+  EXPECT_EQ(0, block_page->NextUnoccupied(0));
+  EXPECT_EQ(capacity, block_page->NextReadable(0));
+
+  // fill every slot but the last one of each run of 100
+  for (unsigned i = 0; i < capacity; i++) {
+    if (i % 100 != 99) {
+      EXPECT_TRUE(block_page->Insert(i, i, i));
+    }
+  }
+  EXPECT_FALSE(block_page->Insert(0, 1, 1));
+  EXPECT_EQ(99, block_page->NextUnoccupied(0));
+  EXPECT_EQ(199, block_page->NextUnoccupied(100));
+  EXPECT_EQ(capacity, block_page->NextUnoccupied(capacity - capacity % 100));
+  EXPECT_EQ(100, block_page->NextReadable(99));
+
+  // removed slots stay occupied as tombstones
+  block_page->Remove(100);
+  EXPECT_TRUE(block_page->IsOccupied(100));
+  EXPECT_FALSE(block_page->IsReadable(100));
+  EXPECT_EQ(101, block_page->NextReadable(99));
+  EXPECT_EQ(199, block_page->NextUnoccupied(100));
+  EXPECT_EQ(capacity - capacity / 100 - 1, block_page->NumReadable());
+  EXPECT_EQ(5, block_page->KeyAt(5));
+  EXPECT_EQ(5, block_page->ValueAt(5));
+
+  bpm->UnpinPage(block_page_id, true);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -24,7 +24,7 @@ namespace bustub {
 // NOLINTNEXTLINE
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(50, disk_manager);
   DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
@@ -117,4 +117,129 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, SplitMergeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // enough keys to overflow the first bucket several times
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i)) << "Failed to insert " << i << std::endl;
+  }
+  EXPECT_GT(ht.GetGlobalDepth(), 0);
+  ht.VerifyIntegrity();
+
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+  }
+
+  // emptying the table merges every bucket back and shrinks the directory
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, i, &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, OverflowTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(2000, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // a bucket page holds 496 pairs of ints
+  const int bucket_size = 496;
+
+  // values of one key share a hash, no split can spread them over several buckets
+  const int num_duplicates = 3 * bucket_size;
+  for (int i = 0; i < num_duplicates; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, -1, i)) << "Failed to insert " << i << std::endl;
+  }
+  EXPECT_FALSE(ht.Insert(nullptr, -1, 0));
+  std::vector<int> res;
+  ht.GetValue(nullptr, -1, &res);
+  EXPECT_EQ(num_duplicates, res.size());
+  ht.VerifyIntegrity();
+
+  // more keys than the buckets of a full directory page hold
+  const int num_keys = DIRECTORY_ARRAY_SIZE * bucket_size * 5 / 4;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i)) << "Failed to insert " << i << std::endl;
+  }
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+  }
+
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  for (int i = 0; i < num_duplicates; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, -1, i));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  res.clear();
+  EXPECT_FALSE(ht.GetValue(nullptr, -1, &res));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentInsertTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // each thread inserts its own keys, the splits of one thread race with the inserts of the others
+  const int num_threads = 4;
+  const int keys_per_thread = 2000;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&ht, tid]() {
+      for (int i = tid; i < num_threads * keys_per_thread; i += num_threads) {
+        ht.Insert(nullptr, i, i);
+        std::vector<int> res;
+        ht.GetValue(nullptr, i, &res);
+        EXPECT_EQ(1, res.size());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ht.VerifyIntegrity();
+
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
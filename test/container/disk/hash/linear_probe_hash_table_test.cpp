@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// linear_probe_hash_table_test.cpp
+//
+// Identification: test/container/disk/hash/linear_probe_hash_table_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/logger.h"
+#include "container/disk/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "murmur3/MurmurHash3.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, SampleTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), 1000, HashFunction<int>());
+
+  // insert a few values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // insert one more value for each key, a duplicate pair is rejected
+  for (int i = 0; i < 5; i++) {
+    EXPECT_FALSE(ht.Insert(nullptr, i, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i + 1));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(2, res.size());
+  }
+
+  // look for a key that does not exist
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 20, &res));
+  EXPECT_EQ(0, res.size());
+
+  // delete some values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(2 * i + 1, res[0]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ResizeTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), 10, HashFunction<int>());
+  size_t initial_size = ht.GetSize();
+
+  // far more keys than the initial blocks hold
+  const int num_keys = 20000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i)) << "Failed to insert " << i << std::endl;
+  }
+  EXPECT_GT(ht.GetSize(), initial_size);
+
+  // every entry survives the resizes, tombstones included
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i % 2 == 0) {
+      EXPECT_EQ(0, res.size()) << "Failed to remove " << i << std::endl;
+    } else {
+      ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+      EXPECT_EQ(i, res[0]);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ConcurrentInsertLookupTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), 10, HashFunction<int>());
+
+  // the writers force several resizes while the readers keep looking up the keys inserted before they started
+  const int num_threads = 4;
+  const int keys_per_thread = 5000;
+  const int num_preloaded = 1000;
+  for (int i = 0; i < num_preloaded; i++) {
+    ht.Insert(nullptr, -i - 1, i);
+  }
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&ht, tid]() {
+      for (int i = tid; i < num_threads * keys_per_thread; i += num_threads) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+      }
+    });
+    threads.emplace_back([&ht]() {
+      for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < num_preloaded; i++) {
+          std::vector<int> res;
+          ht.GetValue(nullptr, -i - 1, &res);
+          ASSERT_EQ(1, res.size());
+          EXPECT_EQ(i, res[0]);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_hash_table_test.cpp
+//
+// Identification: test/execution/join_hash_table_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "execution/join_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/table/tuple_batch.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto KeyOf(const Value &value) -> std::vector<char> {
+  std::vector<std::vector<Value>> key_columns{{value}};
+  std::vector<char> key;
+  EXPECT_TRUE(JoinHashTable::SerializeKey(key_columns, 0, &key));
+  return key;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(JoinHashTableTest, MixedNumericKeyTest) {
+  // equal values of different numeric types serialize to the same key
+  ASSERT_EQ(KeyOf(ValueFactory::GetIntegerValue(3)), KeyOf(ValueFactory::GetDecimalValue(3.0)));
+  ASSERT_EQ(KeyOf(ValueFactory::GetBigIntValue(-7)), KeyOf(ValueFactory::GetDecimalValue(-7.0)));
+  ASSERT_EQ(KeyOf(ValueFactory::GetSmallIntValue(12)), KeyOf(ValueFactory::GetIntegerValue(12)));
+  ASSERT_EQ(KeyOf(ValueFactory::GetIntegerValue(0)), KeyOf(ValueFactory::GetDecimalValue(-0.0)));
+  ASSERT_EQ(KeyOf(ValueFactory::GetBigIntValue(1LL << 62)), KeyOf(ValueFactory::GetDecimalValue(1ULL << 62)));
+
+  // and different values do not
+  ASSERT_NE(KeyOf(ValueFactory::GetIntegerValue(2)), KeyOf(ValueFactory::GetDecimalValue(2.5)));
+  ASSERT_NE(KeyOf(ValueFactory::GetDecimalValue(2.5)), KeyOf(ValueFactory::GetDecimalValue(3.5)));
+  // an integer whose bytes are the bytes of the double 1.0
+  ASSERT_NE(KeyOf(ValueFactory::GetBigIntValue(0x3ff0000000000000LL)), KeyOf(ValueFactory::GetDecimalValue(1.0)));
+  ASSERT_NE(KeyOf(ValueFactory::GetDecimalValue(1e300)), KeyOf(ValueFactory::GetDecimalValue(-1e300)));
+}
+
+// NOLINTNEXTLINE
+TEST(JoinHashTableTest, IntegerProbesDecimalTest) {
+  // a DECIMAL build side probed with INTEGER keys
+  Schema schema({Column{"d", TypeId::DECIMAL}});
+  TupleBatch batch;
+  batch.Reset(&schema);
+  std::vector<double> decimals{1.0, 2.5, 3.0, 3.0, -4.0};
+  for (auto decimal : decimals) {
+    batch.AppendRow({ValueFactory::GetDecimalValue(decimal)});
+  }
+  std::vector<std::vector<Value>> build_keys(1);
+  for (size_t row = 0; row < batch.NumRows(); row++) {
+    build_keys[0].push_back(batch.GetValue(row, 0));
+  }
+
+  JoinHashTable table(&schema);
+  table.Reserve(batch.NumRows());
+  std::vector<char> key;
+  for (size_t row = 0; row < batch.NumRows(); row++) {
+    ASSERT_TRUE(JoinHashTable::SerializeKey(build_keys, row, &key));
+    table.Insert(key, JoinHashTable::HashKey(key), batch, row);
+  }
+
+  std::vector<std::vector<Value>> probe_keys{{ValueFactory::GetIntegerValue(1), ValueFactory::GetIntegerValue(2),
+                                              ValueFactory::GetIntegerValue(3), ValueFactory::GetIntegerValue(-4)}};
+  std::vector<size_t> expected_matches{1, 0, 2, 1};
+  for (size_t row = 0; row < expected_matches.size(); row++) {
+    ASSERT_TRUE(JoinHashTable::SerializeKey(probe_keys, row, &key));
+    size_t matches = 0;
+    for (auto match = table.Find(key, JoinHashTable::HashKey(key)); match != JoinHashTable::NO_ROW;
+         match = table.NextRow(match)) {
+      matches++;
+    }
+    ASSERT_EQ(expected_matches[row], matches) << "probe key " << probe_keys[0][row].ToString();
+  }
+}
+
+}  // namespace bustub
@@ -445,4 +445,317 @@ TEST(BPlusTreeTests, InsertTest3) {
   remove("test.log");
 }
 
+TEST(BPlusTreeTests, ReverseIteratorTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // create b+ tree, small pages so that the prev links go through many splits and merges
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  int64_t scale = 500;
+  std::vector<int64_t> keys(scale);
+  std::iota(keys.begin(), keys.end(), 1);
+  auto rng = std::default_random_engine{};
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (auto key : keys) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  // remove the odd keys
+  for (auto key : keys) {
+    if (key % 2 == 1) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+  }
+
+  int64_t current_key = scale;
+  for (auto iterator = tree.RBegin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key -= 2;
+  }
+  EXPECT_EQ(current_key, 0);
+
+  // (100, 200] walked backward
+  GenericKey<8> lo_key;
+  GenericKey<8> hi_key;
+  lo_key.SetFromInteger(100);
+  hi_key.SetFromInteger(200);
+  current_key = 200;
+  for (auto iterator = tree.ReverseScanRange(&lo_key, false, &hi_key, true); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key -= 2;
+  }
+  EXPECT_EQ(current_key, 100);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, BatchTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // create b+ tree, small pages so that a batch spans many leaves and still has to split them
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 4, 4);
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // even keys go in one at a time, odd keys in two shuffled batches with one duplicate each
+  int64_t scale = 1000;
+  for (int64_t key = 2; key <= scale; key += 2) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    tree.Insert(index_key, rid, transaction);
+  }
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale; key += 2) {
+    keys.push_back(key);
+  }
+  auto rng = std::default_random_engine{};
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (size_t half = 0; half < 2; half++) {
+    std::vector<std::pair<GenericKey<8>, RID>> entries;
+    for (size_t i = half * keys.size() / 2; i < (half + 1) * keys.size() / 2; i++) {
+      GenericKey<8> index_key;
+      index_key.SetFromInteger(keys[i]);
+      entries.emplace_back(index_key, RID(static_cast<int32_t>(keys[i] >> 32), keys[i] & 0xFFFFFFFF));
+    }
+    entries.push_back(entries.front());
+    EXPECT_EQ(tree.InsertBatch(entries, transaction), static_cast<int>(entries.size()) - 1);
+  }
+
+  int64_t current_key = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, scale + 1);
+
+  // look up every key plus a few missing ones, in a shuffled order
+  std::vector<int64_t> lookup(scale + 10);
+  std::iota(lookup.begin(), lookup.end(), -4);
+  std::shuffle(lookup.begin(), lookup.end(), rng);
+  std::vector<GenericKey<8>> lookup_keys(lookup.size());
+  for (size_t i = 0; i < lookup.size(); i++) {
+    lookup_keys[i].SetFromInteger(lookup[i]);
+  }
+  std::vector<std::vector<RID>> results;
+  tree.GetValueBatch(lookup_keys, &results, transaction);
+  ASSERT_EQ(results.size(), lookup.size());
+  for (size_t i = 0; i < lookup.size(); i++) {
+    if (lookup[i] < 1 || lookup[i] > scale) {
+      EXPECT_TRUE(results[i].empty());
+      continue;
+    }
+    ASSERT_EQ(results[i].size(), 1);
+    EXPECT_EQ(results[i][0].GetSlotNum(), lookup[i]);
+  }
+
+  // ranges that span several leaves
+  std::vector<std::pair<GenericKey<8>, GenericKey<8>>> ranges(2);
+  ranges[0].first.SetFromInteger(500);
+  ranges[0].second.SetFromInteger(599);
+  ranges[1].first.SetFromInteger(10);
+  ranges[1].second.SetFromInteger(19);
+  tree.ScanRangeBatch(ranges, &results, transaction);
+  ASSERT_EQ(results[0].size(), 100);
+  ASSERT_EQ(results[1].size(), 10);
+  EXPECT_EQ(results[0].front().GetSlotNum(), 500);
+  EXPECT_EQ(results[1].back().GetSlotNum(), 19);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, AppendSplitTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // create b+ tree
+  const int leaf_max_size = 10;
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, leaf_max_size, 4);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // ascending even keys are all appends
+  int64_t scale = 2000;
+  for (int64_t key = 2; key <= scale; key += 2) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+
+  // every leaf page but the last one is left full
+  using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+  int leaf_count = 0;
+  {
+    auto guard = bpm->FetchPageRead(tree.GetRootPageId());
+    while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+      guard = bpm->FetchPageRead(guard.As<InternalPage>()->ValueAt(0));
+    }
+    while (true) {
+      const auto *leaf = guard.As<LeafPage>();
+      leaf_count++;
+      page_id_t next_page_id = leaf->GetNextPageId();
+      if (next_page_id == INVALID_PAGE_ID) {
+        break;
+      }
+      EXPECT_EQ(leaf->GetSize(), leaf_max_size - 1);
+      guard.Drop();
+      guard = bpm->FetchPageRead(next_page_id);
+    }
+  }
+  EXPECT_EQ(leaf_count, (scale / 2 + leaf_max_size - 2) / (leaf_max_size - 1));
+
+  // odd keys land in the middle of full pages, then remove the keys from the front
+  for (int64_t key = scale - 1; key > 0; key -= 2) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  for (int64_t key = 1; key <= scale / 2; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+
+  int64_t current_key = scale / 2 + 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, scale + 1);
+
+  // appends after the removals go through the rightmost leaf hint again
+  for (int64_t key = scale + 1; key <= scale + 100; key++) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  std::vector<RID> rids;
+  for (int64_t key = scale / 2 + 1; key <= scale + 100; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, LazyDeleteTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // create b+ tree that leaves rebalancing to the compaction thread
+  auto *tree =
+      new BPlusTree<GenericKey<8>, RID, GenericComparator<8>>("foo_pk", page_id, bpm, comparator, 4, 4, true);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  int64_t scale = 1000;
+  std::vector<int64_t> keys(scale);
+  std::iota(keys.begin(), keys.end(), 1);
+  auto rng = std::default_random_engine{};
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (auto key : keys) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree->Insert(index_key, rid, transaction);
+  }
+
+  // keep every tenth key, the rest leaves plenty of underfull and empty leaf pages behind
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (auto key : keys) {
+    if (key % 10 != 0) {
+      index_key.SetFromInteger(key);
+      tree->Remove(index_key, transaction);
+    }
+  }
+
+  for (int round = 0; round < 2; round++) {
+    int64_t current_key = 10;
+    for (auto iterator = tree->Begin(); iterator != tree->End(); ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+      current_key += 10;
+    }
+    EXPECT_EQ(current_key, scale + 10);
+    std::vector<RID> rids;
+    for (int64_t key = 1; key <= scale; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(tree->GetValue(index_key, &rids), key % 10 == 0);
+    }
+    tree->Compact();
+  }
+
+  for (int64_t key = 10; key <= scale; key += 10) {
+    index_key.SetFromInteger(key);
+    tree->Remove(index_key, transaction);
+  }
+  tree->Compact();
+  EXPECT_TRUE(tree->IsEmpty());
+
+  delete tree;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
@@ -10,20 +10,21 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 #include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tmp_tuple_file.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(TmpTuplePageTest, DISABLED_BasicTest) {
-  // There are many ways to do this assignment, and this is only one of them.
-  // If you don't like the TmpTuplePage idea, please feel free to delete this test case entirely.
-  // You will get full credit as long as you are correctly using a linear probe hash table.
-
+TEST(TmpTuplePageTest, BasicTest) {
   TmpTuplePage page{};
   page_id_t page_id = 15445;
   page.Init(page_id, BUSTUB_PAGE_SIZE);
@@ -41,11 +42,70 @@ TEST(TmpTuplePageTest, DISABLED_BasicTest) {
 
   Tuple tuple(values, &schema);
   TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
-  page.Insert(tuple, &tmp_tuple);
+  ASSERT_TRUE(page.Insert(tuple, &tmp_tuple));
 
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + sizeof(page_id_t) + sizeof(lsn_t)), BUSTUB_PAGE_SIZE - 8);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + BUSTUB_PAGE_SIZE - 8), 4);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + BUSTUB_PAGE_SIZE - 4), 123);
+  ASSERT_EQ(tmp_tuple.GetPageId(), page_id);
+  ASSERT_EQ(tmp_tuple.GetOffset(), BUSTUB_PAGE_SIZE - 8);
+
+  Tuple result;
+  ASSERT_EQ(page.Get(tmp_tuple.GetOffset(), &result), BUSTUB_PAGE_SIZE);
+  ASSERT_EQ(result.GetValue(&schema, 0).GetAs<int32_t>(), 123);
+
+  // Fill up the page, a tuple takes 8 bytes and the header 12
+  size_t num_inserted = 1;
+  while (page.Insert(tuple, &tmp_tuple)) {
+    num_inserted++;
+  }
+  ASSERT_EQ(num_inserted, (BUSTUB_PAGE_SIZE - 12) / 8);
+}
+
+// NOLINTNEXTLINE
+TEST(TmpTuplePageTest, TmpTupleFileTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(10, disk_manager.get());
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::VARCHAR, 64);
+  Schema schema(columns);
+
+  const int num_tuples = 3000;
+  std::vector<int> seen(num_tuples, 0);
+  {
+    TmpTupleFile file(bpm.get());
+    for (int i = 0; i < num_tuples; i++) {
+      std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::to_string(i))};
+      file.Append(Tuple(values, &schema));
+    }
+    ASSERT_EQ(file.NumTuples(), num_tuples);
+
+    // Read the file twice, every tuple comes back once per pass in the order it was appended
+    for (int pass = 1; pass <= 2; pass++) {
+      file.Rewind();
+      TupleBatch batch;
+      int expected = 0;
+      while (file.ReadBatch(&batch, &schema)) {
+        for (size_t row = 0; row < batch.NumRows(); row++) {
+          auto i = batch.GetValue(row, 0).GetAs<int32_t>();
+          ASSERT_EQ(i, expected++);
+          ASSERT_EQ(batch.GetValue(row, 1).ToString(), std::to_string(i));
+          seen[i]++;
+        }
+      }
+      for (int i = 0; i < num_tuples; i++) {
+        ASSERT_EQ(seen[i], pass);
+      }
+    }
+  }
+
+  // The pages are deleted with the file, so all frames are free again
+  for (size_t i = 0; i < 10; i++) {
+    page_id_t page_id;
+    ASSERT_NE(bpm->NewPage(&page_id), nullptr);
+  }
 }
 
 }  // namespace bustub
@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch_test.cpp
+//
+// Identification: test/table/tuple_batch_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/string_expression.h"
+#include "gtest/gtest.h"
+#include "storage/table/tuple_batch.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TupleBatchTest, AppendSelectTest) {
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 16}});
+  TupleBatch batch(4);
+  batch.Reset(&schema);
+  ASSERT_TRUE(batch.IsEmpty());
+
+  for (int i = 0; i < 4; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::to_string(i * 10))}, &schema);
+    batch.AppendTuple(tuple, RID(i, i));
+  }
+  ASSERT_TRUE(batch.IsFull());
+  ASSERT_EQ(4, batch.NumRows());
+  ASSERT_EQ(2, batch.GetValue(2, 0).GetAs<int32_t>());
+  ASSERT_EQ("20", batch.GetValue(2, 1).ToString());
+
+  batch.Select({1, 3});
+  ASSERT_EQ(2, batch.NumRows());
+  ASSERT_EQ(3, batch.GetValue(1, 0).GetAs<int32_t>());
+  ASSERT_EQ("30", batch.GetValue(1, 1).ToString());
+  ASSERT_EQ(RID(3, 3), batch.GetRID(1));
+
+  auto tuple = batch.GetTuple(0);
+  ASSERT_EQ(1, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  ASSERT_EQ("10", tuple.GetValue(&schema, 1).ToString());
+  ASSERT_EQ(tuple.GetLength(), batch.GetTupleSize(0));
+  std::vector<char> data(batch.GetTupleSize(0));
+  batch.SerializeTuple(0, data.data());
+  ASSERT_EQ(0, memcmp(tuple.GetData(), data.data(), data.size()));
+
+  // a reset batch is refilled from the first row
+  batch.Reset(&schema);
+  ASSERT_TRUE(batch.IsEmpty());
+  batch.AppendRow({ValueFactory::GetIntegerValue(7), ValueFactory::GetVarcharValue("x")});
+  ASSERT_EQ(1, batch.NumRows());
+  ASSERT_EQ(7, batch.GetValue(0, 0).GetAs<int32_t>());
+}
+
+// NOLINTNEXTLINE
+TEST(TupleBatchTest, EvaluateBatchTest) {
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 16}});
+  TupleBatch batch;
+  batch.Reset(&schema);
+  for (int i = 0; i < 100; i++) {
+    auto a = i % 10 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i);
+    batch.AppendRow({a, ValueFactory::GetVarcharValue("v" + std::to_string(i))});
+  }
+
+  auto col_a = std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER);
+  auto col_b = std::make_shared<ColumnValueExpression>(0, 1, TypeId::VARCHAR);
+  auto sum = std::make_shared<ArithmeticExpression>(
+      col_a, std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(5)), ArithmeticType::Plus);
+  std::vector<AbstractExpressionRef> exprs{
+      sum,
+      std::make_shared<ComparisonExpression>(sum, std::make_shared<ConstantValueExpression>(
+                                                      ValueFactory::GetIntegerValue(50)),
+                                             ComparisonType::GreaterThanOrEqual),
+      std::make_shared<StringExpression>(col_b, StringExpressionType::Upper)};
+
+  // evaluating a whole batch gives the same values as evaluating it row by row
+  for (const auto &expr : exprs) {
+    std::vector<Value> result;
+    expr->EvaluateBatch(batch, &result);
+    ASSERT_EQ(batch.NumRows(), result.size());
+    for (size_t row = 0; row < batch.NumRows(); row++) {
+      auto tuple = batch.GetTuple(row);
+      auto expected = expr->Evaluate(&tuple, schema);
+      ASSERT_EQ(expected.IsNull(), result[row].IsNull());
+      if (!expected.IsNull()) {
+        ASSERT_EQ(CmpBool::CmpTrue, expected.CompareEquals(result[row])) << expr->ToString() << " row " << row;
+      }
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,130 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "fmt/format.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/bloom_filter.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"
+
+#include <sys/time.h>
+
+auto ClockUs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec) * 1000000 + static_cast<uint64_t>(tm.tv_usec);
+}
+
+static const size_t LRU_K_SIZE = 4;
+static const size_t BUSTUB_BPM_SIZE = 1024;
+static const size_t BITS_PER_KEY[] = {0, 4, 8, 12, 16};
+
+using KeyType = bustub::GenericKey<8>;
+using TreeType = bustub::BPlusTree<KeyType, bustub::RID, bustub::GenericComparator<8>>;
+
+/**
+ * Point lookups of keys that are not in the index, the way an anti-join or an "insert if not exists" probes it. The
+ * tree holds the even keys and every lookup asks for an odd one. Each run puts a Bloom filter with a different number
+ * of bits per key in front of the tree, and reports how many lookups it answers without descending into the tree
+ * against the memory it takes.
+ */
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  using bustub::BufferPoolManager;
+  using bustub::DiskManagerUnlimitedMemory;
+  using bustub::page_id_t;
+
+  argparse::ArgumentParser program("bustub-bloom-bench");
+  program.add_argument("--keys").help("number of keys in the index");
+  program.add_argument("--lookups").help("number of negative lookups per run");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t total_keys = 100000;
+  if (program.present("--keys")) {
+    total_keys = std::stoi(program.get("--keys"));
+  }
+  size_t total_lookups = 1000000;
+  if (program.present("--lookups")) {
+    total_lookups = std::stoi(program.get("--lookups"));
+  }
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+
+  fmt::print(stderr, "[info] total_keys={}, total_lookups={}, bpm_size={}\n", total_keys, total_lookups,
+             BUSTUB_BPM_SIZE);
+
+  auto key_schema = bustub::ParseCreateStatement("a bigint");
+  bustub::GenericComparator<8> comparator(key_schema.get());
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPageGuarded(&page_id);
+  TreeType tree("foo_pk", page_id, bpm.get(), comparator);
+
+  KeyType index_key;
+  bustub::RID rid;
+  for (size_t key = 0; key < total_keys; key++) {
+    rid.Set(static_cast<int32_t>(key), static_cast<uint32_t>(key));
+    index_key.SetFromInteger(static_cast<int64_t>(key * 2));
+    tree.Insert(index_key, rid, nullptr);
+  }
+
+  std::default_random_engine gen(42);
+  std::uniform_int_distribution<size_t> dis(0, total_keys - 1);
+  std::vector<KeyType> lookups(total_lookups);
+  for (auto &lookup : lookups) {
+    lookup.SetFromInteger(static_cast<int64_t>(dis(gen) * 2 + 1));
+  }
+
+  fmt::print(stderr, "[info] benchmark start\n");
+  fmt::print("<<< BEGIN\n");
+  for (auto bits_per_key : BITS_PER_KEY) {
+    std::unique_ptr<bustub::BloomFilter<KeyType>> filter;
+    if (bits_per_key > 0) {
+      filter = std::make_unique<bustub::BloomFilter<KeyType>>(total_keys * bits_per_key);
+      for (size_t key = 0; key < total_keys; key++) {
+        index_key.SetFromInteger(static_cast<int64_t>(key * 2));
+        filter->Insert(index_key);
+      }
+    }
+
+    size_t filtered = 0;
+    std::vector<bustub::RID> rids;
+    auto start = ClockUs();
+    for (const auto &lookup : lookups) {
+      if (filter != nullptr && !filter->MayContain(lookup)) {
+        filtered++;
+        continue;
+      }
+      rids.clear();
+      if (tree.GetValue(lookup, &rids)) {
+        throw std::runtime_error(fmt::format("unexpected key: {}", lookup.ToString()));
+      }
+    }
+    auto elapsed_us = ClockUs() - start;
+
+    fmt::print("bits_per_key={:<3} memory_kb={:<8.1f} filtered={:<8.4f} lookups_per_sec={:.0f}\n", bits_per_key,
+               filter != nullptr ? filter->SizeInBytes() / 1024.0 : 0.0,
+               static_cast<double>(filtered) / static_cast<double>(total_lookups),
+               static_cast<double>(total_lookups) / static_cast<double>(elapsed_us) * 1000000);
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
@@ -0,0 +1,160 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "container/disk/hash/disk_extendible_hash_table.h"
+#include "container/disk/hash/linear_probe_hash_table.h"
+#include "fmt/format.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"
+
+#include <sys/time.h>
+
+auto ClockUs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec) * 1000000 + static_cast<uint64_t>(tm.tv_usec);
+}
+
+static const size_t LRU_K_SIZE = 4;
+static const size_t BUSTUB_BPM_SIZE = 2048;
+
+using KeyType = bustub::GenericKey<8>;
+using ComparatorType = bustub::GenericComparator<8>;
+
+/** The operations of one index structure under test */
+struct Container {
+  std::string name_;
+  std::function<bool(const KeyType &, const bustub::RID &)> insert_;
+  std::function<bool(const KeyType &, std::vector<bustub::RID> *)> get_value_;
+};
+
+/**
+ * Point lookups of existing keys in the three disk-resident indexes: the B+ tree, the extendible hash table and the
+ * linear probing hash table. Each one gets its own buffer pool large enough to hold it, so the run measures the
+ * structures rather than the disk. Inserts run on one thread, lookups on `--threads` threads.
+ */
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  using bustub::BufferPoolManager;
+  using bustub::DiskManagerUnlimitedMemory;
+  using bustub::page_id_t;
+
+  argparse::ArgumentParser program("bustub-hash-bench");
+  program.add_argument("--keys").help("number of keys in each index");
+  program.add_argument("--lookups").help("number of lookups per run");
+  program.add_argument("--threads").help("number of lookup threads");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t total_keys = 50000;
+  if (program.present("--keys")) {
+    total_keys = std::stoi(program.get("--keys"));
+  }
+  size_t total_lookups = 1000000;
+  if (program.present("--lookups")) {
+    total_lookups = std::stoi(program.get("--lookups"));
+  }
+  size_t num_threads = 4;
+  if (program.present("--threads")) {
+    num_threads = std::stoi(program.get("--threads"));
+  }
+
+  fmt::print(stderr, "[info] total_keys={}, total_lookups={}, threads={}, bpm_size={}\n", total_keys, total_lookups,
+             num_threads, BUSTUB_BPM_SIZE);
+
+  auto key_schema = bustub::ParseCreateStatement("a bigint");
+  ComparatorType comparator(key_schema.get());
+  bustub::HashFunction<KeyType> hash_fn;
+
+  std::vector<std::unique_ptr<DiskManagerUnlimitedMemory>> disk_managers;
+  std::vector<std::unique_ptr<BufferPoolManager>> bpms;
+  auto new_bpm = [&]() {
+    disk_managers.emplace_back(std::make_unique<DiskManagerUnlimitedMemory>());
+    bpms.emplace_back(std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_managers.back().get(), LRU_K_SIZE));
+    return bpms.back().get();
+  };
+
+  auto *tree_bpm = new_bpm();
+  page_id_t header_page_id;
+  tree_bpm->NewPageGuarded(&header_page_id);
+  bustub::BPlusTree<KeyType, bustub::RID, ComparatorType> tree("foo_pk", header_page_id, tree_bpm, comparator);
+  bustub::DiskExtendibleHashTable<KeyType, bustub::RID, ComparatorType> extendible("foo_pk", new_bpm(), comparator,
+                                                                                   hash_fn);
+  bustub::LinearProbeHashTable<KeyType, bustub::RID, ComparatorType> linear_probe("foo_pk", new_bpm(), comparator,
+                                                                                  1000, hash_fn);
+
+  std::vector<Container> containers = {
+      {"b_plus_tree", [&](const auto &key, const auto &rid) { return tree.Insert(key, rid, nullptr); },
+       [&](const auto &key, auto *result) { return tree.GetValue(key, result, nullptr); }},
+      {"extendible_hash", [&](const auto &key, const auto &rid) { return extendible.Insert(nullptr, key, rid); },
+       [&](const auto &key, auto *result) { return extendible.GetValue(nullptr, key, result); }},
+      {"linear_probe_hash", [&](const auto &key, const auto &rid) { return linear_probe.Insert(nullptr, key, rid); },
+       [&](const auto &key, auto *result) { return linear_probe.GetValue(nullptr, key, result); }},
+  };
+
+  std::default_random_engine gen(42);
+  std::uniform_int_distribution<size_t> dis(0, total_keys - 1);
+  std::vector<KeyType> lookups(total_lookups);
+  for (auto &lookup : lookups) {
+    lookup.SetFromInteger(static_cast<int64_t>(dis(gen)));
+  }
+
+  fmt::print(stderr, "[info] benchmark start\n");
+  fmt::print("<<< BEGIN\n");
+  for (auto &container : containers) {
+    KeyType index_key;
+    bustub::RID rid;
+    auto start = ClockUs();
+    for (size_t key = 0; key < total_keys; key++) {
+      rid.Set(static_cast<int32_t>(key), static_cast<uint32_t>(key));
+      index_key.SetFromInteger(static_cast<int64_t>(key));
+      if (!container.insert_(index_key, rid)) {
+        throw std::runtime_error(fmt::format("{}: failed to insert {}", container.name_, key));
+      }
+    }
+    auto insert_us = ClockUs() - start;
+
+    start = ClockUs();
+    std::vector<std::thread> threads;
+    for (size_t thread_id = 0; thread_id < num_threads; thread_id++) {
+      threads.emplace_back([&, thread_id]() {
+        std::vector<bustub::RID> rids;
+        for (size_t i = thread_id; i < total_lookups; i += num_threads) {
+          rids.clear();
+          if (!container.get_value_(lookups[i], &rids) || rids.size() != 1) {
+            throw std::runtime_error(fmt::format("{}: missing key {}", container.name_, lookups[i].ToString()));
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto lookup_us = ClockUs() - start;
+
+    fmt::print("{:<18} inserts_per_sec={:<10.0f} lookups_per_sec={:.0f}\n", container.name_,
+               static_cast<double>(total_keys) / static_cast<double>(insert_us) * 1000000,
+               static_cast<double>(total_lookups) / static_cast<double>(lookup_us) * 1000000);
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
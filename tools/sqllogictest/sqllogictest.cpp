@@ -75,6 +75,17 @@ auto ProcessExtraOptions(const std::string &sql, bustub::BustubInstance &instanc
           fmt::print("IndexScan not found\n");
           return false;
         }
+      } else if (opt == "ensure:index_only_scan") {
+        if (!bustub::StringUtil::Contains(result.str(), "index_only")) {
+          fmt::print("index-only IndexScan not found\n");
+          return false;
+        }
+      } else if (opt == "ensure:index_lookup") {
+        if (!bustub::StringUtil::Contains(result.str(), "IndexScan") ||
+            !bustub::StringUtil::Contains(result.str(), "key=")) {
+          fmt::print("IndexScan equality lookup not found\n");
+          return false;
+        }
       } else if (opt == "ensure:hash_join") {
         if (bustub::StringUtil::Split(result.str(), "HashJoin").size() != 2 &&
             !bustub::StringUtil::Contains(result.str(), "Filter")) {
@@ -110,6 +121,31 @@ auto ProcessExtraOptions(const std::string &sql, bustub::BustubInstance &instanc
           fmt::print("NestedIndexJoin not found\n");
           return false;
         }
+      } else if (opt == "ensure:gather") {
+        if (!bustub::StringUtil::Contains(result.str(), "Gather")) {
+          fmt::print("Gather not found, is parallelism above 1?\n");
+          return false;
+        }
+      } else if (opt == "ensure:gather*1") {
+        if (bustub::StringUtil::Split(result.str(), "Gather").size() != 2) {
+          fmt::print("Gather should appear exactly once\n");
+          return false;
+        }
+      } else if (opt == "ensure:parallel_hash_join") {
+        if (!bustub::StringUtil::Contains(result.str(), "[parallel build, parallel probe]")) {
+          fmt::print("HashJoin probing on the workers of a Gather not found\n");
+          return false;
+        }
+      } else if (opt == "ensure:parallel_agg") {
+        if (!bustub::StringUtil::Contains(result.str(), "[parallel pre-aggregation, partitioned merge]")) {
+          fmt::print("Agg over a Gather not found\n");
+          return false;
+        }
+      } else if (opt == "ensure:parallel_sort") {
+        if (!bustub::StringUtil::Contains(result.str(), "[parallel runs, range-partitioned merge]")) {
+          fmt::print("parallel Sort not found\n");
+          return false;
+        }
       } else if (opt == "ensure:nlj_init_check") {
         if (!bustub::StringUtil::Contains(result.str(), "NestedLoopJoin")) {
           fmt::print("NestedLoopJoin not found\n");